@@ -165,6 +165,10 @@ public:
 
 	const Handle& get_body(void) const { return _body; }
 
+	// The number of connected components; a pattern with more than
+	// one is joined together by its virtual clauses.
+	size_t get_num_comps(void) const { return _num_comps; }
+
 	// XXX temp hack till things get sorted out; remove this method
 	// later.
 	const Pattern& get_pattern(void) { return _pat; }
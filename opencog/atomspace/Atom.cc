@@ -24,7 +24,8 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
  */
 
-#include <set>
+#include <algorithm>
+#include <cstdint>
 
 #ifndef WIN32
 #include <unistd.h>
@@ -57,7 +58,30 @@
 
 using namespace opencog;
 
-#define _avmtx _mtx
+// ==============================================================
+// Lock striping.  The number of stripes only needs to be large
+// compared to the number of threads, so that two threads rarely
+// collide on unrelated atoms.  Each lock is padded out to its own
+// cache line, so that neighbouring stripes don't false-share.
+
+#define ATOM_LOCK_STRIPES 1024
+
+namespace {
+struct alignas(64) LockStripe
+{
+    std::mutex mtx;
+};
+LockStripe atom_locks[ATOM_LOCK_STRIPES];
+}
+
+std::mutex& Atom::get_mutex() const
+{
+    // Fibonacci hashing of the address; the low bits are always zero
+    // (alignment), and atoms made one after another are adjacent, so
+    // take the high bits of the product.
+    uint64_t h = (uint64_t) (uintptr_t) this * 0x9E3779B97F4A7C15ULL;
+    return atom_locks[h >> 54].mtx;
+}
 
 Atom::~Atom()
 {
@@ -91,8 +115,12 @@ void Atom::setTruthValue(TruthValuePtr newTV)
     // writing this at a time. std:shared_ptr is NOT thread-safe against
     // multiple writers: see "Example 5" in
     // http://www.boost.org/doc/libs/1_53_0/libs/smart_ptr/shared_ptr.htm#ThreadSafety
-    std::unique_lock<std::mutex> lck (_mtx);
-    _truthValue = newTV;
+    // The default is stored as a null pointer; see Atom.h.  The old
+    // value is swapped out, so that it is released without the lock.
+    TruthValuePtr stored(newTV);
+    if (stored == TruthValue::DEFAULT_TV()) stored = NULL;
+    std::unique_lock<std::mutex> lck (get_mutex());
+    _truthValue.swap(stored);
     lck.unlock();
 
     if (_atomTable != NULL) {
@@ -114,8 +142,10 @@ TruthValuePtr Atom::getTruthValue()
     // the multi-threaded async atom store in the SQL peristance backend.
     // Furthermore, we must make a copy while holding the lock! Got that?
 
-    std::lock_guard<std::mutex> lck(_mtx);
+    std::unique_lock<std::mutex> lck(get_mutex());
     TruthValuePtr local(_truthValue);
+    lck.unlock();
+    if (NULL == local) return TruthValue::DEFAULT_TV();
     return local;
 }
 
@@ -155,8 +185,10 @@ AttentionValuePtr Atom::getAttentionValue()
     // deconstructed. Furthermore, we must make a copy while holding
     // the lock! Got that?
 
-    std::lock_guard<std::mutex> lck(_mtx);
+    std::unique_lock<std::mutex> lck(get_mutex());
     AttentionValuePtr local(_attentionValue);
+    lck.unlock();
+    if (NULL == local) return AttentionValue::DEFAULT_AV();
     return local;
 }
 
@@ -168,24 +200,24 @@ void Atom::setAttentionValue(AttentionValuePtr av)
     if (av == local) return;
     if (*av == *local) return;
 
-    // Need to lock, shared_ptr is NOT atomic!
-    std::unique_lock<std::mutex> lck (_avmtx);
-    local = _attentionValue; // Get it again, to avoid races.
-    _attentionValue = av;
+    // Need to lock, shared_ptr is NOT atomic!  The default is stored
+    // as a null pointer; see Atom.h.
+    AttentionValuePtr stored(av);
+    if (stored == AttentionValue::DEFAULT_AV()) stored = NULL;
+    std::unique_lock<std::mutex> lck (get_mutex());
+    _attentionValue.swap(stored);
     lck.unlock();
+    // Get it again, to avoid races.
+    local = stored ? stored : AttentionValue::DEFAULT_AV();
 
     // If the atom free-floating, we are done.
     if (NULL == _atomTable) return;
 
-    // Get old and new bins.
-    int oldBin = ImportanceIndex::importanceBin(local->getSTI());
-    int newBin = ImportanceIndex::importanceBin(av->getSTI());
-
-    // If the atom importance has changed its bin,
-    // update the importance index.
-    if (oldBin != newBin) {
+    // If the atom importance has changed, update the importance
+    // index; the atom table knows whether it changed bins.
+    if (local->getSTI() != av->getSTI()) {
         AtomPtr a(shared_from_this());
-        _atomTable->updateImportanceIndex(a, oldBin);
+        _atomTable->updateImportanceIndex(a, local->getSTI());
     }
 
     // Notify any interested parties that the AV changed.
@@ -263,14 +295,15 @@ void Atom::setAtomTable(AtomTable *tb)
 /// is made, those links won't show up in the incoming set.
 ///
 /// We don't automatically track incoming sets for two reasons:
-/// 1) std::set takes up 48 bytes
+/// 1) the set takes up memory, even when empty.
 /// 2) adding and remoiving uses up cpu cycles.
 /// Thus, if the incoming set isn't needed, then don't bother
 /// tracking it.
 void Atom::keep_incoming_set()
 {
+    std::lock_guard<std::mutex> lck (get_mutex());
     if (_incoming_set) return;
-    _incoming_set = std::make_shared<InSet>();
+    _incoming_set.reset(new InSet());
 }
 
 /// Stop tracking the incoming set for this atom.
@@ -278,19 +311,86 @@ void Atom::keep_incoming_set()
 /// be queried; it is erased.
 void Atom::drop_incoming_set()
 {
-    if (NULL == _incoming_set) return;
-    std::lock_guard<std::mutex> lck (_mtx);
-    _incoming_set->_iset.clear();
-    // delete _incoming_set;
-    _incoming_set = NULL;
+    std::unique_ptr<InSet> doomed;
+    std::lock_guard<std::mutex> lck (get_mutex());
+    doomed.swap(_incoming_set);
+}
+
+// The incoming set is ordered by link type, and then by owner.
+// in_lower_bound() finds the first entry not before (t, w); if link w
+// is in the set, then that is where it is.
+static inline bool in_before(const Type t1, const WinkPtr& w1,
+                             const Type t2, const WinkPtr& w2)
+{
+    return t1 < t2 or (t1 == t2 and w1.owner_before(w2));
+}
+
+size_t Atom::in_lower_bound(const InSet& is, Type t, const WinkPtr& w)
+{
+    auto it = std::lower_bound(is._iset.begin(), is._iset.end(), 0,
+        [&](const InEntry& e, int) { return in_before(e.type, e.link, t, w); });
+    return it - is._iset.begin();
+}
+
+/// Squeeze out the tombstones, and any links that have gone away
+/// without being removed.  The set must be settled.
+void Atom::compact_incoming_set()
+{
+    InSet& is = *_incoming_set;
+    is._iset.erase(std::remove_if(is._iset.begin(), is._iset.end(),
+        [](const InEntry& e) { return e.dead or e.link.expired(); }),
+        is._iset.end());
+    is._sorted = is._iset.size();
+    is._dead = 0;
+    is._epoch++;
+}
+
+/// Merge the links appended by insert_atom() into the sorted part.
+/// A link may have been appended twice (a link can hold the same atom
+/// more than once), or appended again after it was removed; only one
+/// entry is kept, and it is alive if any of them was.  Every reader
+/// calls this first, with the lock held.
+void Atom::settle_incoming_set()
+{
+    InSet& is = *_incoming_set;
+    if (is._sorted == is._iset.size()) return;
+
+    auto less = [](const InEntry& a, const InEntry& b) {
+        return in_before(a.type, a.link, b.type, b.link); };
+    auto mid = is._iset.begin() + is._sorted;
+    std::sort(mid, is._iset.end(), less);
+    std::inplace_merge(is._iset.begin(), mid, is._iset.end(), less);
+
+    size_t keep = 0;
+    for (size_t i = 0; i < is._iset.size(); i++)
+    {
+        if (0 < keep and not less(is._iset[keep-1], is._iset[i]))
+        {
+            // A duplicate of the entry just kept; drop it.
+            if (is._iset[i].dead)
+                is._dead--;
+            else if (is._iset[keep-1].dead) {
+                is._iset[keep-1].dead = false;
+                is._dead--;
+            }
+            continue;
+        }
+        if (keep != i) is._iset[keep] = is._iset[i];
+        keep++;
+    }
+    is._iset.erase(is._iset.begin() + keep, is._iset.end());
+    is._sorted = is._iset.size();
+    is._epoch++;
 }
 
-/// Add an atom to the incoming set.
+/// Add an atom to the incoming set.  It is appended, unsorted; see
+/// settle_incoming_set().
 void Atom::insert_atom(LinkPtr a)
 {
+    std::lock_guard<std::mutex> lck (get_mutex());
     if (NULL == _incoming_set) return;
-    std::lock_guard<std::mutex> lck (_mtx);
-    _incoming_set->_iset.insert(a);
+    InSet& is = *_incoming_set;
+    is._iset.push_back(InEntry{WinkPtr(a), a->getType(), false});
 #ifdef INCOMING_SET_SIGNALS
     _incoming_set->_addAtomSignal(shared_from_this(), a);
 #endif /* INCOMING_SET_SIGNALS */
@@ -299,19 +399,51 @@ void Atom::insert_atom(LinkPtr a)
 /// Remove an atom from the incoming set.
 void Atom::remove_atom(LinkPtr a)
 {
+    std::lock_guard<std::mutex> lck (get_mutex());
     if (NULL == _incoming_set) return;
-    std::lock_guard<std::mutex> lck (_mtx);
 #ifdef INCOMING_SET_SIGNALS
     _incoming_set->_removeAtomSignal(shared_from_this(), a);
 #endif /* INCOMING_SET_SIGNALS */
-    _incoming_set->_iset.erase(a);
+    settle_incoming_set();
+    InSet& is = *_incoming_set;
+    Type t = a->getType();
+    WinkPtr w(a);
+    size_t i = in_lower_bound(is, t, w);
+    if (is._iset.size() <= i or is._iset[i].dead or
+        in_before(t, w, is._iset[i].type, is._iset[i].link))
+        return;
+
+    // Leave a tombstone, so that nothing has to move.
+    is._iset[i].dead = true;
+    is._dead++;
+    if (is._iset.size() < 4 * is._dead)
+        compact_incoming_set();
 }
 
 size_t Atom::getIncomingSetSize()
 {
+    std::lock_guard<std::mutex> lck (get_mutex());
     if (NULL == _incoming_set) return 0;
-    std::lock_guard<std::mutex> lck (_mtx);
-    return _incoming_set->_iset.size();
+    settle_incoming_set();
+    return _incoming_set->_iset.size() - _incoming_set->_dead;
+}
+
+size_t Atom::getIncomingSetSizeByType(Type t)
+{
+    std::lock_guard<std::mutex> lck (get_mutex());
+    if (NULL == _incoming_set) return 0;
+    settle_incoming_set();
+    const InSet& is = *_incoming_set;
+    size_t lo = in_lower_bound(is, t, WinkPtr());
+    size_t hi = in_lower_bound(is, t+1, WinkPtr());
+    size_t n = hi - lo;
+
+    // Don't count the tombstones.  There are few of them, and none at
+    // all most of the time; see remove_atom().
+    if (0 < is._dead)
+        for (size_t i = lo; i < hi; i++)
+            if (is._iset[i].dead) n--;
+    return n;
 }
 
 // We return a copy here, and not a reference, because the set itself
@@ -320,16 +452,84 @@ size_t Atom::getIncomingSetSize()
 // strong in order to hand it out.
 IncomingSet Atom::getIncomingSet()
 {
-    static IncomingSet empty_set;
-    if (NULL == _incoming_set) return empty_set;
-
     // Prevent update of set while a copy is being made.
-    std::lock_guard<std::mutex> lck (_mtx);
+    std::lock_guard<std::mutex> lck (get_mutex());
+    IncomingSet iset;
+    if (NULL == _incoming_set) return iset;
+    settle_incoming_set();
+    iset.reserve(_incoming_set->_iset.size() - _incoming_set->_dead);
+    for (const InEntry& e : _incoming_set->_iset)
+    {
+        if (e.dead) continue;
+        LinkPtr l(e.link.lock());
+        if (l) iset.push_back(l);
+    }
+    return iset;
+}
+
+IncomingSet Atom::getIncomingSetByType(Type type, bool subclass)
+{
+    std::lock_guard<std::mutex> lck (get_mutex());
     IncomingSet iset;
-    for (WinkPtr w : _incoming_set->_iset)
+    if (NULL == _incoming_set) return iset;
+    settle_incoming_set();
+    const InSet& is = *_incoming_set;
+
+    // Without subclasses, the links of this type are a contiguous run.
+    size_t i = 0;
+    if (not subclass)
+        i = in_lower_bound(is, type, WinkPtr());
+
+    for (; i < is._iset.size(); i++)
     {
-        LinkPtr l(w.lock());
+        const InEntry& e = is._iset[i];
+        if (not subclass and e.type != type) break;
+        if (e.dead) continue;
+        if (subclass and not classserver().isA(e.type, type)) continue;
+        LinkPtr l(e.link.lock());
         if (l) iset.push_back(l);
     }
     return iset;
 }
+
+/// Hand out the next link in the incoming set, or null at the end.
+/// The lock is held only for the duration of the step.
+LinkPtr Atom::next_incoming(InCursor& cur)
+{
+    std::lock_guard<std::mutex> lck (get_mutex());
+    if (NULL == _incoming_set) return LinkPtr();
+    settle_incoming_set();
+    const InSet& is = *_incoming_set;
+
+    if (not cur.started)
+    {
+        cur.started = true;
+        cur.epoch = is._epoch;
+        if (NOTYPE != cur.only)
+            cur.pos = in_lower_bound(is, cur.only, WinkPtr());
+    }
+    else if (cur.epoch != is._epoch)
+    {
+        // The entries moved since the last step; find our place again.
+        // It is just after the last link handed out.
+        auto it = std::upper_bound(is._iset.begin(), is._iset.end(), 0,
+            [&](int, const InEntry& e) {
+                return in_before(cur.type, cur.last, e.type, e.link); });
+        cur.pos = it - is._iset.begin();
+        cur.epoch = is._epoch;
+    }
+
+    while (cur.pos < is._iset.size())
+    {
+        const InEntry& e = is._iset[cur.pos];
+        if (NOTYPE != cur.only and e.type != cur.only) break;
+        cur.pos++;
+        if (e.dead) continue;
+        LinkPtr l(e.link.lock());
+        if (NULL == l) continue;
+        cur.type = e.type;
+        cur.last = e.link;
+        return l;
+    }
+    return LinkPtr();
+}
@@ -31,7 +31,9 @@
 #include <mutex>
 #include <set>
 #include <string>
+#include <vector>
 
+#include <boost/container/small_vector.hpp>
 #include <boost/signals2.hpp>
 
 #include <opencog/util/exceptions.h>
@@ -54,14 +56,12 @@ class Link;
 typedef std::shared_ptr<Link> LinkPtr;
 typedef std::vector<LinkPtr> IncomingSet; // use vector; see below.
 typedef std::weak_ptr<Link> WinkPtr;
-typedef std::set<WinkPtr, std::owner_less<WinkPtr> > WincomingSet;
 typedef boost::signals2::signal<void (AtomPtr, LinkPtr)> AtomPairSignal;
 
 // We use a std:vector instead of std::set for IncomingSet, because
 // virtually all access will be either insert, or iterate, so we get
-// O(1) performance. We use std::set for WincomingSet, because we want
-// both good insert and good remove performance.  Note that sometimes
-// incoming sets can be huge (millions of atoms).
+// O(1) performance.  Note that sometimes incoming sets can be huge
+// (millions of atoms).
 
 /**
  * Atoms are the basic implementational unit in the system that
@@ -79,6 +79,7 @@ class Atom
     friend class Handle;          // Needs to view _uuid
     friend class SavingLoading;   // Needs to set _uuid
     friend class TLB;             // Needs to view _uuid
+    friend class TypeIndex;       // Needs to view _uuid
     friend class CreateLink;      // Needs to call getAtomTable();
     friend class DeleteLink;      // Needs to call getAtomTable();
 
@@ -98,15 +99,20 @@ protected:
     // Byte of bitflags (each bit is a flag, see AtomSpaceDefinites.h)
     char _flags;
 
+    // A null pointer here stands for TruthValue::DEFAULT_TV(), resp.
+    // AttentionValue::DEFAULT_AV(); the getters hand out the default.
+    // Almost all atoms carry the defaults, and this way they do not
+    // all bang on the reference count of the same shared instance.
     TruthValuePtr _truthValue;
     AttentionValuePtr _attentionValue;
 
-    // Lock, used to serialize changes.
-    // This costs 40 bytes per atom.  Tried using a single, global lock,
-    // but there seemed to be too much contention for it, so instead,
-    // we are using a lock-per-atom, even though this makes the atom
-    // kind-of fat.
-    std::mutex _mtx;
+    // Lock, used to serialize changes.  This used to be a std::mutex
+    // embedded in every atom, which cost 40 bytes per atom.  The atoms
+    // now share a fixed pool of locks, picked by the atom's address
+    // (lock striping); see get_mutex().  A stripe may be shared by
+    // several atoms, so no other atom lock may be taken, and no atom
+    // may be destroyed, while holding it.
+    std::mutex& get_mutex() const;
 
     /**
      * Constructor for this class. Protected; no user should call this
@@ -123,20 +129,45 @@ protected:
       : _uuid(Handle::UNDEFINED.value()),
         _atomTable(NULL),
         _type(t),
-        _flags(0),
-        _truthValue(tv),
-        _attentionValue(av)
-    {}
+        _flags(0)
+    {
+        if (tv != TruthValue::DEFAULT_TV()) _truthValue = tv;
+        if (av != AttentionValue::DEFAULT_AV()) _attentionValue = av;
+    }
+
+    // One member of the incoming set.  The type of the link is kept
+    // next to the weak pointer, so that the set can be sorted, and
+    // filtered, by type without having to lock the weak pointer.
+    struct InEntry
+    {
+        WinkPtr link;
+        Type type;
+        bool dead;      // Tombstone: removed, but not yet compacted.
+    };
 
     struct InSet
     {
         // The incoming set is not tracked by the garbage collector;
         // this is required, in order to avoid cyclic references.
         // That is, we use weak pointers here, not strong ones.
-        // std::set<ptr> uses 48 bytes (per atom).  See the README file
-        // in this directory for a slightly longer explanation for why
-        // weak pointers are needed, and why bdgc cannot be used.
-        WincomingSet _iset;
+        // See the README file in this directory for a slightly longer
+        // explanation for why weak pointers are needed, and why bdgc
+        // cannot be used.
+        //
+        // The set is a flat array, sorted by link type and then by
+        // owner, so that lookups are a binary search and iteration is
+        // a linear scan.  Very many atoms have just one incoming link;
+        // that one is stored inline, with no further allocation.
+        // New links are appended past the sorted part, and merged in
+        // only when the set is next read, so that building the
+        // incoming set of a hub atom is not quadratic.  Removal only
+        // marks an entry dead; the dead entries are squeezed out once
+        // they make up a quarter of the array.
+        boost::container::small_vector<InEntry, 1> _iset;
+        size_t _sorted;         // Length of the sorted part of _iset.
+        unsigned int _dead;     // Number of tombstones in _iset.
+        unsigned int _epoch;    // Bumped whenever entries move.
+        InSet() : _sorted(0), _dead(0), _epoch(0) {}
 #ifdef INCOMING_SET_SIGNALS
         // Some people want to know if the incoming set has changed...
         // However, these make the atom quite fat, so this is disabled
@@ -146,15 +177,35 @@ protected:
         AtomPairSignal _removeAtomSignal;
 #endif /* INCOMING_SET_SIGNALS */
     };
-    typedef std::shared_ptr<InSet> InSetPtr;
-    InSetPtr _incoming_set;
+    std::unique_ptr<InSet> _incoming_set;
     void keep_incoming_set();
     void drop_incoming_set();
+    void compact_incoming_set();
+    void settle_incoming_set();
+    static size_t in_lower_bound(const InSet&, Type, const WinkPtr&);
 
     // Insert and remove links from the incoming set.
     void insert_atom(LinkPtr);
     void remove_atom(LinkPtr);
 
+    // Position in the incoming set, for walking it without holding
+    // the lock between steps.  If the entries move in the meantime,
+    // the walk picks up again after the last link it handed out.
+    // If `only` is not NOTYPE, the walk covers just the run of links
+    // of that type.
+    struct InCursor
+    {
+        Type only;
+        bool started;
+        size_t pos;
+        unsigned int epoch;
+        Type type;
+        WinkPtr last;
+        InCursor(Type t = NOTYPE)
+            : only(t), started(false), pos(0), epoch(0), type(0) {}
+    };
+    LinkPtr next_incoming(InCursor&);
+
 private:
     /** Returns whether this atom is marked for removal.
      *
@@ -292,6 +343,16 @@ public:
     //! Get the size of the incoming set.
     size_t getIncomingSetSize();
 
+    //! Get the number of links of type t (not including subtypes) in
+    //! the incoming set.  This is cheap, two binary searches, plus a
+    //! walk over that type's links if some were recently removed.
+    //! Links that have been removed from the atomspace are not counted,
+    //! but links that were simply dropped (never added to any atomspace,
+    //! and since freed) are, until the next sweep; so it is an upper
+    //! bound on what getIncomingSetByType() returns.  Meant for
+    //! estimating the cost of a search.
+    size_t getIncomingSetSizeByType(Type t);
+
     //! Return the incoming set of this atom.
     //! The resulting incoming set consists of strong pointers,
     //! that is, to valid, non-null handles that were part of the
@@ -308,15 +369,12 @@ public:
     template <typename OutputIterator> OutputIterator
     getIncomingSet(OutputIterator result)
     {
-        if (NULL == _incoming_set) return result;
-        std::lock_guard<std::mutex> lck(_mtx);
-        // Sigh. I need to compose copy_if with transform. I could
-        // do this wih boost range adaptors, but I don't feel like it.
-        auto end = _incoming_set->_iset.end();
-        for (auto w = _incoming_set->_iset.begin(); w != end; w++)
+        // The copy is made under the lock; the handles are handed
+        // out without it, since the output iterator may do anything.
+        for (const LinkPtr& lp : getIncomingSet())
         {
-            Handle h(w->lock());
-            if (h) { *result = h; result ++; }
+            *result = Handle(lp);
+            result ++;
         }
         return result;
     }
@@ -325,14 +383,29 @@ public:
     //! handle h, until one of them returns true, in which case
     //! iteration stopsm and true is returned. Otherwise the
     //! callback is called on all incomings and false is returned.
+    //!
+    //! The set is walked in place; no copy is made.  The callback is
+    //! not called with locks held, so it may change the incoming set;
+    //! links added or removed during the walk may or may not be seen.
     template<class T>
     inline bool foreach_incoming(bool (T::*cb)(const Handle&), T *data)
     {
-        // We make a copy of the set, so that we don't call the
-        //callback with locks held.
-        IncomingSet vh(getIncomingSet());
+        InCursor cur;
+        for (LinkPtr lp(next_incoming(cur)); lp; lp = next_incoming(cur))
+            if ((data->*cb)(Handle(lp))) return true;
+        return false;
+    }
 
-        for (const LinkPtr& lp : vh)
+    //! Same as above, but only for the incoming links of type t
+    //! (not including subtypes).  Since the incoming set is sorted by
+    //! type, the other links are never looked at, which matters for
+    //! atoms with huge incoming sets of mixed types.
+    template<class T>
+    inline bool foreach_incoming_by_type(Type t,
+                                         bool (T::*cb)(const Handle&), T *data)
+    {
+        InCursor cur(t);
+        for (LinkPtr lp(next_incoming(cur)); lp; lp = next_incoming(cur))
             if ((data->*cb)(Handle(lp))) return true;
         return false;
     }
@@ -349,22 +422,16 @@ public:
      * @return The set of atoms of the given type with the given handle
      *         in their outgoing set.
      */
+    IncomingSet getIncomingSetByType(Type type, bool subclass = false);
+
     template <typename OutputIterator> OutputIterator
     getIncomingSetByType(OutputIterator result,
                          Type type, bool subclass = false)
     {
-        if (NULL == _incoming_set) return result;
-        std::lock_guard<std::mutex> lck(_mtx);
-        // Sigh. I need to compose copy_if with transform. I could
-        // do this wih boost range adaptors, but I don't feel like it.
-        auto end = _incoming_set->_iset.end();
-        for (auto w = _incoming_set->_iset.begin(); w != end; w++)
+        for (const LinkPtr& lp : getIncomingSetByType(type, subclass))
         {
-            Handle h(w->lock());
-            if (h and h->isType(type, subclass)) {
-                *result = h;
-                result ++;
-            }
+            *result = Handle(lp);
+            result ++;
         }
         return result;
     }
@@ -356,6 +356,9 @@ void AtomSpace::clear()
 {
     std::vector<Handle> allAtoms;
 
+    // Atoms added asynchronously are not in the type index until
+    // their index worker has caught up.
+    atomTable.barrier();
     atomTable.getHandlesByType(back_inserter(allAtoms), ATOM, true, false);
 
     DPRINTF("atoms in allAtoms: %lu\n", allAtoms.size());
@@ -448,24 +448,39 @@ public:
                                        bool (T::*cb)(const Handle&), T *data,
                                        bool subclass = false)
     {
-        // First we extract, then we loop. This is to avoid holding
-        // the lock for too long. (because we don't know how long
+        // Walk the type index a chunk at a time; no lock is held
+        // while the callback runs (because we don't know how long
         // the callback will take.)
-        std::list<Handle> handle_set;
-        // The intended signatue is
-        // getHandleSet(OutputIterator result, Type type, bool subclass)
-        get_handles_by_type(back_inserter(handle_set), atype, subclass);
-
-        // Loop over all handles in the handle set.
-        std::list<Handle>::iterator i = handle_set.begin();
-        std::list<Handle>::iterator iend = handle_set.end();
-        for (; i != iend; ++i) {
-            bool rc = (data->*cb)(*i);
-            if (rc) return rc;
+        AtomTable::TypeCursor cursor(get_type_cursor(atype, subclass));
+        HandleSeq chunk;
+        while (cursor.next(chunk)) {
+            for (const Handle& h : chunk) {
+                bool rc = (data->*cb)(h);
+                if (rc) return rc;
+            }
         }
         return false;
     }
 
+    /**
+     * Returns a cursor that hands out the atoms of the given type
+     * a chunk at a time, without copying the whole set, and without
+     * holding any lock between chunks.  See AtomTable::TypeCursor.
+     *
+     * Example:
+     * @code
+     *         AtomTable::TypeCursor cursor(as->get_type_cursor(LINK, true));
+     *         HandleSeq chunk;
+     *         while (cursor.next(chunk))
+     *             for (const Handle& h : chunk) ...
+     * @endcode
+     */
+    AtomTable::TypeCursor get_type_cursor(Type type,
+                                          bool subclass = false) const
+    {
+        return atomTable.getTypeCursor(type, subclass);
+    }
+
     /* ----------------------------------------------------------- */
     /* Attentional Focus stuff */
 
@@ -512,7 +527,33 @@ public:
                       AttentionValue::sti_t lowerBound,
                       AttentionValue::sti_t upperBound = AttentionValue::MAXSTI) const
     {
-        UnorderedHandleSet hs = atomTable.getHandlesByAV(lowerBound, upperBound);
+        atomTable.foreachHandleByAV(
+             [&](const Handle& h)->void { *result++ = h; },
+             lowerBound, upperBound);
+        return result;
+    }
+
+    /**
+     * Returns an upper bound on the number of atoms within the given
+     * importance range.  This is cheap: it only adds up the sizes of
+     * the importance bins that overlap the range.
+     */
+    size_t estimate_size_by_AV(AttentionValue::sti_t lowerBound,
+                               AttentionValue::sti_t upperBound = AttentionValue::MAXSTI) const
+    {
+        return atomTable.estimateSizeByAV(lowerBound, upperBound);
+    }
+
+    /**
+     * Returns the k atoms with the highest STI, highest STI first.
+     *
+     * @note: This method utilizes the ImportanceIndex; it does not
+     *        look at all of the atoms in the AtomSpace.
+     */
+    template <typename OutputIterator> OutputIterator
+    get_top_handles_by_STI(OutputIterator result, size_t k) const
+    {
+        HandleSeq hs = atomTable.getTopHandlesBySTI(k);
         return std::copy(hs.begin(), hs.end(), result);
     }
 
@@ -27,6 +27,7 @@
 
 #include "AtomTable.h"
 
+#include <algorithm>
 #include <iterator>
 #include <set>
 
@@ -60,21 +61,13 @@
 
 using namespace opencog;
 
-std::recursive_mutex AtomTable::_mtx;
-
 AtomTable::AtomTable(AtomTable* parent, AtomSpace* holder)
-    : _index_queue(this, &AtomTable::put_atom_into_index)
 {
     _as = holder;
     _environ = parent;
     _uuid = TLB::reserve_extent(1);
     size = 0;
 
-    // Set resolver before doing anything else, such as getting
-    // the atom-added signals.  Just in case some other thread
-    // is busy adding types while we are being created.
-    Handle::set_resolver(this);
-
     // Connect signal to find out about type additions
     addedTypeConnection =
         classserver().addTypeSignal().connect(
@@ -83,17 +76,23 @@ AtomTable::AtomTable(AtomTable* parent, AtomSpace* holder)
 
 AtomTable::~AtomTable()
 {
-    // Disconnect signals. Only then clear the resolver.
-    std::lock_guard<std::recursive_mutex> lck(_mtx);
+    // Finish any pending async work; the workers emit signals and
+    // touch the indexes, so they must be gone before anything else.
+    stop_index_workers();
+
+    // Disconnect signals.
     addedTypeConnection.disconnect();
-    Handle::clear_resolver(this);
 
     // No one who shall look at these atoms ahall ever again
-    // find a reference to this atomtable.
+    // find a reference to this atomtable, nor resolve their uuids.
     UUID undef = Handle::UNDEFINED.value();
-    for (const Handle& h : _atom_set) {
-        h->_atomTable = NULL;
-        h->_uuid = undef;
+    for (UUIDShard& shard : _atom_set) {
+        write_lock lck(shard.mtx);
+        for (const Handle& h : shard.atoms) {
+            TLB::remove(h);
+            h->_atomTable = NULL;
+            h->_uuid = undef;
+        }
     }
 }
 
@@ -108,9 +107,12 @@ bool AtomTable::isCleared(void) const
         return false;
     }
 
-    std::lock_guard<std::recursive_mutex> lck(_mtx);
     // if (nameIndex.size() != 0) return false;
-    if (typeIndex.size() != 0) return false;
+    {
+        read_lock lck(_type_mtx);
+        if (typeIndex.size() != 0) return false;
+    }
+    read_lock lck(_importance_mtx);
     if (importanceIndex.size() != 0) return false;
     return true;
 }
@@ -122,29 +124,88 @@ AtomTable& AtomTable::operator=(const AtomTable& other)
 }
 
 AtomTable::AtomTable(const AtomTable& other)
-    :_index_queue(this, &AtomTable::put_atom_into_index)
 {
     throw opencog::RuntimeException(TRACE_INFO,
             "AtomTable - Cannot copy an object of this class");
 }
 
-Handle AtomTable::getHandle(Type t, std::string name) const
+// ================================================================
+// Shard selection.
+
+size_t AtomTable::node_shard(size_t hash)
+{
+    return hash % NUM_CONTENT_SHARDS;
+}
+
+size_t AtomTable::link_shard(size_t hash)
+{
+    return hash % NUM_CONTENT_SHARDS;
+}
+
+size_t AtomTable::content_shard(const AtomPtr& atom)
+{
+    NodePtr n(NodeCast(atom));
+    if (n) return node_shard(n->get_hash());
+    return link_shard(LinkCast(atom)->get_hash());
+}
+
+Handle AtomTable::lookup_uuid(const Handle& h) const
 {
-    // Special types need validation
+    const UUIDShard& shard(_atom_set[h.value() % NUM_UUID_SHARDS]);
+    read_lock lck(shard.mtx);
+    auto hit = shard.atoms.find(h);
+    if (hit != shard.atoms.end())
+        return *hit;
+    return Handle::UNDEFINED;
+}
+
+void AtomTable::insert_uuid(const Handle& h)
+{
+    UUIDShard& shard(_atom_set[h.value() % NUM_UUID_SHARDS]);
+    write_lock lck(shard.mtx);
+    shard.atoms.insert(h);
+}
+
+void AtomTable::erase_uuid(const Handle& h)
+{
+    UUIDShard& shard(_atom_set[h.value() % NUM_UUID_SHARDS]);
+    write_lock lck(shard.mtx);
+    shard.atoms.erase(h);
+}
+
+// ================================================================
+
+Handle AtomTable::getHandle(Type t, const boost::string_ref& name) const
+{
+    // Special types need validation.  Only these need a std::string;
+    // all other lookups work directly on the caller's characters.
     try {
         if (NUMBER_NODE == t) {
-            name = NumberNode::validate(name);
+            std::string canon(NumberNode::validate(name.to_string()));
+            return getHandle(t, canon, Node::compute_hash(t, canon));
         } else if (TYPE_NODE == t) {
-            TypeNode::validate(name);
+            TypeNode::validate(name.to_string());
         }
     }
     catch (...) { return Handle::UNDEFINED; }
 
-    std::lock_guard<std::recursive_mutex> lck(_mtx);
-    Atom* atom = nodeIndex.getAtom(t, name);
-    if (atom) return atom->getHandle();
-    if (_environ and NULL == atom)
-        return _environ->getHandle(t, name);
+    return getHandle(t, name, Node::compute_hash(t, name));
+}
+
+Handle AtomTable::getHandle(Type t, const boost::string_ref& name,
+                            size_t hash) const
+{
+    {
+        const ContentShard& shard(_content[node_shard(hash)]);
+        read_lock lck(shard.mtx);
+        Atom* atom = shard.nodeIndex.getAtom(t, name, hash);
+        if (atom) return atom->getHandle();
+    }
+
+    // Search the environment only after unlocking; we never hold
+    // a lock while calling into another atomtable.
+    if (_environ)
+        return _environ->getHandle(t, name, hash);
     return Handle::UNDEFINED;
 }
 
@@ -159,7 +220,11 @@ Handle AtomTable::getHandle(const NodePtr& n) const
         env = env->_environ;
     } while (env);
 
-    return getHandle(n->getType(), n->getName());
+    // Use the cached hash, unless the name needs validation.
+    Type t = n->getType();
+    if (NUMBER_NODE == t or TYPE_NODE == t)
+        return getHandle(t, n->getName());
+    return getHandle(t, n->getName(), n->get_hash());
 }
 
 Handle AtomTable::getHandle(Type t, const HandleSeq &seq) const
@@ -181,8 +246,13 @@ Handle AtomTable::getHandle(Type t, const HandleSeq &seq) const
         std::sort(resolved_seq.begin(), resolved_seq.end(), HandleComparison());
     }
 
-    std::lock_guard<std::recursive_mutex> lck(_mtx);
-    Handle h(linkIndex.getHandle(t, resolved_seq));
+    size_t hash = Link::compute_hash(t, resolved_seq);
+    Handle h;
+    {
+        const ContentShard& shard(_content[link_shard(hash)]);
+        read_lock lck(shard.mtx);
+        h = shard.linkIndex.getHandle(t, resolved_seq, hash);
+    }
     if (_environ and Handle::UNDEFINED == h)
         return _environ->getHandle(t, resolved_seq);
     return h;
@@ -241,14 +311,8 @@ Handle AtomTable::getHandle(Handle& h) const
         return getHandle(AtomPtr(h));
     }
 
-    // Read-lock for the _atom_set.
-    std::lock_guard<std::recursive_mutex> lck(_mtx);
-
     // If we have a uuid but no atom pointer, find the atom pointer.
-    auto hit = _atom_set.find(h);
-    if (hit != _atom_set.end())
-        return *hit;
-    return Handle::UNDEFINED;
+    return lookup_uuid(h);
 }
 
 
@@ -396,15 +460,6 @@ Handle AtomTable::add(AtomPtr atom, bool async)
           "AtomTable - Attempting to insert atom with handle already set!");
 #endif
 
-    // Lock before checking to see if this kind of atom can already
-    // be found in the atomspace.  We need to lock here, to avoid two
-    // different threads from trying to add exactly the same atom.
-    std::unique_lock<std::recursive_mutex> lck(_mtx);
-
-    // Check again, under the lock this time.
-    if (inEnviron(atom))
-        return atom->getHandle();
-
     // Factory implements experimental C++ atom types support code
     Type atom_type = atom->getType();
     atom = factory(atom_type, atom);
@@ -416,6 +471,12 @@ Handle AtomTable::add(AtomPtr atom, bool async)
     Handle hexist(getHandle(atom));
     if (hexist) return hexist;
 
+    // Note that no locks are held during any of the preparation below;
+    // in particular, the recursive add of the outgoing set must not
+    // be done while holding a lock. The lock is taken at the very end,
+    // when the atom is actually inserted into the indexes, and the
+    // check for an existing, equivalent atom is repeated at that time.
+
     // If this atom is in some other atomspace, then we need to clone
     // it. We cannot insert it into this atomtable as-is.  (We already
     // know that its not in this atomspace, or its environ.)
@@ -471,9 +532,9 @@ Handle AtomTable::add(AtomPtr atom, bool async)
                                "AtomTable - Attempting to insert link with "
                                "invalid outgoing members");
                 }
-                auto it = _atom_set.find(h);
-                if (it != _atom_set.end()) {
-                    h = *it;
+                Handle hu(lookup_uuid(h));
+                if (hu) {
+                    h = hu;
 
                     // OK, here's the deal. We really need to fixup
                     // link so that it holds a valid atom pointer. We
@@ -544,8 +605,6 @@ Handle AtomTable::add(AtomPtr atom, bool async)
                 // set. Fix the handles' UUID, by forcing a cast.
                 llc->_outgoing[i] = ((AtomPtr) llc->_outgoing[i]);
             }
-            // Build the incoming set of outgoing atom h.
-            llc->_outgoing[i]->insert_atom(llc);
         }
 
         // OK, so if the above fixed up the outgoing set, and
@@ -556,6 +615,33 @@ Handle AtomTable::add(AtomPtr atom, bool async)
         if (classserver().isA(llc->getType(), UNORDERED_LINK)) {
             llc->resort();
         }
+
+        // The UUIDs in the outgoing set may have changed, and so the
+        // content hash has to be recomputed.
+        llc->_content_hash = 0;
+    }
+
+    // Lock the shard that this atom belongs in, and check again, under
+    // the lock this time.  We need to lock here, to avoid two different
+    // threads from trying to add exactly the same atom, or two
+    // equivalent atoms.
+    ContentShard& shard(_content[content_shard(atom)]);
+    write_lock lck(shard.mtx);
+
+    if (inEnviron(atom))
+        return atom->getHandle();
+
+    NodePtr nnn(NodeCast(atom));
+    LinkPtr llc(LinkCast(atom));
+    if (nnn) {
+        Atom* arace = shard.nodeIndex.getAtom(atom_type, nnn->getName(),
+                                              nnn->get_hash());
+        if (arace) return arace->getHandle();
+    } else {
+        Handle hrace(shard.linkIndex.getHandle(atom_type,
+                                               llc->getOutgoingSet(),
+                                               llc->get_hash()));
+        if (hrace) return hrace;
     }
 
     // Its possible that the atom already has a UUID assigned,
@@ -570,12 +656,27 @@ Handle AtomTable::add(AtomPtr atom, bool async)
        TLB::reserve_upto(atom->_uuid);
     }
     Handle h(atom->getHandle());
-    size++;
-    _atom_set.insert(h);
 
     atom->keep_incoming_set();
     atom->setAtomTable(this);
 
+    // Build the incoming sets of the outgoing atoms.
+    if (llc) {
+        for (const Handle& ho : llc->_outgoing)
+            ho->insert_atom(llc);
+    }
+
+    // The atom becomes visible to other threads as soon as it is in
+    // the content index; but they cannot see it until we unlock.
+    Atom* pat = atom.operator->();
+    if (nnn)
+        shard.nodeIndex.insertAtom(pat);
+    else
+        shard.linkIndex.insertAtom(atom);
+    insert_uuid(h);
+    TLB::enter(atom);
+    size++;
+
     if (not async)
         put_atom_into_index(atom);
 
@@ -584,9 +685,12 @@ Handle AtomTable::add(AtomPtr atom, bool async)
     // additions.
     lck.unlock();
 
-    // Update the indexes asynchronously
-    if (async)
-        _index_queue.enqueue(atom);
+    // Update the indexes asynchronously; the index worker will emit
+    // the added signal when it is done.
+    if (async) {
+        enqueue_index(atom);
+        return h;
+    }
 
     // Now that we are completely done, emit the added signal.
     _addAtomSignal(h);
@@ -595,19 +699,131 @@ Handle AtomTable::add(AtomPtr atom, bool async)
     return h;
 }
 
+/// Place the atom into the type and importance indexes.  The node and
+/// link indexes are always updated synchronously, in add(), since they
+/// are needed to avoid inserting duplicate atoms.
 void AtomTable::put_atom_into_index(AtomPtr& atom)
 {
-    std::unique_lock<std::recursive_mutex> lck(_mtx);
     Atom* pat = atom.operator->();
-    nodeIndex.insertAtom(pat);
-    linkIndex.insertAtom(atom);
-    typeIndex.insertAtom(pat);
+    {
+        write_lock lck(_type_mtx);
+        typeIndex.insertAtom(pat);
+    }
+    write_lock lck(_importance_mtx);
     importanceIndex.insertAtom(pat);
 }
 
+// ================================================================
+// The async index pipeline.
+
+void AtomTable::enqueue_index(const AtomPtr& atom)
+{
+    std::call_once(_index_workers_started, [this]() {
+        for (IndexQueue& q : _index_queue)
+            q.worker = std::thread(&AtomTable::index_worker, this, &q);
+    });
+
+    IndexQueue& q(_index_queue[atom->_uuid % NUM_INDEX_WORKERS]);
+    std::lock_guard<std::mutex> lck(q.mtx);
+    q.pending.push_back(atom);
+    q.outstanding++;
+    // Only the first arrival needs to wake the worker; the others
+    // are picked up as part of the same batch.
+    if (1 == q.pending.size())
+        q.work_cv.notify_one();
+}
+
+void AtomTable::index_worker(IndexQueue* q)
+{
+    std::vector<AtomPtr> batch;
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lck(q->mtx);
+            q->work_cv.wait(lck, [q]() {
+                return q->stop or not q->pending.empty(); });
+
+            // Drain everything before honouring a stop request.
+            if (q->pending.empty()) return;
+            batch.swap(q->pending);
+        }
+        size_t nbatch = batch.size();
+
+        put_batch_into_index(batch);
+
+        // Signals are delivered unlocked, since the handlers may well
+        // add more atoms.
+        for (const AtomPtr& atom : batch)
+            _addAtomSignal(atom->getHandle());
+        batch.clear();
+
+        std::lock_guard<std::mutex> lck(q->mtx);
+        q->outstanding -= nbatch;
+        if (0 == q->outstanding)
+            q->done_cv.notify_all();
+    }
+}
+
+/// Insert a batch of atoms into the type and importance indexes,
+/// taking each index lock only once.  Atoms that were extracted while
+/// they sat in the queue are skipped, and dropped from the batch, so
+/// that no signal is sent for them.  Atoms that are only marked for
+/// removal are set aside; see cancel_removal().  Both locks are held
+/// together so that extract() cannot slip in between the two
+/// insertions.
+void AtomTable::put_batch_into_index(std::vector<AtomPtr>& batch)
+{
+    write_lock tlck(_type_mtx);
+    write_lock ilck(_importance_mtx);
+    std::lock_guard<std::mutex> dlck(_deferred_mtx);
+    size_t keep = 0;
+    for (size_t i = 0; i < batch.size(); i++)
+    {
+        Atom* pat = batch[i].operator->();
+        if (pat->_atomTable != this)
+            continue;
+        if (pat->isMarkedForRemoval()) {
+            _deferred_index.insert(batch[i]);
+            continue;
+        }
+        typeIndex.insertAtom(pat);
+        importanceIndex.insertAtom(pat);
+        if (keep != i) batch[keep].swap(batch[i]);
+        keep++;
+    }
+    batch.resize(keep);
+}
+
+/// Lift the removal mark from an atom that extract() decided not to
+/// remove after all.  Returns true if an index worker skipped the atom
+/// while it was marked; the caller must then index it, and send the
+/// added signal that the worker held back.
+bool AtomTable::cancel_removal(const AtomPtr& atom)
+{
+    std::lock_guard<std::mutex> lck(_deferred_mtx);
+    atom->unsetRemovalFlag();
+    return 0 < _deferred_index.erase(atom);
+}
+
+void AtomTable::stop_index_workers()
+{
+    for (IndexQueue& q : _index_queue) {
+        {
+            std::lock_guard<std::mutex> lck(q.mtx);
+            q.stop = true;
+            q.work_cv.notify_one();
+        }
+        if (q.worker.joinable()) q.worker.join();
+    }
+}
+
 void AtomTable::barrier()
 {
-    _index_queue.flush_queue();
+    for (IndexQueue& q : _index_queue) {
+        std::unique_lock<std::mutex> lck(q.mtx);
+        if (0 == q.outstanding) continue;
+        q.done_cv.wait(lck, [&q]() { return 0 == q.outstanding; });
+    }
 }
 
 size_t AtomTable::getSize() const
@@ -617,20 +833,31 @@ size_t AtomTable::getSize() const
 
 size_t AtomTable::getNumNodes() const
 {
-    std::lock_guard<std::recursive_mutex> lck(_mtx);
-    return nodeIndex.size();
+    size_t cnt = 0;
+    for (const ContentShard& shard : _content) {
+        read_lock lck(shard.mtx);
+        cnt += shard.nodeIndex.size();
+    }
+    return cnt;
 }
 
 size_t AtomTable::getNumLinks() const
 {
-    std::lock_guard<std::recursive_mutex> lck(_mtx);
-    return linkIndex.size();
+    size_t cnt = 0;
+    for (const ContentShard& shard : _content) {
+        read_lock lck(shard.mtx);
+        cnt += shard.linkIndex.size();
+    }
+    return cnt;
 }
 
 size_t AtomTable::getNumAtomsOfType(Type type, bool subclass) const
 {
-    std::lock_guard<std::recursive_mutex> lck(_mtx);
-    size_t result = typeIndex.getNumAtomsOfType(type, subclass);
+    size_t result;
+    {
+        read_lock lck(_type_mtx);
+        result = typeIndex.getNumAtomsOfType(type, subclass);
+    }
 
     if (_environ)
         result += _environ->getNumAtomsOfType(type, subclass);
@@ -638,6 +865,41 @@ size_t AtomTable::getNumAtomsOfType(Type type, bool subclass) const
     return result;
 }
 
+// ================================================================
+// The chunked type cursor.
+
+AtomTable::TypeCursor::TypeCursor(const AtomTable* table, Type type,
+                                  bool subclass, bool parent)
+    : _table(0), _type(type), _subclass(subclass),
+      _upto(TLB::getMaxUUID())
+{
+    // Walk the parents first, just like getHandlesByType() always did.
+    for (const AtomTable* t = table; t; t = parent ? t->_environ : NULL)
+        _tables.push_back(t);
+    std::reverse(_tables.begin(), _tables.end());
+}
+
+bool AtomTable::TypeCursor::next(HandleSeq& chunk, size_t n)
+{
+    chunk.clear();
+    while (chunk.size() < n and _table < _tables.size())
+    {
+        const AtomTable* t = _tables[_table];
+        bool more;
+        {
+            read_lock lck(t->_type_mtx);
+            more = t->typeIndex.fetch(_type, _subclass, _upto, _pos,
+                                      chunk, n - chunk.size());
+        }
+        if (not more)
+        {
+            _table++;
+            _pos = TypeIndex::Position();
+        }
+    }
+    return not chunk.empty();
+}
+
 Handle AtomTable::getRandom(RandGen *rng) const
 {
     size_t x = rng->randint(getSize());
@@ -673,14 +935,17 @@ AtomPtrSet AtomTable::extract(Handle& handle, bool recursive)
     // silent about this error -- it seems pointless to throw.
     if (atom->getAtomTable() != this) return result;
 
-    // Lock before fetching the incoming set. Since getting the
-    // incoming set also grabs a lock, we need this mutex to be
-    // recursive. We need to lock here to avoid confusion if multiple
-    // threads are trying to delete the same atom.
-    std::unique_lock<std::recursive_mutex> lck(_mtx);
+    // Lock the shard holding this atom. We need to lock here to avoid
+    // confusion if multiple threads are trying to delete the same atom.
+    // The lock is dropped while the incoming set is being extracted,
+    // since that recurses, possibly into other atomtables; the removal
+    // flag keeps everyone else away, in the meanwhile.
+    ContentShard& shard(_content[content_shard(atom)]);
+    write_lock lck(shard.mtx);
 
     if (atom->isMarkedForRemoval()) return result;
     atom->markForRemoval();
+    lck.unlock();
 
     // If recursive-flag is set, also extract all the links in the atom's
     // incoming set
@@ -730,7 +995,16 @@ AtomPtrSet AtomTable::extract(Handle& handle, bool recursive)
             {
                 // User asked for a non-recursive remove, and the
                 // atom is still referenced. So, do nothing.
-                handle->unsetRemovalFlag();
+                lck.lock();
+                bool deferred = cancel_removal(atom);
+                lck.unlock();
+
+                // An index worker may have skipped this atom while it
+                // was marked; if so, finish what the worker held back.
+                if (deferred) {
+                    put_atom_into_index(atom);
+                    _addAtomSignal(handle);
+                }
                 return result;
             }
 
@@ -775,7 +1049,10 @@ AtomPtrSet AtomTable::extract(Handle& handle, bool recursive)
                                         << " Table: " << ((void*) iset[j]->getAtomTable());
                     }
                     logger().setBackTraceLevel(lev);
-                    atom->unsetRemovalFlag();
+                    if (cancel_removal(atom)) {
+                        put_atom_into_index(atom);
+                        _addAtomSignal(handle);
+                    }
                     throw RuntimeException(TRACE_INFO,
                         "Internal Error: Cannot extract an atom with "
                         "a non-empty incoming set!");
@@ -788,25 +1065,34 @@ AtomPtrSet AtomTable::extract(Handle& handle, bool recursive)
     // removed.  This is needed so that certain subsystems, e.g. the
     // Agent system activity table, can correctly manage the atom;
     // it needs info that gets blanked out during removal.
-    lck.unlock();
     _removeAtomSignal(atom);
     lck.lock();
 
+    // Remove from the content index first, and only then from the
+    // atom set; see the comments on _atom_set for why.
+    Atom* pat = atom.operator->();
+    shard.nodeIndex.removeAtom(pat);
+    shard.linkIndex.removeAtom(atom);
+
     // Decrements the size of the table
     size--;
-    _atom_set.erase(handle);
+    erase_uuid(handle);
+    TLB::remove(atom);
 
-    Atom* pat = atom.operator->();
-    nodeIndex.removeAtom(pat);
-    linkIndex.removeAtom(atom);
-    typeIndex.removeAtom(pat);
+    {
+        write_lock tlck(_type_mtx);
+        typeIndex.removeAtom(pat);
+    }
     LinkPtr lll(LinkCast(atom));
     if (lll) {
         for (AtomPtr a : lll->_outgoing) {
             a->remove_atom(lll);
         }
     }
-    importanceIndex.removeAtom(pat);
+    {
+        write_lock ilck(_importance_mtx);
+        importanceIndex.removeAtom(pat);
+    }
 
     // XXX Setting the atom table causes AVChanged signals to be emitted.
     // We should really do this unlocked, but I'm too lazy to fix, and
@@ -814,6 +1100,14 @@ AtomPtrSet AtomTable::extract(Handle& handle, bool recursive)
     // someday.
     atom->setAtomTable(NULL);
 
+    // A worker may have set the atom aside while it was marked.  This
+    // is done last, since a worker only does so for atoms that are
+    // still in this table.
+    {
+        std::lock_guard<std::mutex> dlck(_deferred_mtx);
+        _deferred_index.erase(atom);
+    }
+
     result.insert(atom);
     return result;
 }
@@ -821,10 +1115,9 @@ AtomPtrSet AtomTable::extract(Handle& handle, bool recursive)
 // This is the resize callback, when a new type is dynamically added.
 void AtomTable::typeAdded(Type t)
 {
-    std::lock_guard<std::recursive_mutex> lck(_mtx);
-    //resize all Type-based indexes
-    nodeIndex.resize();
-    linkIndex.resize();
+    // Resize all Type-based indexes. The node and link indexes
+    // resize themselves lazily, under the shard locks, as needed.
+    write_lock lck(_type_mtx);
     typeIndex.resize();
 }
 
@@ -25,13 +25,20 @@
 #ifndef _OPENCOG_ATOMTABLE_H
 #define _OPENCOG_ATOMTABLE_H
 
+#include <atomic>
+#include <condition_variable>
 #include <iostream>
+#include <mutex>
 #include <set>
+#include <thread>
+#include <unordered_set>
 #include <vector>
 
 #include <boost/signals2.hpp>
+#include <boost/utility/string_ref.hpp>
+#include <boost/thread/locks.hpp>
+#include <boost/thread/shared_mutex.hpp>
 
-#include <opencog/util/async_method_caller.h>
 #include <opencog/util/exceptions.h>
 #include <opencog/util/Logger.h>
 #include <opencog/util/RandGen.h>
@@ -83,37 +90,118 @@ class AtomTable
 
 private:
 
-    // Single, global mutex for locking the indexes.
-    // Its recursive because we need to lock twice during atom insertion
-    // and removal: we need to keep the indexes stable while we search
-    // them during add/remove.
-    static std::recursive_mutex _mtx;
+    // There is no single, global lock for the atomtables. Instead,
+    // each index has its own reader-writer lock, so that lookups can
+    // run in parallel with one-another, and only wait when a writer
+    // is touching exactly the same part of the same index.  Locks are
+    // never held while calling into another atomtable (e.g. the parent
+    // environment), and, within one table, they are always taken in
+    // the order: content shard, uuid shard, type index, importance
+    // index.  Readers only ever hold one lock at a time.
+    typedef boost::shared_mutex index_mutex;
+    typedef boost::shared_lock<index_mutex> read_lock;
+    typedef boost::unique_lock<index_mutex> write_lock;
+
+    std::atomic<size_t> size;
+
+    // The node and link indexes are split into shards, according to a
+    // hash of the atom contents: the type and name for nodes, and the
+    // type and outgoing set for links.  Two different atoms will
+    // almost always land in different shards, and so can be inserted
+    // concurrently.  Two equivalent atoms always land in the same
+    // shard; holding the shard's write lock is what guarantees that
+    // an atom is never inserted twice.
+    static const size_t NUM_CONTENT_SHARDS = 64;
+    struct ContentShard
+    {
+        mutable index_mutex mtx;
+        NodeIndex nodeIndex;
+        LinkIndex linkIndex;
+    };
+    ContentShard _content[NUM_CONTENT_SHARDS];
 
-    size_t size;
+    static size_t node_shard(size_t hash);
+    static size_t link_shard(size_t hash);
+    static size_t content_shard(const AtomPtr&);
 
     // Holds all atoms in the table.  Provides lookup between numeric
     // handle uuid and the actual atom pointer (since they are stored
     // together).  To some degree, this info is duplicated in the Node
-    // and LinkIndex below; we have this here for convenience.
+    // and LinkIndex above; we have this here for convenience.
     //
     // This also plays a critical role for memory management: this is
     // the only index that actually holds the atom shared_ptr, and thus
     // increments the atom use count in a guaranteed fashion.  This is
     // the one true guaranteee that the atom will not be deleted while
-    // it is in the atom table.
-    std::unordered_set<Handle, handle_hash> _atom_set;
+    // it is in the atom table.  Atoms are always removed from the
+    // content index before they are removed from here, so that any
+    // atom found in the content index is still alive.
+    //
+    // The set is sharded by UUID, for the same reasons as above.
+    static const size_t NUM_UUID_SHARDS = 64;
+    struct UUIDShard
+    {
+        mutable index_mutex mtx;
+        std::unordered_set<Handle, handle_hash> atoms;
+    };
+    UUIDShard _atom_set[NUM_UUID_SHARDS];
+
+    Handle lookup_uuid(const Handle&) const;
+
+    // Node lookup, once the name is validated and its hash known.
+    Handle getHandle(Type, const boost::string_ref&, size_t hash) const;
+    void insert_uuid(const Handle&);
+    void erase_uuid(const Handle&);
 
     //!@{
     //! Index for quick retreival of certain kinds of atoms.
+    mutable index_mutex _type_mtx;
     TypeIndex typeIndex;
-    NodeIndex nodeIndex;
-    LinkIndex linkIndex;
+    mutable index_mutex _importance_mtx;
     ImportanceIndex importanceIndex;
 
-    async_caller<AtomTable, AtomPtr> _index_queue;
     void put_atom_into_index(AtomPtr&);
     //!@}
 
+    /**
+     * Asynchronous index-update pipeline.  Atoms added with the async
+     * flag set are deduplicated and placed into the content index by
+     * add() itself; updating the type and importance indexes, and
+     * emitting the atom-added signal, is handed off to one of several
+     * worker threads.  Each worker drains its entire queue at once,
+     * taking the index locks once per batch, instead of once per atom.
+     * The workers are started on the first async add, so that tables
+     * that never see one do not pay for them.
+     */
+    static const size_t NUM_INDEX_WORKERS = 4;
+    struct IndexQueue
+    {
+        std::mutex mtx;
+        std::condition_variable work_cv;  // signalled when work arrives
+        std::condition_variable done_cv;  // signalled when drained
+        std::vector<AtomPtr> pending;
+        size_t outstanding;               // enqueued, but not yet indexed
+        bool stop;
+        std::thread worker;
+        IndexQueue() : outstanding(0), stop(false) {}
+    };
+    IndexQueue _index_queue[NUM_INDEX_WORKERS];
+    std::once_flag _index_workers_started;
+
+    void enqueue_index(const AtomPtr&);
+    void index_worker(IndexQueue*);
+    void put_batch_into_index(std::vector<AtomPtr>&);
+    void stop_index_workers();
+
+    // Atoms that a worker skipped because they were marked for
+    // removal at the time.  If the removal is then called off, the
+    // atom is indexed, and its added signal sent, after all.  The
+    // mutex makes the worker's check-and-defer atomic with respect to
+    // extract() lifting the mark.
+    std::mutex _deferred_mtx;
+    std::unordered_set<AtomPtr> _deferred_index;
+    bool cancel_removal(const AtomPtr&);
+
     /**
      * signal connection used to find out about atom type additions in the
      * ClassServer
@@ -182,7 +270,7 @@ public:
      * @param The type of the desired atom.
      * @return The handle of the desired atom if found.
      */
-    Handle getHandle(Type, std::string) const;
+    Handle getHandle(Type, const boost::string_ref&) const;
     Handle getHandle(const NodePtr&) const;
 
     Handle getHandle(Type, const HandleSeq&) const;
@@ -191,6 +279,48 @@ public:
     Handle getHandle(Handle&) const;
 
 public:
+    /**
+     * A cursor over the atoms of a given type (subclasses optionally),
+     * in this table and, optionally, in its parent tables.  The atoms
+     * are handed out a chunk at a time; the type index is read-locked
+     * only while a chunk is being filled.  Thus, writers are never
+     * blocked for long, and the consumer is free to add and remove
+     * atoms while it works through a chunk.
+     *
+     * As far as additions go, the walk is a snapshot: atoms that get
+     * their UUID after the cursor was created are never returned.
+     * Atoms that are removed before the walk gets to them are not
+     * returned.  Each atom is returned at most once.
+     *
+     * The cursor must not outlive the tables that it walks.
+     */
+    class TypeCursor
+    {
+        friend class AtomTable;
+        std::vector<const AtomTable*> _tables;   // parents first
+        size_t _table;
+        Type _type;
+        bool _subclass;
+        UUID _upto;
+        TypeIndex::Position _pos;
+
+        TypeCursor(const AtomTable*, Type, bool subclass, bool parent);
+    public:
+        /**
+         * Replace the contents of chunk by the next (at most) n
+         * handles.  Returns false, with chunk empty, once the walk
+         * is over.
+         */
+        bool next(HandleSeq& chunk, size_t n = 1024);
+    };
+
+    TypeCursor getTypeCursor(Type type,
+                             bool subclass = false,
+                             bool parent = true) const
+    {
+        return TypeCursor(this, type, subclass, parent);
+    }
+
     /**
      * Returns the set of atoms of a given type (subclasses optionally).
      *
@@ -204,29 +334,28 @@ public:
                      bool subclass = false,
                      bool parent = true) const
     {
-        std::lock_guard<std::recursive_mutex> lck(_mtx);
-        if (parent && _environ)
-            _environ->getHandlesByType(result, type, subclass, parent);
-        return std::copy(typeIndex.begin(type, subclass),
-                         typeIndex.end(),
-                         result);
+        TypeCursor cursor(getTypeCursor(type, subclass, parent));
+        HandleSeq chunk;
+        while (cursor.next(chunk))
+            result = std::copy(chunk.begin(), chunk.end(), result);
+        return result;
     }
 
-    /** Calls function 'func' on all atoms */
+    /**
+     * Calls function 'func' on all atoms of a given type (subclasses
+     * optionally).  No lock is held while 'func' runs; see TypeCursor.
+     */
     template <typename Function> void
     foreachHandleByType(Function func,
                         Type type,
                         bool subclass = false,
                         bool parent = true) const
     {
-        std::lock_guard<std::recursive_mutex> lck(_mtx);
-        if (parent && _environ)
-            _environ->foreachHandleByType(func, type, subclass);
-        std::for_each(typeIndex.begin(type, subclass),
-                      typeIndex.end(),
-             [&](Handle h)->void {
-                  (func)(h);
-             });
+        TypeCursor cursor(getTypeCursor(type, subclass, parent));
+        HandleSeq chunk;
+        while (cursor.next(chunk))
+            for (const Handle& h : chunk)
+                (func)(h);
     }
 
     /**
@@ -239,22 +368,65 @@ public:
     UnorderedHandleSet getHandlesByAV(AttentionValue::sti_t lowerBound,
                               AttentionValue::sti_t upperBound = AttentionValue::MAXSTI) const
     {
-        std::lock_guard<std::recursive_mutex> lck(_mtx);
+        read_lock lck(_importance_mtx);
         return importanceIndex.getHandleSet(this, lowerBound, upperBound);
     }
 
+    /**
+     * Calls function 'func' on all atoms within the given (inclusive)
+     * importance range.  The importance index is read-locked during
+     * the traversal; thus, 'func' must not add or remove atoms, nor
+     * change the attention value of any atom in this atomtable.
+     */
+    template <typename Function> void
+    foreachHandleByAV(Function func,
+                      AttentionValue::sti_t lowerBound,
+                      AttentionValue::sti_t upperBound = AttentionValue::MAXSTI) const
+    {
+        read_lock lck(_importance_mtx);
+        importanceIndex.foreachInRange(
+             [&](Atom* atom)->void {
+                  (func)(atom->getHandle());
+             }, lowerBound, upperBound);
+    }
+
+    /**
+     * Returns an upper bound on the number of atoms within the given
+     * importance range, in time proportional to the number of
+     * importance bins spanned.
+     */
+    size_t estimateSizeByAV(AttentionValue::sti_t lowerBound,
+                            AttentionValue::sti_t upperBound = AttentionValue::MAXSTI) const
+    {
+        read_lock lck(_importance_mtx);
+        return importanceIndex.estimateSize(lowerBound, upperBound);
+    }
+
+    /**
+     * Returns the k atoms with the highest STI, highest first.
+     */
+    HandleSeq getTopHandlesBySTI(size_t k) const
+    {
+        read_lock lck(_importance_mtx);
+        return importanceIndex.getTopSTI(k);
+    }
+
     /**
      * Updates the importance index for the given atom. According to the
      * new importance of the atom, it may change importance bins.
      *
      * @param The atom whose importance index will be updated.
-     * @param The old importance bin where the atom originally was.
+     * @param The old STI of the atom.
      */
-    void updateImportanceIndex(AtomPtr a, int bin)
+    void updateImportanceIndex(AtomPtr a, AttentionValue::sti_t oldsti)
     {
         if (a->_atomTable != this) return;
-        std::lock_guard<std::recursive_mutex> lck(_mtx);
-        importanceIndex.updateImportance(a.operator->(), bin);
+        // The bin width never changes, so moves within a bin can be
+        // skipped without taking the lock.
+        if (importanceIndex.importanceBin(oldsti) ==
+            importanceIndex.importanceBin(a->getSTI())) return;
+        write_lock lck(_importance_mtx);
+        importanceIndex.updateImportance(a.operator->(), oldsti);
     }
 
     /**
@@ -269,11 +441,11 @@ public:
      * lots of parallel adds.  The barrier() method can be used to
      * force synchronization.
      *
-     * XXX The async code path doesn't really do anything yet, since
-     * it also uses the big global lock, at the moment.  This needs
-     * fixing, mostly be creating a second mutex for the atom insertion,
-     * and also giving each index its own uique mutex, to avoid
-     * collsions.  So teh API is here, but more work is stil needed.
+     * More precisely: an async add is deduplicated, given a UUID and
+     * made findable by name or outgoing set (getHandle()) before this
+     * method returns.  It shows up in the by-type and by-importance
+     * queries, and the atom-added signal is delivered, only later,
+     * from one of the index worker threads.
      *
      * @param The new atom to be added.
      * @return The handle of the newly added atom.
@@ -283,7 +455,11 @@ public:
     /**
      * Read-write synchronization barrier fence.  When called, this
      * will not return until all the atoms previously added to the
-     * atomspace have been fully inserted.
+     * atomspace have been fully inserted.  Only the index queues that
+     * still have outstanding work are waited on.
+     *
+     * This must not be called from an atom-added signal handler, since
+     * those are run by the index workers for async adds.
      */
     void barrier(void);
 
@@ -0,0 +1,348 @@
+/*
+ * opencog/atomspace/BackingStoreCache.cc
+ *
+ * Copyright (C) 2015 OpenCog Foundation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <stdio.h>
+
+#include <functional>
+
+#include "BackingStoreCache.h"
+
+using namespace opencog;
+
+BackingStoreCache::BackingStoreCache(BackingStore *backing,
+                                     size_t max_entries) :
+	_backing(backing), _capacity(max_entries), _generation(0),
+	_pending_until(0), _stores(0),
+	_hits(0), _negative_hits(0), _misses(0), _evictions(0)
+{}
+
+/* ================================================================ */
+
+size_t BackingStoreCache::KeyHash::operator()(const Key& k) const
+{
+	size_t h = std::hash<std::string>()(k.name) ^ k.type;
+	for (UUID u : k.oset)
+		h = h * 31 + std::hash<UUID>()(u);
+	return h;
+}
+
+BackingStoreCache::Key BackingStoreCache::node_key(Type t, const char *name)
+{
+	Key k;
+	k.type = t;
+	k.name = name;
+	return k;
+}
+
+BackingStoreCache::Key BackingStoreCache::link_key(Type t, const HandleSeq& oset)
+{
+	Key k;
+	k.type = t;
+	for (const Handle& h : oset)
+		k.oset.push_back(h.value());
+	return k;
+}
+
+/* ================================================================ */
+
+/// Return true if the key is in the cache; the atom is NULL if the
+/// backing store does not have it.  A miss returns the generation, to
+/// be handed back to insert().
+bool BackingStoreCache::lookup(const Key& k, AtomPtr& atom,
+                               unsigned long& gen) const
+{
+	std::lock_guard<std::mutex> lck(_mtx);
+	auto it = _map.find(k);
+	if (it != _map.end())
+	{
+		atom = it->second->atom.lock();
+
+		// The atom was freed since; ask the backing store again.
+		if (it->second->found and NULL == atom)
+		{
+			_lru.erase(it->second);
+			_map.erase(it);
+			it = _map.end();
+		}
+	}
+	if (it == _map.end())
+	{
+		_misses++;
+		gen = _generation;
+		return false;
+	}
+
+	// Move it to the front of the list.
+	_lru.splice(_lru.begin(), _lru, it->second);
+	if (atom) _hits++;
+	else _negative_hits++;
+	return true;
+}
+
+/// Remember the answer of the backing store.  If anything was
+/// forgotten since the lookup, the answer may already be out of date,
+/// and so is not remembered.  Neither is the answer about an atom
+/// whose store may not have been written yet.
+void BackingStoreCache::insert(const Key& k, const AtomPtr& atom,
+                               unsigned long gen) const
+{
+	std::lock_guard<std::mutex> lck(_mtx);
+	if (0 == _capacity or gen != _generation) return;
+	if (0 < _pending_until) return;
+	if (_pending.find(k) != _pending.end()) return;
+
+	auto it = _map.find(k);
+	if (it != _map.end())
+	{
+		it->second->found = (NULL != atom);
+		it->second->atom = atom;
+		_lru.splice(_lru.begin(), _lru, it->second);
+		return;
+	}
+
+	_lru.push_front(Entry{k, NULL != atom, atom});
+	_map[k] = _lru.begin();
+	trim();
+}
+
+/// Drop the pending keys, and instead cache nothing at all until
+/// the barrier after the current store.  The caller must hold the
+/// lock.
+void BackingStoreCache::hold_all(void)
+{
+	_pending.clear();
+	_pending_until = _stores;
+}
+
+/// Evict the least recently used entries, until the cache fits.
+/// The caller must hold the lock.
+void BackingStoreCache::trim(void) const
+{
+	while (_capacity < _lru.size())
+	{
+		_map.erase(_lru.back().key);
+		_lru.pop_back();
+		_evictions++;
+	}
+}
+
+/// Forget the key, and cache nothing for it until the barrier after
+/// the current store.  Past as many pending keys as the cache holds,
+/// nothing at all is cached until that barrier.
+void BackingStoreCache::forget(const Key& k)
+{
+	std::lock_guard<std::mutex> lck(_mtx);
+	_generation++;
+	if (0 == _capacity) return;
+
+	if (0 < _pending_until)
+		_pending_until = _stores;
+	else if (_pending.size() < _capacity)
+		_pending[k] = _stores;
+	else
+		hold_all();
+
+	auto it = _map.find(k);
+	if (it == _map.end()) return;
+	_lru.erase(it->second);
+	_map.erase(it);
+}
+
+/// Forget the atom, and, if it is a link, everything in it; the
+/// backing store stores the outgoing set along with the link.
+void BackingStoreCache::forget_atom(const Handle& h)
+{
+	AtomPtr a(h);
+	if (NULL == a) return;
+
+	NodePtr n(NodeCast(a));
+	if (n)
+	{
+		forget(node_key(n->getType(), n->getName().c_str()));
+		return;
+	}
+
+	LinkPtr l(LinkCast(a));
+	if (NULL == l) return;
+	const HandleSeq& oset = l->getOutgoingSet();
+	forget(link_key(l->getType(), oset));
+	for (const Handle& ho : oset)
+		forget_atom(ho);
+}
+
+/* ================================================================ */
+
+NodePtr BackingStoreCache::getNode(Type t, const char *name) const
+{
+	Key k(node_key(t, name));
+	AtomPtr a;
+	unsigned long gen;
+	if (lookup(k, a, gen)) return NodeCast(a);
+
+	NodePtr n(_backing->getNode(t, name));
+	insert(k, n, gen);
+	return n;
+}
+
+LinkPtr BackingStoreCache::getLink(Type t, const HandleSeq& oset) const
+{
+	Key k(link_key(t, oset));
+	AtomPtr a;
+	unsigned long gen;
+	if (lookup(k, a, gen)) return LinkCast(a);
+
+	LinkPtr l(_backing->getLink(t, oset));
+	insert(k, l, gen);
+	return l;
+}
+
+AtomPtr BackingStoreCache::getAtom(Handle h) const
+{
+	return _backing->getAtom(h);
+}
+
+HandleSeq BackingStoreCache::getIncomingSet(Handle h) const
+{
+	return _backing->getIncomingSet(h);
+}
+
+void BackingStoreCache::storeAtom(Handle h)
+{
+	{
+		std::lock_guard<std::mutex> lck(_mtx);
+		_stores++;
+	}
+	forget_atom(h);
+	_backing->storeAtom(h);
+}
+
+void BackingStoreCache::loadType(AtomTable& at, Type t)
+{
+	_backing->loadType(at, t);
+}
+
+/// Once the backing store has written everything stored before the
+/// barrier, the answers about those atoms can be cached again.
+void BackingStoreCache::barrier()
+{
+	unsigned long stores;
+	{
+		std::lock_guard<std::mutex> lck(_mtx);
+		stores = _stores;
+	}
+
+	_backing->barrier();
+
+	std::lock_guard<std::mutex> lck(_mtx);
+	if (_pending_until <= stores) _pending_until = 0;
+	for (auto it = _pending.begin(); it != _pending.end(); )
+	{
+		if (it->second <= stores) it = _pending.erase(it);
+		else it++;
+	}
+}
+
+bool BackingStoreCache::ignoreType(Type t) const
+{
+	return _backing->ignoreType(t);
+}
+
+bool BackingStoreCache::ignoreAtom(Handle h) const
+{
+	return _backing->ignoreAtom(h);
+}
+
+/* ================================================================ */
+
+void BackingStoreCache::clear(void)
+{
+	std::lock_guard<std::mutex> lck(_mtx);
+	_generation++;
+	_map.clear();
+	_lru.clear();
+	if (not _pending.empty()) hold_all();
+}
+
+void BackingStoreCache::set_capacity(size_t max_entries)
+{
+	std::lock_guard<std::mutex> lck(_mtx);
+
+	// The stores made while the cache was off were not tracked.
+	if (0 == _capacity and 0 < max_entries) hold_all();
+
+	_capacity = max_entries;
+	if (0 == _capacity)
+	{
+		_pending.clear();
+		_pending_until = 0;
+	}
+	else if (_capacity < _pending.size())
+		hold_all();
+	trim();
+}
+
+size_t BackingStoreCache::size(void) const
+{
+	std::lock_guard<std::mutex> lck(_mtx);
+	return _lru.size();
+}
+
+size_t BackingStoreCache::hits(void) const
+{
+	std::lock_guard<std::mutex> lck(_mtx);
+	return _hits;
+}
+
+size_t BackingStoreCache::negative_hits(void) const
+{
+	std::lock_guard<std::mutex> lck(_mtx);
+	return _negative_hits;
+}
+
+size_t BackingStoreCache::misses(void) const
+{
+	std::lock_guard<std::mutex> lck(_mtx);
+	return _misses;
+}
+
+size_t BackingStoreCache::evictions(void) const
+{
+	std::lock_guard<std::mutex> lck(_mtx);
+	return _evictions;
+}
+
+void BackingStoreCache::print_stats(const char *prefix) const
+{
+	std::lock_guard<std::mutex> lck(_mtx);
+	size_t lookups = _hits + _negative_hits + _misses;
+	double rate = 0.0;
+	if (0 < lookups)
+		rate = 100.0 * (_hits + _negative_hits) / lookups;
+
+	printf("%s: lookup cache holds %zu of at most %zu entries\n",
+	       prefix, _lru.size(), _capacity);
+	printf("%s: %zu lookups, %zu hits, %zu negative hits, %zu misses "
+	       "(%.1f%% hit rate), %zu evictions\n",
+	       prefix, lookups, _hits, _negative_hits, _misses, rate,
+	       _evictions);
+}
+
+/* ===================== END OF FILE ===================== */
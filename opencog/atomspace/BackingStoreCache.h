@@ -0,0 +1,164 @@
+/*
+ * opencog/atomspace/BackingStoreCache.h
+ *
+ * A lookup cache in front of a storage provider.
+ *
+ * Copyright (C) 2015 OpenCog Foundation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _OPENCOG_BACKING_STORE_CACHE_H
+#define _OPENCOG_BACKING_STORE_CACHE_H
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <opencog/atomspace/BackingStore.h>
+
+namespace opencog
+{
+/** \addtogroup grp_atomspace
+ *  @{
+ */
+
+/**
+ * Remembers the answers that the backing store gave to getNode() and
+ * getLink(), including the answer "no such atom".  The AtomSpace asks
+ * the backing store every time it fails to find an atom locally, and
+ * while ingesting new data, that is nearly every time; without the
+ * cache, each of those is a round trip to the database.
+ *
+ * The cache holds at most a fixed number of entries, and evicts the
+ * least recently used one first.  It does not keep the atoms alive; an
+ * atom that was freed is fetched again.  Storing an atom through the
+ * cache forgets what was known about it, and about its outgoing set,
+ * since those are stored along with it.  The backing store may only
+ * queue the store, and so nothing more is remembered about them until
+ * the next barrier().  Anything that changes the backing store behind
+ * the cache's back (bulk stores, other processes) must be followed by
+ * a call to clear().
+ *
+ * All other requests go straight through to the backing store.
+ */
+class BackingStoreCache : public BackingStore
+{
+	public:
+		BackingStoreCache(BackingStore *, size_t max_entries = 100000);
+		virtual ~BackingStoreCache() {}
+
+		virtual LinkPtr getLink(Type, const HandleSeq&) const;
+		virtual NodePtr getNode(Type, const char *) const;
+		virtual AtomPtr getAtom(Handle) const;
+		virtual HandleSeq getIncomingSet(Handle) const;
+		virtual void storeAtom(Handle);
+		virtual void loadType(AtomTable&, Type);
+		virtual void barrier();
+		virtual bool ignoreType(Type) const;
+		virtual bool ignoreAtom(Handle) const;
+
+		/// Forget everything.
+		void clear(void);
+
+		/// The most entries the cache will hold.  Zero turns the cache
+		/// off.
+		void set_capacity(size_t);
+
+		size_t size(void) const;
+		size_t hits(void) const;
+		size_t negative_hits(void) const;
+		size_t misses(void) const;
+		size_t evictions(void) const;
+
+		/// Print the hit rate and such, prefixing each line.
+		void print_stats(const char *) const;
+
+	private:
+		BackingStore *_backing;
+
+		// Nodes are keyed by type and name, links by type and the
+		// UUID's of the outgoing set.
+		struct Key
+		{
+			Type type;
+			std::string name;
+			std::vector<UUID> oset;
+			bool operator==(const Key& other) const
+			{
+				return type == other.type and name == other.name
+					and oset == other.oset;
+			}
+		};
+		struct KeyHash
+		{
+			size_t operator()(const Key&) const;
+		};
+		static Key node_key(Type, const char *);
+		static Key link_key(Type, const HandleSeq&);
+
+		// The atom is NULL if the backing store does not have it.  It
+		// is held weakly, so that the cache doesn't keep atoms alive
+		// that the atomspace has dropped.  The most recently used
+		// entry is at the front of the list.
+		struct Entry
+		{
+			Key key;
+			bool found;
+			std::weak_ptr<Atom> atom;
+		};
+		typedef std::list<Entry> LRUList;
+
+		mutable std::mutex _mtx;
+		mutable LRUList _lru;
+		mutable std::unordered_map<Key, LRUList::iterator, KeyHash> _map;
+		size_t _capacity;
+
+		// Bumped whenever something is forgotten, so that an answer
+		// fetched before that is not cached after it.
+		unsigned long _generation;
+
+		// The keys of atoms stored, but perhaps not yet written, with
+		// the number of the last store of each.  Until the barrier
+		// after that store, the backing store may still answer "no
+		// such atom", and so nothing is cached for them.  There are
+		// never more of them than entries in the cache; past that,
+		// nothing at all is cached until the barrier after store
+		// number _pending_until.  Zero if there is no such store.
+		std::unordered_map<Key, unsigned long, KeyHash> _pending;
+		unsigned long _pending_until;
+		unsigned long _stores;
+
+		mutable size_t _hits;
+		mutable size_t _negative_hits;
+		mutable size_t _misses;
+		mutable size_t _evictions;
+
+		bool lookup(const Key&, AtomPtr&, unsigned long&) const;
+		void insert(const Key&, const AtomPtr&, unsigned long) const;
+		void forget(const Key&);
+		void forget_atom(const Handle&);
+		void hold_all(void);
+		void trim(void) const;
+};
+
+/** @}*/
+} //namespace opencog
+
+#endif // _OPENCOG_BACKING_STORE_CACHE_H
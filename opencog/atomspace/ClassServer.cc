@@ -43,10 +43,20 @@
 
 using namespace opencog;
 
+ClassServer::TypeMatrix::TypeMatrix(size_t cap)
+    : capacity(cap), stride((cap + 63) / 64), nTypes(0),
+      bits(new std::atomic<uint64_t>[cap * ((cap + 63) / 64)])
+{
+    for (size_t i = 0; i < capacity * stride; i++)
+        bits[i].store(0, std::memory_order_relaxed);
+}
+
 ClassServer::ClassServer(void)
 {
     logger().info("Initializing ClassServer");
     nTypes = 0;
+    _isa_matrices.emplace_back(new TypeMatrix(256));
+    _isa.store(_isa_matrices.back().get());
     // autogenerated code to initialize all atom types defined in
     // atom_types.script file:
     #include "opencog/atomspace/atom_types.inheritance"
@@ -69,6 +79,10 @@ Type ClassServer::addType(const Type parent, const std::string& name)
         DPRINTF("Type \"%s\" has already been added (%d)\n", name.c_str(), type);
         inheritanceMap[parent][type] = true;
         setParentRecursively(parent, type);
+
+        // Re-publish the count, so that readers that synchronize on
+        // it also see the bits just set.
+        _isa_matrices.back()->nTypes.store(nTypes, std::memory_order_release);
         return type;
     }
 
@@ -86,13 +100,19 @@ Type ClassServer::addType(const Type parent, const std::string& name)
     std::for_each(recursiveMap.begin(), recursiveMap.end(),
           boost::bind(&std::vector<bool>::resize, _1, nTypes, false));
 
+    if (_isa.load(std::memory_order_relaxed)->capacity < nTypes)
+        growIsA();
+
     inheritanceMap[type][type]   = true;
     inheritanceMap[parent][type] = true;
-    recursiveMap[type][type]     = true;
+    setRecursive(type, type);
     setParentRecursively(parent, type);
     name2CodeMap[name]           = type;
     code2NameMap[type]           = &(name2CodeMap.find(name)->first);
 
+    // Only now may isA() look at the new type.
+    _isa_matrices.back()->nTypes.store(nTypes, std::memory_order_release);
+
     // unlock mutex before sending signal which could call
     l.unlock();
 
@@ -102,9 +122,31 @@ Type ClassServer::addType(const Type parent, const std::string& name)
     return type;
 }
 
-void ClassServer::setParentRecursively(Type parent, Type type)
+void ClassServer::setRecursive(Type parent, Type type)
 {
     recursiveMap[parent][type] = true;
+    _isa_matrices.back()->set(parent, type);
+}
+
+/// Copy the isA matrix into one twice as big, and publish that.
+/// Must be called with the type_mutex held.
+void ClassServer::growIsA(void)
+{
+    const TypeMatrix* old = _isa_matrices.back().get();
+    TypeMatrix* m = new TypeMatrix(2 * old->capacity);
+    Type n = old->nTypes.load(std::memory_order_relaxed);
+    for (Type super = 0; super < n; super++)
+        for (Type sub = 0; sub < n; sub++)
+            if (old->test(super, sub)) m->set(super, sub);
+    m->nTypes.store(n, std::memory_order_relaxed);
+
+    _isa_matrices.emplace_back(m);
+    _isa.store(m, std::memory_order_release);
+}
+
+void ClassServer::setParentRecursively(Type parent, Type type)
+{
+    setRecursive(parent, type);
     for (Type i = 0; i < nTypes; ++i) {
         if ((recursiveMap[i][parent]) && (i != parent)) {
             setParentRecursively(i, type);
@@ -23,6 +23,9 @@
 #ifndef _OPENCOG_CLASS_SERVER_H
 #define _OPENCOG_CLASS_SERVER_H
 
+#include <atomic>
+#include <cstdint>
+#include <memory>
 #include <mutex>
 #include <unordered_map>
 #include <vector>
@@ -73,7 +76,48 @@ private:
     std::unordered_map<Type, const std::string*> code2NameMap;
     TypeSignal _addTypeSignal;
 
+    /**
+     * Lock-free copy of the recursiveMap, for isA().  Row 'super' has
+     * a bit set for every type that inherits from it.  Since types are
+     * only ever appended, and bits only ever set, never cleared, the
+     * matrix can be updated in place, under the type_mutex; readers
+     * see either the old or the new bit, exactly as they would if they
+     * had taken the lock a moment earlier or later.  The count of
+     * types is published last, so a reader never looks at the bits of
+     * a half-added type.
+     *
+     * When it runs out of room, the matrix is copied into one twice
+     * as big, and the new one published, RCU-style.  The old ones are
+     * retired, not freed, since a reader might still be looking at
+     * one; because the size doubles, they add up to less than the
+     * current one.
+     */
+    struct TypeMatrix
+    {
+        TypeMatrix(size_t cap);
+        size_t capacity;
+        size_t stride;  // 64-bit words per row
+        std::atomic<Type> nTypes;
+        std::unique_ptr<std::atomic<uint64_t>[]> bits;
+
+        bool test(Type super, Type sub) const
+        {
+            uint64_t w = bits[super * stride + sub / 64]
+                .load(std::memory_order_relaxed);
+            return (w >> (sub % 64)) & 1;
+        }
+        void set(Type super, Type sub)
+        {
+            bits[super * stride + sub / 64]
+                .fetch_or(1ULL << (sub % 64), std::memory_order_relaxed);
+        }
+    };
+    std::atomic<const TypeMatrix*> _isa;
+    std::vector<std::unique_ptr<TypeMatrix>> _isa_matrices;
+
     void setParentRecursively(Type parent, Type type);
+    void setRecursive(Type parent, Type type);
+    void growIsA(void);
 
 public:
     /** Returns a new ClassServer instance */
@@ -144,15 +188,12 @@ public:
     bool isA(Type sub, Type super)
     {
         /* Because this method is called extremely often, we want
-         * the best-case fast-path for it.  Since updates are extremely
-         * unlikely after initialization, we use a multi-reader lock,
-         * and don't care at all about writer starvation, since there
-         * will almost never be writers. However, see comments above
-         * about multi-reader-locks -- we are not using them just right
-         * now, because they don't seem to actually help. */
-        std::lock_guard<std::mutex> l(type_mutex);
-        if ((sub >= nTypes) || (super >= nTypes)) return false;
-        return recursiveMap[super][sub];
+         * the best-case fast-path for it.  No lock is taken at all;
+         * see the TypeMatrix comments above for why this is safe. */
+        const TypeMatrix* m = _isa.load(std::memory_order_acquire);
+        Type n = m->nTypes.load(std::memory_order_acquire);
+        if ((sub >= n) || (super >= n)) return false;
+        return m->test(super, sub);
     }
 
     bool isA_non_recursive(Type sub, Type super);
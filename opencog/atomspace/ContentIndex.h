@@ -0,0 +1,200 @@
+/*
+ * opencog/atomspace/ContentIndex.h
+ *
+ * Copyright (C) 2015 OpenCog Foundation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _OPENCOG_CONTENT_INDEX_H
+#define _OPENCOG_CONTENT_INDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <opencog/atomspace/Handle.h>
+
+namespace opencog
+{
+/** \addtogroup grp_atomspace
+ *  @{
+ */
+
+/**
+ * An open-addressing hash table of atoms, keyed on their content
+ * (the name of a Node, or the outgoing set of a Link).  This is the
+ * common implementation of the StringIndex and the HandleSeqIndex.
+ *
+ * The table does not store a copy of the key; it stores a pointer to
+ * the atom, together with the atom's content hash (ATOM::get_hash()),
+ * sixteen bytes per slot, so that four slots fit into a cache line.
+ * Collisions are resolved by linear probing, and removal uses
+ * backward-shift deletion, so that no tombstones are ever left behind.
+ * The keys are compared only when the full hashes agree.
+ *
+ * The pointers are not owning: the AtomTable holds the atoms, and
+ * must remove them from the index before it lets go of them.
+ */
+template<class ATOM>
+class ContentIndex
+{
+	private:
+		struct Slot
+		{
+			size_t hash;
+			ATOM* atom;     // NULL if the slot is empty
+		};
+		std::vector<Slot> _slots;
+		size_t _count;
+		unsigned int _shift;   // 64 - log2(capacity)
+
+		size_t home(size_t hash) const
+		{
+			// Fibonacci hashing: take the high bits of the product,
+			// so that every bit of the hash matters.  The low bits
+			// are also used for picking the AtomTable shard, and so
+			// are the same for every atom in this index.
+			return (size_t)
+				(((uint64_t) hash * 0x9E3779B97F4A7C15ULL) >> _shift);
+		}
+
+		/// Double the capacity, and re-insert everything.  The table
+		/// is kept at most three-quarters full.
+		void grow(void)
+		{
+			std::vector<Slot> old;
+			old.swap(_slots);
+
+			size_t cap = old.empty() ? 16 : 2 * old.size();
+			_slots.resize(cap, Slot{0, NULL});
+			_shift = 64;
+			for (size_t c = cap; 1 < c; c >>= 1) _shift--;
+
+			size_t mask = cap - 1;
+			for (const Slot& s : old)
+			{
+				if (NULL == s.atom) continue;
+				size_t i = home(s.hash);
+				while (_slots[i].atom) i = (i + 1) & mask;
+				_slots[i] = s;
+			}
+		}
+
+		/// Empty slot i, and then walk down the probe run, moving back
+		/// every entry that would otherwise become unreachable.
+		void erase_slot(size_t i)
+		{
+			size_t mask = _slots.size() - 1;
+			size_t j = i;
+			while (true)
+			{
+				j = (j + 1) & mask;
+				if (NULL == _slots[j].atom) break;
+
+				// The entry at j may be moved to i only if its home
+				// slot is not cyclically in (i, j].
+				size_t k = home(_slots[j].hash);
+				bool stays = (i <= j) ? (i < k and k <= j)
+				                      : (i < k or k <= j);
+				if (stays) continue;
+
+				_slots[i] = _slots[j];
+				i = j;
+			}
+			_slots[i].hash = 0;
+			_slots[i].atom = NULL;
+			_count--;
+		}
+
+	public:
+		ContentIndex(void) : _count(0), _shift(64) {}
+
+		void insert(ATOM* a)
+		{
+			if (4 * (_count + 1) > 3 * _slots.size()) grow();
+
+			size_t hash = a->get_hash();
+			size_t mask = _slots.size() - 1;
+			size_t i = home(hash);
+			while (_slots[i].atom)
+			{
+				if (_slots[i].atom == a) return;
+				i = (i + 1) & mask;
+			}
+			_slots[i].hash = hash;
+			_slots[i].atom = a;
+			_count++;
+		}
+
+		/// Return the first atom with the given hash for which
+		/// match(atom) is true, or NULL.
+		template<class MATCH>
+		ATOM* find(size_t hash, const MATCH& match) const
+		{
+			if (0 == _count) return NULL;
+
+			size_t mask = _slots.size() - 1;
+			size_t i = home(hash);
+			while (_slots[i].atom)
+			{
+				const Slot& s = _slots[i];
+				if (s.hash == hash and match(s.atom)) return s.atom;
+				i = (i + 1) & mask;
+			}
+			return NULL;
+		}
+
+		void remove(ATOM* a)
+		{
+			if (0 == _count) return;
+
+			size_t mask = _slots.size() - 1;
+			size_t i = home(a->get_hash());
+			while (_slots[i].atom)
+			{
+				if (_slots[i].atom == a)
+				{
+					erase_slot(i);
+					return;
+				}
+				i = (i + 1) & mask;
+			}
+		}
+
+		void remove(bool (*filter)(const Handle&))
+		{
+			// Backward-shift deletion moves entries around, so
+			// collect first.
+			std::vector<ATOM*> doomed;
+			for (const Slot& s : _slots)
+				if (s.atom and filter(s.atom->getHandle()))
+					doomed.push_back(s.atom);
+
+			for (ATOM* a : doomed)
+				remove(a);
+		}
+
+		size_t size(void) const
+		{
+			return _count;
+		}
+};
+
+/** @}*/
+} //namespace opencog
+
+#endif // _OPENCOG_CONTENT_INDEX_H
@@ -27,7 +27,7 @@
 #include <climits>
 #include <opencog/atomspace/Handle.h>
 #include <opencog/atomspace/Atom.h>
-#include <opencog/atomspace/AtomTable.h>
+#include <opencog/atomspace/TLB.h>
 
 using namespace opencog;
 
@@ -46,30 +46,12 @@ Handle& Handle::operator=(const AtomPtr& a)
 // ===================================================
 // Handle resolution stuff.
 
-// Its a vector, not a set, because its priority ranked.
-std::vector<const AtomTable*> Handle::_resolver;
-
-void Handle::set_resolver(const AtomTable* tab)
-{
-    _resolver.push_back(tab);
-}
-
-void Handle::clear_resolver(const AtomTable* tab)
-{
-    auto it = std::find(_resolver.begin(), _resolver.end(), tab);
-    if (it != _resolver.end())
-        _resolver.erase(it);
-}
-
-// Search several atomspaces, in order.  First one to come up with
-// the atom wins.  Seems to work, for now.
+// The TLB knows about every atom in every atomtable, so this is a
+// single lookup, no matter how many atomspaces there are.
 inline AtomPtr Handle::do_res(const Handle* hp)
 {
-    for (const AtomTable* at : _resolver) {
-        AtomPtr a(at->getHandle((Handle&)(*hp))._ptr);
-        if (a.get()) return a;
-    }
-    return NULL;
+    if (ULONG_MAX == hp->_uuid) return NULL;
+    return TLB::getAtom(hp->_uuid);
 }
 
 Atom* Handle::resolve()
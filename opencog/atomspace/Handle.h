@@ -65,11 +65,8 @@ private:
     Atom* resolve();
     Atom* cresolve() const;
     static AtomPtr do_res(const Handle*);
-    static std::vector<const AtomTable*> _resolver;
 
     AtomPtr resolve_ptr();
-    static void set_resolver(const AtomTable*);
-    static void clear_resolver(const AtomTable*);
 
     static const AtomPtr NULL_POINTER;
 public:
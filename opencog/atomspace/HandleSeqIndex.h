@@ -22,10 +22,8 @@
 #ifndef _OPENCOG_HANDLE_SEQ_INDEX_H
 #define _OPENCOG_HANDLE_SEQ_INDEX_H
 
-#include <cstddef>
-#include <map>
-
-#include <opencog/atomspace/Handle.h>
+#include <opencog/atomspace/ContentIndex.h>
+#include <opencog/atomspace/Link.h>
 
 namespace opencog
 {
@@ -34,45 +32,24 @@ namespace opencog
  */
 
 /**
- * Implements a Handle-sequence index as an RB-tree (C++ map)
+ * Implements a Handle-sequence index as a hash table.
  * That is, given a HandleSeq, it will return a (single) Handle
  * associated with that HandleSeq.  This map is in the "opposite"
  * direction from the HandleIndex.
  *
- * @todo Notice that it this wastes a fair amount of RAM by storing a 
- * copy of a HandleSeq --- it could save a fair amount of space by storing
- * a pointer to the HandleSeq that is in the Link already (at the cost of
- * some fragility in Link deletion). Alternately, we could use a "HandleSeq 
- * cache", analogous to a string cache, to ensure only one copy of a
- * HandleSeq per system...
- * XXX FixMe! 
+ * The HandleSeq is not copied; the index points at the Link, and
+ * is keyed on Link::get_hash().  See ContentIndex for details.
  */
-class HandleSeqIndex
+class HandleSeqIndex : public ContentIndex<Link>
 {
-	private:
-		std::map<const HandleSeq, Handle, handle_seq_less> idx;
-
 	public:
-		void insert(const HandleSeq& seq, const Handle& h)
-		{
-			idx.insert(std::pair<const HandleSeq,Handle>(seq, h));
-		}
-		const Handle& get(const HandleSeq& seq) const
+		Handle get(const HandleSeq& seq, size_t hash) const
 		{
-			std::map<const HandleSeq, Handle>::const_iterator it;
-			it = idx.find(seq);
-			if (it != idx.end()) return it->second;
+			Link* l = find(hash, [&seq](const Link* l) {
+				return l->getOutgoingSet() == seq; });
+			if (l) return l->getHandle();
 			return Handle::UNDEFINED;
 		}
-		void remove(const HandleSeq& seq)
-		{
-			idx.erase(seq);
-		}
-		size_t size(void) const
-		{
-			return idx.size();
-		}
-		void remove(bool (*)(const Handle&));
 };
 
 /** @}*/
@@ -32,24 +32,36 @@
 
 using namespace opencog;
 
-//! 4092 importance bins means each bin has STI range of 32
+//! 2048 importance bins means each bin has STI range of 32
 #define IMPORTANCE_INDEX_SIZE   (1 << 11)
 
 ImportanceIndex::ImportanceIndex(void)
 {
-	resize(IMPORTANCE_INDEX_SIZE+1);
+	unsigned int bins = IMPORTANCE_INDEX_SIZE;
+	if (config().has("IMPORTANCE_INDEX_BINS"))
+		bins = config().get_int("IMPORTANCE_INDEX_BINS");
+	init(bins);
 }
 
-unsigned int ImportanceIndex::importanceBin(short importance)
+ImportanceIndex::ImportanceIndex(unsigned int bins)
 {
-	// STI is in range of [-32768, 32767] so adding 32768 puts it in
-	// [0, 65535]
-	return (importance + 32768) / IMPORTANCE_INDEX_SIZE;
+	init(bins);
 }
 
-void ImportanceIndex::updateImportance(Atom* atom, int bin)
+void ImportanceIndex::init(unsigned int bins)
 {
-	int newbin = importanceBin(atom->getAttentionValue()->getSTI());
+	// Round up to a power of two, so that binning is a shift,
+	// and clamp to one bin per STI value.
+	if (0 == bins) bins = 1;
+	_shift = 16;
+	while (_shift > 0 and (1U << (16 - _shift)) < bins) _shift--;
+	resize(1U << (16 - _shift));
+}
+
+void ImportanceIndex::updateImportance(Atom* atom, AttentionValue::sti_t oldsti)
+{
+	unsigned int bin = importanceBin(oldsti);
+	unsigned int newbin = importanceBin(atom->getAttentionValue()->getSTI());
 	if (bin == newbin) return;
 
 	remove(bin, atom);
@@ -75,51 +87,47 @@ UnorderedHandleSet ImportanceIndex::getHandleSet(
         AttentionValue::sti_t lowerBound,
         AttentionValue::sti_t upperBound) const
 {
-	UnorderedAtomSet set;
-
-	// The indexes for the lower bound and upper bound lists is returned.
-	int lowerBin = importanceBin(lowerBound);
-	int upperBin = importanceBin(upperBound);
-
-	// Build a list of atoms whose importance is equal to the lower bound.
-	// For the lower bound and upper bound index, the list is filtered,
-	// because there may be atoms that have the same importanceIndex
-	// and whose importance is lower than lowerBound or bigger than
-	// upperBound.
-	const UnorderedAtomSet &sl = idx[lowerBin];
-	std::copy_if(sl.begin(), sl.end(), inserter(set),
-		[&](Atom* atom)->bool {
-			AttentionValue::sti_t sti =
-				atom->getAttentionValue()->getSTI();
-			return (lowerBound <= sti and sti <= upperBound);
-		});
+	UnorderedHandleSet ret;
+	foreachInRange([&](Atom* atom)->void {
+			ret.insert(atom->getHandle());
+		}, lowerBound, upperBound);
+	return ret;
+}
 
-	// If both lower and upper bounds are in the same bin,
-	// Then we are done.
-	if (lowerBin == upperBin) {
-		UnorderedHandleSet ret;
-		std::transform(set.begin(), set.end(), inserter(ret),
-		               [](Atom* atom)->Handle { return atom->getHandle(); });
-		return ret;
-	}
+size_t ImportanceIndex::estimateSize(AttentionValue::sti_t lowerBound,
+                                     AttentionValue::sti_t upperBound) const
+{
+	if (upperBound < lowerBound) return 0;
+	size_t cnt = 0;
+	unsigned int upperBin = importanceBin(upperBound);
+	for (unsigned int bin = importanceBin(lowerBound); bin <= upperBin; bin++)
+		cnt += idx[bin].size();
+	return cnt;
+}
 
-	// For every index within lowerBound and upperBound,
-	// add to the list.
-	while (++lowerBin < upperBin) {
-		const UnorderedAtomSet &ss = idx[lowerBin];
-		set.insert(ss.begin(), ss.end());
+HandleSeq ImportanceIndex::getTopSTI(size_t k) const
+{
+	// Take whole bins, from the top down, until there are at least
+	// k atoms.  Every atom in a higher bin outranks every atom in a
+	// lower one, so only the last bin taken needs to be cut.
+	typedef std::pair<AttentionValue::sti_t, Atom*> Ranked;
+	std::vector<Ranked> ranked;
+	for (size_t bin = idx.size(); 0 < bin and ranked.size() < k; )
+	{
+		const UnorderedAtomSet& s = idx[--bin];
+		for (Atom* atom : s)
+			ranked.push_back(Ranked(atom->getSTI(), atom));
 	}
 
-	// The two lists are concatenated.
-	const UnorderedAtomSet &uset = idx[upperBin];
-	std::copy_if(uset.begin(), uset.end(), inserter(set),
-		[&](Atom* atom)->bool {
-			AttentionValue::sti_t sti = atom->getAttentionValue()->getSTI();
-			return (lowerBound <= sti and sti <= upperBound);
+	size_t n = std::min(k, ranked.size());
+	std::partial_sort(ranked.begin(), ranked.begin() + n, ranked.end(),
+		[](const Ranked& a, const Ranked& b)->bool {
+			return a.first > b.first;
 		});
 
-	UnorderedHandleSet ret;
-	std::transform(set.begin(), set.end(), inserter(ret),
-	               [](Atom* atom)->Handle { return atom->getHandle(); });
+	HandleSeq ret;
+	ret.reserve(n);
+	for (size_t i = 0; i < n; i++)
+		ret.push_back(ranked[i].second->getHandle());
 	return ret;
 }
@@ -38,11 +38,23 @@ class AtomTable;
  * Implements an index with additional routines needed for managing 
  * short-term importance.  This index is not thread-safe, by itself.
  * Users of this class must gauarantee single-threaded access!
+ *
+ * The STI range [-32768, 32767] is cut into a power-of-two number of
+ * equal-width bins; by default, 2048 bins of width 32.  The number of
+ * bins can be changed with the IMPORTANCE_INDEX_BINS config parameter.
+ * Atoms within one bin are not ordered; range queries only have to
+ * look at the STI of the atoms in the two end bins.
  */
 class ImportanceIndex: public FixedIntegerIndex
 {
+private:
+    unsigned int _shift;   // log2 of the bin width
+
+    void init(unsigned int);
+
 public:
     ImportanceIndex(void);
+    ImportanceIndex(unsigned int bins);
     void insertAtom(Atom*);
     void removeAtom(Atom*);
 
@@ -51,14 +63,63 @@ public:
      * bins.
      *
      * @param The atom whose importance index will be updated.
-     * @param The old importance bin where the atom originally was.
+     * @param The old STI of the atom, which fixes the bin that it is in.
      */
-    void updateImportance(Atom*, int);
-    
+    void updateImportance(Atom*, AttentionValue::sti_t);
+
     UnorderedHandleSet getHandleSet(const AtomTable*,
                               AttentionValue::sti_t,
                               AttentionValue::sti_t) const;
 
+    /**
+     * Call func(Atom*) on each atom whose STI is within the given
+     * (inclusive) range, without building any intermediate set.
+     * Only the atoms in the two end bins have their STI checked.
+     */
+    template <typename Function> void
+    foreachInRange(Function func,
+                   AttentionValue::sti_t lowerBound,
+                   AttentionValue::sti_t upperBound) const
+    {
+        if (upperBound < lowerBound) return;
+        unsigned int lowerBin = importanceBin(lowerBound);
+        unsigned int upperBin = importanceBin(upperBound);
+        for (unsigned int bin = lowerBin; bin <= upperBin; bin++)
+        {
+            const UnorderedAtomSet& s = idx[bin];
+            if (s.empty()) continue;
+            if (bin == lowerBin or bin == upperBin)
+            {
+                for (Atom* atom : s)
+                {
+                    AttentionValue::sti_t sti = atom->getSTI();
+                    if (lowerBound <= sti and sti <= upperBound)
+                        func(atom);
+                }
+            }
+            else
+            {
+                for (Atom* atom : s)
+                    func(atom);
+            }
+        }
+    }
+
+    /**
+     * Return an upper bound on the number of atoms within the given
+     * importance range: the end bins are counted in full.  This is
+     * proportional to the number of bins, not to the number of atoms.
+     */
+    size_t estimateSize(AttentionValue::sti_t,
+                        AttentionValue::sti_t) const;
+
+    /**
+     * Return the k atoms of highest STI, highest first.  Only the
+     * bins down to the one holding the k'th atom are visited; ties
+     * are broken arbitrarily.
+     */
+    HandleSeq getTopSTI(size_t k) const;
+
     /**
      * This method returns which importance bin an atom with the given
      * importance should be placed.
@@ -67,7 +128,15 @@ public:
      * @return The importance bin which an atom of the given importance
      * should be placed.
      */
-    static unsigned int importanceBin(short);
+    unsigned int importanceBin(AttentionValue::sti_t importance) const
+    {
+        // STI is in range of [-32768, 32767] so adding 32768 puts it in
+        // [0, 65535]
+        return ((unsigned int) (importance + 32768)) >> _shift;
+    }
+
+    /// The number of importance bins.
+    unsigned int getNumBins(void) const { return idx.size(); }
 };
 
 /** @}*/
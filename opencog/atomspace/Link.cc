@@ -46,6 +46,23 @@ struct HandleComparison
 void Link::resort(void)
 {
     std::sort(_outgoing.begin(), _outgoing.end(), HandleComparison());
+    _content_hash = 0;
+}
+
+size_t Link::compute_hash(Type t, const HandleSeq& seq)
+{
+    // Boost-style hash_combine, followed by a 64-bit finalizer, so
+    // that the low bits (used to pick the AtomTable shard) and the
+    // high bits (used by the HandleSeqIndex) are both well-mixed.
+    uint64_t h = t;
+    for (const Handle& ho : seq)
+        h ^= ho.value() + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return (0 == h) ? 1 : (size_t) h;
 }
 
 void Link::init(const std::vector<Handle>& outgoingVector)
@@ -58,6 +75,7 @@ void Link::init(const std::vector<Handle>& outgoingVector)
     }
 
     _outgoing = outgoingVector;
+    _content_hash = 0;
     // If the link is unordered, it will be normalized by sorting the
     // elements in the outgoing list.
     if (classserver().isA(_type, UNORDERED_LINK)) {
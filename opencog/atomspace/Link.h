@@ -24,6 +24,7 @@
 #ifndef _OPENCOG_LINK_H
 #define _OPENCOG_LINK_H
 
+#include <atomic>
 #include <string>
 
 #include <opencog/util/oc_assert.h>
@@ -64,6 +65,9 @@ protected:
     //! Should not change during atom lifespan.
     HandleSeq _outgoing;
 
+    //! Cached value of get_hash(); zero if not yet computed.
+    mutable std::atomic<size_t> _content_hash;
+
 public:
     /**
      * Constructor for this class.
@@ -175,6 +179,30 @@ public:
         }
     }
 
+    /**
+     * Returns a hash of the link type and the UUIDs in the outgoing
+     * set; used by the AtomTable to find equivalent links.  It is
+     * computed on first use, and then cached.  The UUIDs of a link
+     * that is not yet in an atomtable may still change, so the
+     * AtomTable resets the cache when it fixes up the outgoing set;
+     * once the link is in a table, the hash never changes.
+     */
+    size_t get_hash() const
+    {
+        size_t h = _content_hash.load(std::memory_order_relaxed);
+        if (0 == h) {
+            h = compute_hash(getType(), _outgoing);
+            _content_hash.store(h, std::memory_order_relaxed);
+        }
+        return h;
+    }
+
+    /**
+     * The hash that get_hash() would return for a link of the given
+     * type and outgoing set.  Never zero.
+     */
+    static size_t compute_hash(Type, const HandleSeq&);
+
     //! Invoke the callback on each atom in the outgoing set of
     //! handle h, until till one of them returns true, in which case,
     //! the loop stops and returns true. Otherwise the callback is
@@ -31,7 +31,6 @@ using namespace opencog;
 
 LinkIndex::LinkIndex(void)
 {
-	resize();
 }
 
 void LinkIndex::resize()
@@ -42,43 +41,50 @@ void LinkIndex::resize()
 size_t LinkIndex::size() const
 {
 	size_t cnt = 0;
-	for (HandleSeqIndex hsi: idx) cnt += hsi.size();
+	for (const HandleSeqIndex& hsi: idx) cnt += hsi.size();
 	return cnt;
 }
 
 void LinkIndex::insertAtom(const AtomPtr& a)
 {
-	Type t = a->getType();
-	HandleSeqIndex &hsi = idx[t];
-
 	LinkPtr l(LinkCast(a));
 	if (NULL == l) return;
 
-	hsi.insert(l->getOutgoingSet(), a->getHandle());
+	Type t = a->getType();
+	if (idx.size() <= t) resize();
+	HandleSeqIndex &hsi = idx[t];
+
+	hsi.insert(l.get());
 }
 
 void LinkIndex::removeAtom(const AtomPtr& a)
 {
-	Type t = a->getType();
-	HandleSeqIndex &hsi = idx[t];
-
 	LinkPtr l(LinkCast(a));
 	if (NULL == l) return;
 
-	hsi.remove(l->getOutgoingSet());
+	Type t = a->getType();
+	if (idx.size() <= t) return;
+	HandleSeqIndex &hsi = idx[t];
+
+	hsi.remove(l.get());
 }
 
 Handle LinkIndex::getHandle(Type t, const HandleSeq &seq) const
 {
-	if (t >= idx.size()) throw RuntimeException(TRACE_INFO,
-	            "Index out of bounds for atom type (t = %lu)", t);
+	return getHandle(t, seq, Link::compute_hash(t, seq));
+}
+
+Handle LinkIndex::getHandle(Type t, const HandleSeq &seq, size_t hash) const
+{
+	// The index is sized lazily; types never inserted are not there.
+	if (t >= idx.size()) return Handle::UNDEFINED;
 	const HandleSeqIndex &hsi = idx[t];
-	return hsi.get(seq);
+	return hsi.get(seq, hash);
 }
 
 void LinkIndex::remove(bool (*filter)(const Handle&))
 {
-	for (HandleSeqIndex s : idx)
+	for (HandleSeqIndex& s : idx)
 		s.remove(filter);
 }
 
@@ -87,16 +93,15 @@ UnorderedHandleSet LinkIndex::getHandleSet(Type type, const HandleSeq& seq, bool
 	UnorderedHandleSet hs;
 	if (subclass)
 	{
-		Type max = classserver().getNumberOfClasses();
+		Type max = idx.size();
 		for (Type s = 0; s < max; s++)
 		{
 			// The 'AssignableFrom' direction is unit-tested in AtomSpaceUTest.cxxtest
 			if (classserver().isA(s, type))
 			{
-				if (s >= idx.size()) throw RuntimeException(TRACE_INFO,
-				           "Index out of bounds for atom type (s = %lu)", s);
+				// The hash covers the type, so it differs per subtype.
 				const HandleSeqIndex &hsi = idx[s];
-				Handle h = hsi.get(seq);
+				Handle h = hsi.get(seq, Link::compute_hash(s, seq));
 				if (Handle::UNDEFINED != h)
 					hs.insert(h);
 			}
@@ -35,10 +35,16 @@ namespace opencog
  */
 
 /**
- * Implements an (type, HandleSeq) index array of RB-trees (C++ set)
+ * Implements an (type, HandleSeq) index array of hash tables.
  * That is, given both a type, and a HandleSeq, it returns a single,
  * unique Handle associated with that pair.  In other words, it returns
  * the single, unique Link which is that pair.
+ *
+ * The lookups hash the type and the outgoing UUIDs (see
+ * Link::compute_hash()); callers that already have the hash can pass
+ * it in, to avoid computing it twice.
+ *
+ * As with the NodeIndex, the per-type array is sized lazily.
  */
 class LinkIndex
 {
@@ -53,6 +59,7 @@ class LinkIndex
         size_t size() const;
 
         Handle getHandle(Type type, const HandleSeq&) const;
+        Handle getHandle(Type type, const HandleSeq&, size_t hash) const;
         UnorderedHandleSet getHandleSet(Type type, const HandleSeq&, bool subclass) const;
 };
 
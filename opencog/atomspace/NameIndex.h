@@ -31,7 +31,7 @@ namespace opencog
 {
 
 /**
- * Implements an atom name index as an RB-tree (C++ map)
+ * Implements an atom name index as a hash table.
  * That is, given an atom name, this returns an AtomPtr to that atom.
  * This class can only hold *one* AtomPtr for a given name. For a
  * multi-name storage, use the NodeIndex, which keys by name and
@@ -45,13 +45,13 @@ class NameIndex:
 		{
 			Node * n = dynamic_cast<Node*>(a);
 			if (NULL == n) return;
-			insert(n->getName(), a);
+			insert(n);
 		}
 		void removeAtom(Atom* a)
 		{
 			Node * n = dynamic_cast<Node*>(a);
 			if (NULL == n) return;
-			remove(n->getName());
+			remove(n);
 		}
 };
 
@@ -40,6 +40,24 @@ void Node::init(const std::string& cname)
             _type, classserver().getTypeName(_type).c_str());
     }
     _name = cname;
+    _content_hash = 0;
+}
+
+size_t Node::compute_hash(Type t, const boost::string_ref& name)
+{
+    // FNV-1a over the name, seeded with the type, followed by a 64-bit
+    // finalizer; see also Link::compute_hash().
+    uint64_t h = 0xcbf29ce484222325ULL ^ t;
+    for (char c : name) {
+        h ^= (unsigned char) c;
+        h *= 0x100000001b3ULL;
+    }
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return (0 == h) ? 1 : (size_t) h;
 }
 
 std::string Node::toShortString(std::string indent)
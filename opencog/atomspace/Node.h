@@ -26,6 +26,10 @@
 #ifndef _OPENCOG_NODE_H
 #define _OPENCOG_NODE_H
 
+#include <atomic>
+
+#include <boost/utility/string_ref.hpp>
+
 #include <opencog/util/oc_assert.h>
 #include <opencog/atomspace/Atom.h>
 
@@ -46,6 +50,9 @@ protected:
     std::string _name;
     void init(const std::string&);
 
+    //! Cached value of get_hash(); zero if not yet computed.
+    mutable std::atomic<size_t> _content_hash;
+
     Node(const Node &l) : Atom(0)
     { OC_ASSERT(false, "Node: bad use of copy ctor"); }
 
@@ -86,6 +93,27 @@ public:
      */
     inline const std::string& getName() const { return _name; }
 
+    /**
+     * Returns a hash of the node type and name; used by the AtomTable
+     * to find equivalent nodes.  It is computed on first use, and then
+     * cached.
+     */
+    size_t get_hash() const
+    {
+        size_t h = _content_hash.load(std::memory_order_relaxed);
+        if (0 == h) {
+            h = compute_hash(getType(), _name);
+            _content_hash.store(h, std::memory_order_relaxed);
+        }
+        return h;
+    }
+
+    /**
+     * The hash that get_hash() would return for a node of the given
+     * type and name.  Never zero.
+     */
+    static size_t compute_hash(Type, const boost::string_ref&);
+
     /**
      * Returns a string representation of the node.
      *
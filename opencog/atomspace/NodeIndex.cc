@@ -28,7 +28,6 @@ using namespace opencog;
 
 NodeIndex::NodeIndex()
 {
-	resize();
 }
 
 void NodeIndex::resize()
@@ -25,6 +25,8 @@
 #include <set>
 #include <vector>
 
+#include <boost/utility/string_ref.hpp>
+
 #include <opencog/atomspace/NameIndex.h>
 #include <opencog/atomspace/types.h>
 
@@ -35,9 +37,18 @@ namespace opencog
  */
 
 /**
- * Implements an (type, name) index array of RB-trees (C++ set)
+ * Implements an (type, name) index array of hash tables.
  * That is, given only the type and name of an atom, this will
  * return the corresponding handle of that atom.
+ *
+ * The index holds no copies of the names; see StringIndex.  The
+ * lookups hash the type and the name (see Node::compute_hash());
+ * callers that already have the hash can pass it in, to avoid
+ * computing it twice.
+ *
+ * The per-type array is sized lazily, on first insertion. The
+ * AtomTable keeps many of these (one per shard), and most shards
+ * only ever see a handful of types.
  */
 class NodeIndex
 {
@@ -49,21 +60,31 @@ class NodeIndex
 
 		void insertAtom(Atom* a)
 		{
-			NameIndex &ni(idx[a->getType()]);
+			Type t = a->getType();
+			if (idx.size() <= t) resize();
+			NameIndex &ni(idx[t]);
 			ni.insertAtom(a);
 		}
 		void removeAtom(Atom* a)
 		{
-			NameIndex &ni(idx.at(a->getType()));
+			Type t = a->getType();
+			if (idx.size() <= t) return;
+			NameIndex &ni(idx[t]);
 			ni.removeAtom(a);
 		}
 		void resize();
 		size_t size() const;
 
-		Atom* getAtom(Type type, const std::string& str) const
+		Atom* getAtom(Type type, const boost::string_ref& str,
+		              size_t hash) const
+		{
+			if (idx.size() <= type) return NULL;
+			const NameIndex &ni(idx[type]);
+			return ni.get(str, hash);
+		}
+		Atom* getAtom(Type type, const boost::string_ref& str) const
 		{
-			const NameIndex &ni(idx.at(type));
-			return ni.get(str);
+			return getAtom(type, str, Node::compute_hash(type, str));
 		}
 
 		UnorderedHandleSet getHandleSet(Type type, const std::string&, bool subclass) const;
@@ -72,6 +93,8 @@ class NodeIndex
 		getHandleSet(OutputIterator result,
 		             Type type, const std::string& name, bool subclass) const
 		{
+			// The hash covers the type, so it differs per subtype;
+			// getAtom(Type, name) recomputes it for each.
 			if (not subclass)
 			{
 				Atom* atom = getAtom(type, name);
@@ -22,10 +22,10 @@
 #ifndef _OPENCOG_STRINGINDEX_H
 #define _OPENCOG_STRINGINDEX_H
 
-#include <cstddef>
-#include <map>
+#include <boost/utility/string_ref.hpp>
 
-#include <opencog/atomspace/Handle.h>
+#include <opencog/atomspace/ContentIndex.h>
+#include <opencog/atomspace/Node.h>
 
 namespace opencog
 {
@@ -36,31 +36,18 @@ namespace opencog
 /**
  * Implements map from string to atom pointers. Used to implement
  * the lookup of atoms according to thier name.
+ *
+ * The names are not copied; the index points at the Node, which
+ * holds the only copy of its name, and is keyed on Node::get_hash().
+ * See ContentIndex for details.
  */
-class StringIndex
+class StringIndex : public ContentIndex<Node>
 {
-	private:
-		std::map<std::string, Atom*> idx;
-
 	public:
-		void insert(const std::string& str, Atom* a)
-		{
-			idx.insert(std::pair<std::string, Atom*>(str, a));
-		}
-		Atom* get(const std::string& str) const
-		{
-			std::map<std::string, Atom*>::const_iterator it;
-			it = idx.find(str);
-			if (it != idx.end()) return it->second;
-			return NULL;
-		}
-		void remove(const std::string& str)
-		{
-			idx.erase(str);
-		}
-		size_t size(void) const
+		Node* get(const boost::string_ref& str, size_t hash) const
 		{
-			return idx.size();
+			return find(hash, [&str](const Node* n) {
+				return str == n->getName(); });
 		}
 };
 
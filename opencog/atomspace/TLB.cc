@@ -25,3 +25,124 @@
 using namespace opencog;
 
 std::atomic<UUID> TLB::_brk_uuid(1);
+
+std::atomic<TLB::Mid*> TLB::_top[1 << TOP_BITS];
+std::atomic<size_t> TLB::_leaves(0);
+std::mutex TLB::_overflow_mtx;
+std::unordered_map<UUID, TLB::AtomRef> TLB::_overflow;
+
+/// True if the reference was never set, as opposed to set to an atom
+/// that has since gone away.
+static bool is_unset(const std::weak_ptr<Atom>& ref)
+{
+    std::weak_ptr<Atom> none;
+    return not ref.owner_before(none) and not none.owner_before(ref);
+}
+
+/// True if the reference is to this very atom.
+static bool refers_to(const std::weak_ptr<Atom>& ref, const AtomPtr& atom)
+{
+    return not ref.owner_before(atom) and not atom.owner_before(ref);
+}
+
+TLB::LeafPtr* TLB::page(UUID uuid, bool create)
+{
+    if (uuid >> RADIX_BITS) return NULL;
+
+    std::atomic<Mid*>& top(_top[uuid >> (MID_BITS + LEAF_BITS)]);
+    Mid* mid = top.load(std::memory_order_acquire);
+    if (NULL == mid) {
+        if (not create) return NULL;
+
+        // Install a fresh page, unless some other thread beat us to it.
+        Mid* fresh = new Mid();
+        if (top.compare_exchange_strong(mid, fresh,
+                                        std::memory_order_acq_rel))
+            mid = fresh;
+        else
+            delete fresh;
+    }
+    return &mid->leaf[(uuid >> LEAF_BITS) & ((1 << MID_BITS) - 1)];
+}
+
+TLB::LeafPtr TLB::leaf(LeafPtr* pg, bool create)
+{
+    LeafPtr lf(std::atomic_load(pg));
+    if (not create or (lf and not lf->detached)) return lf;
+
+    LeafPtr fresh(std::make_shared<Leaf>());
+    LeafPtr expected(lf);
+    if (std::atomic_compare_exchange_strong(pg, &expected, fresh)) {
+        if (NULL == lf) _leaves++;
+        return fresh;
+    }
+    return expected;
+}
+
+void TLB::enter(const AtomPtr& atom)
+{
+    UUID uuid = atom->_uuid;
+    LeafPtr* pg = page(uuid, true);
+    if (NULL == pg) {
+        std::lock_guard<std::mutex> lck(_overflow_mtx);
+        _overflow[uuid] = atom;
+        return;
+    }
+
+    // Retry if the leaf was unhooked between the load and the lock.
+    while (true) {
+        LeafPtr lf(leaf(pg, true));
+        std::lock_guard<std::mutex> lck(lf->mtx);
+        if (lf->detached) continue;
+
+        AtomRef& ref(lf->slot[uuid & ((1 << LEAF_BITS) - 1)]);
+        if (is_unset(ref)) lf->used++;
+        ref = atom;
+        return;
+    }
+}
+
+void TLB::remove(const AtomPtr& atom)
+{
+    UUID uuid = atom->_uuid;
+    LeafPtr* pg = page(uuid, false);
+    if (NULL == pg) {
+        if (0 == (uuid >> RADIX_BITS)) return;
+        std::lock_guard<std::mutex> lck(_overflow_mtx);
+        auto it = _overflow.find(uuid);
+        if (it != _overflow.end() and refers_to(it->second, atom))
+            _overflow.erase(it);
+        return;
+    }
+
+    LeafPtr lf(leaf(pg, false));
+    if (NULL == lf) return;
+    std::lock_guard<std::mutex> lck(lf->mtx);
+    AtomRef& ref(lf->slot[uuid & ((1 << LEAF_BITS) - 1)]);
+    if (not refers_to(ref, atom)) return;
+    ref.reset();
+    if (0 < --lf->used) return;
+
+    // That was the last one; unhook the leaf.  Readers that already
+    // hold it keep it alive until they are done with it.
+    lf->detached = true;
+    LeafPtr expected(lf);
+    if (std::atomic_compare_exchange_strong(pg, &expected, LeafPtr()))
+        _leaves--;
+}
+
+AtomPtr TLB::getAtom(UUID uuid)
+{
+    if (0 == (uuid >> RADIX_BITS)) {
+        LeafPtr* pg = page(uuid, false);
+        if (NULL == pg) return AtomPtr();
+        LeafPtr lf(leaf(pg, false));
+        if (NULL == lf) return AtomPtr();
+        std::lock_guard<std::mutex> lck(lf->mtx);
+        return lf->slot[uuid & ((1 << LEAF_BITS) - 1)].lock();
+    }
+    std::lock_guard<std::mutex> lck(_overflow_mtx);
+    auto it = _overflow.find(uuid);
+    if (it != _overflow.end()) return it->second.lock();
+    return AtomPtr();
+}
@@ -26,6 +26,9 @@
 #define _OPENCOG_TLB_H
 
 #include <atomic>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
 
 #include <opencog/util/Logger.h>
 #include <opencog/atomspace/Atom.h>
@@ -56,12 +59,31 @@ class AtomTable;
  * (currently) there is no way to free them.  Use reserve_range()
  * and reserve_extent() to malloc them.
  *
+ * The TLB also translates UUID's back into atoms, for every atom that
+ * is in some AtomTable; this is how a Handle that holds only a UUID
+ * gets resolved.  The table is a three-level radix tree indexed by
+ * the bits of the UUID, so a lookup costs the same however many
+ * atomspaces there are.  It is not lock-free: the leaf pages are
+ * reached through std::atomic_load() on a shared_ptr, which libstdc++
+ * implements with a small pool of mutexes hashed by address, and the
+ * slot itself is read under a per-page mutex.  Neither lock is held
+ * for more than a few instructions, and no lock is shared by all
+ * lookups.
+ *
+ * The table holds weak references; it is the AtomTable that keeps the
+ * atom alive, and an atom that is gone resolves to null even if it
+ * was never removed.  A leaf page is freed once the last atom in it
+ * is removed; the middle pages are small, and are kept.  UUID's too
+ * large for the radix tree (more than 2^32) go into a mutex-protected
+ * map instead.
+ *
  * Everything in this class is private, mostly because we don't want
  * anyone to mess with it, except our closest friends.
  */
 class TLB
 {
     friend class Atom;
+    friend class Handle;
     friend class AtomSpaceBenchmark;
     friend class AtomStorage;
     friend class AtomTable;
@@ -78,6 +100,55 @@ private:
     // Thread-safe atomic
     static std::atomic<UUID> _brk_uuid;
 
+    // The translation table.  The leaf pointers are accessed only
+    // through std::atomic_load() and friends; the slots only under
+    // the leaf's mutex.  A leaf is marked detached, under its mutex,
+    // just before it is unhooked; whoever finds a detached leaf
+    // replaces it with a fresh one.
+    static const int LEAF_BITS = 12;
+    static const int MID_BITS = 10;
+    static const int TOP_BITS = 10;
+    static const int RADIX_BITS = LEAF_BITS + MID_BITS + TOP_BITS;
+    typedef std::weak_ptr<Atom> AtomRef;
+    struct Leaf
+    {
+        std::mutex mtx;
+        size_t used = 0;
+        std::atomic<bool> detached{false};
+        AtomRef slot[1 << LEAF_BITS];
+    };
+    typedef std::shared_ptr<Leaf> LeafPtr;
+    struct Mid { LeafPtr leaf[1 << MID_BITS]; };
+    static std::atomic<Mid*> _top[1 << TOP_BITS];
+    static std::atomic<size_t> _leaves;
+
+    static std::mutex _overflow_mtx;
+    static std::unordered_map<UUID, AtomRef> _overflow;
+
+    /// Return the place in the middle page that points at the leaf
+    /// holding the UUID, or NULL if there is none yet (or if the UUID
+    /// is beyond the radix tree).  If create is set, a missing middle
+    /// page is allocated.
+    static LeafPtr* page(UUID, bool create);
+
+    /// Return the leaf; if create is set, a missing or detached leaf
+    /// is replaced by a fresh one.
+    static LeafPtr leaf(LeafPtr*, bool create);
+
+    /// The number of leaf pages in use.
+    static size_t num_leaves(void) { return _leaves; }
+
+    /// Make the atom findable by its UUID.
+    static void enter(const AtomPtr&);
+
+    /// Forget the atom; nothing happens if its UUID has since been
+    /// taken over by some other atom.
+    static void remove(const AtomPtr&);
+
+    /// Return the atom with the given UUID, or null if it is not in
+    /// any AtomTable.
+    static AtomPtr getAtom(UUID);
+
     /** Adds a new atom to the TLB.
      * If the atom has already be added then an exception is thrown.
      *
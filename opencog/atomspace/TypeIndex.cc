@@ -19,6 +19,8 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
  */
 
+#include <algorithm>
+
 #include "TypeIndex.h"
 #include "Atom.h"
 #include "ClassServer.h"
@@ -26,6 +28,7 @@
 using namespace opencog;
 
 TypeIndex::TypeIndex(void)
+	: count(0)
 {
 	resize();
 }
@@ -33,133 +36,103 @@ TypeIndex::TypeIndex(void)
 void TypeIndex::resize(void)
 {
 	num_types = classserver().getNumberOfClasses();
-	FixedIntegerIndex::resize(num_types + 1);
-}
-
-size_t TypeIndex::getNumAtomsOfType(Type type, bool count_subclasses) const
-{
-    iterator it(type, count_subclasses);
-    size_t atom_count = 0;
-    it.s = idx.begin();
-    it.send = idx.end();
-
-    // Loop over all the types looking for type and optional subclasses.
-    Type current_type = 0;
-    while (it.s != it.send)
-    {
-        // If this type is a match...
-        if ((type == current_type) || 
-            (count_subclasses && (classserver().isA(type, it.type))))
-        {
-            // Add the size of the atom set for this type.
-            atom_count += idx.at(current_type).size();
-        }
-        current_type++;
-        ++it.s;
-    }
-
-    return atom_count;
+	idx.resize(num_types + 1);
 }
 
-// ================================================================
-
-TypeIndex::iterator TypeIndex::begin(Type t, bool sub) const
+void TypeIndex::insertAtom(Atom* a)
 {
-	iterator it(t, sub);
-	it.send = idx.end();
+	Bucket& b(idx.at(a->getType()));
+	UUID u = a->_uuid;
 
-	it.s = idx.begin();
-	it.currtype = 0;
-	while (it.s != it.send)
+	// Atoms almost always arrive in UUID order.
+	if (b.atoms.empty() or b.atoms.back().uuid < u)
 	{
-		// Find the first type which is a subtype, and start iteration there.
-		if ((it.type == it.currtype) || 
-		    (sub && (classserver().isA(it.currtype, it.type))))
-		{
-			it.se = it.s->begin();
-			if (it.se != it.s->end()) return it;
-		}
-		it.currtype++;
-		++it.s;
+		b.atoms.push_back(Entry{u, a});
+		count++;
+		return;
 	}
 
-	return it;
-}
-
-TypeIndex::iterator TypeIndex::end(void) const
-{
-	iterator it(num_types, false);
-	it.se = idx.at(num_types).end();
-	it.s = idx.end();
-	it.send = idx.end();
-	it.currtype = num_types;
-	return it;
-}
-
-TypeIndex::iterator::iterator(Type t, bool sub)
-{
-	type = t;
-	subclass = sub;
-}
-
-TypeIndex::iterator& TypeIndex::iterator::operator=(iterator v)
-{
-	s = v.s;
-	send = v.send;
-	se = v.se;
-	currtype = v.currtype;
-	type = v.type;
-	subclass = v.subclass;
-	return *this;
+	auto it = std::lower_bound(b.atoms.begin(), b.atoms.end(), u, before);
+	if (it != b.atoms.end() and it->uuid == u)
+	{
+		if (it->atom) return;
+		// Re-use the hole left by an earlier atom with this UUID.
+		it->atom = a;
+		b.dead--;
+		count++;
+		return;
+	}
+	b.atoms.insert(it, Entry{u, a});
+	count++;
 }
 
-Handle TypeIndex::iterator::operator*(void)
+void TypeIndex::removeAtom(Atom* a)
 {
-	if (s == send) return Handle::UNDEFINED;
-	return (*se)->getHandle();
+	Bucket& b(idx.at(a->getType()));
+	auto it = std::lower_bound(b.atoms.begin(), b.atoms.end(),
+	                           a->_uuid, before);
+	if (it == b.atoms.end() or it->atom != a) return;
+
+	it->atom = NULL;
+	b.dead++;
+	count--;
+	if (b.atoms.size() < 4 * b.dead) compact(b);
 }
 
-bool TypeIndex::iterator::operator==(iterator v)
+void TypeIndex::compact(Bucket& b)
 {
-	if ((v.s == v.send) && (s == send)) return true;
-	return v.se == se;
+	b.atoms.erase(std::remove_if(b.atoms.begin(), b.atoms.end(),
+	                  [](const Entry& e) { return NULL == e.atom; }),
+	              b.atoms.end());
+	b.dead = 0;
+	if (b.atoms.capacity() > 2 * b.atoms.size())
+		b.atoms.shrink_to_fit();
 }
 
-bool TypeIndex::iterator::operator!=(iterator v)
+size_t TypeIndex::getNumAtomsOfType(Type type, bool subclass) const
 {
-	if ((v.s == v.send) && (s != send)) return v.se != se;
-	if ((v.s != v.send) && (s == send)) return v.se != se;
-	return false;
+	size_t atom_count = 0;
+	for (Type t = 0; t < idx.size(); t++)
+	{
+		if (t == type or (subclass and classserver().isA(t, type)))
+			atom_count += idx[t].atoms.size() - idx[t].dead;
+	}
+	return atom_count;
 }
 
-TypeIndex::iterator& TypeIndex::iterator::operator++()
-{
-	return operator++(1);
-}
+// ================================================================
 
-TypeIndex::iterator& TypeIndex::iterator::operator++(int i)
+bool TypeIndex::fetch(Type type, bool subclass, UUID upto,
+                      Position& pos, HandleSeq& chunk, size_t n) const
 {
-	if (s == send) return *this;
+	if (not subclass and pos.type < type)
+	{
+		pos.type = type;
+		pos.uuid = 0;
+	}
 
-	++se;
-	if (se == s->end())
+	for (; pos.type < idx.size(); pos.type++, pos.uuid = 0)
 	{
-		do
+		if (not subclass and pos.type != type) break;
+		if (pos.type != type and not classserver().isA(pos.type, type))
+			continue;
+
+		const std::vector<Entry>& atoms = idx[pos.type].atoms;
+		auto it = std::lower_bound(atoms.begin(), atoms.end(),
+		                           pos.uuid, before);
+		for (; it != atoms.end() and it->uuid < upto; ++it)
 		{
-			++s;
-			currtype++;
-
-			// Find the first type which is a subtype, and start iteration there.
-			if ((type == currtype) || 
-			    (subclass && (classserver().isA(currtype, type))))
+			if (NULL == it->atom) continue;
+			if (0 == n)
 			{
-				se = s->begin();
-				if (se != s->end()) return *this;
+				pos.uuid = it->uuid;
+				return true;
 			}
-		} while (s != send);
+			chunk.push_back(it->atom->getHandle());
+			n--;
+		}
 	}
 
-	return *this;
+	pos.type = idx.size();
+	return false;
 }
-
-// ================================================================
@@ -22,11 +22,9 @@
 #ifndef _OPENCOG_TYPEINDEX_H
 #define _OPENCOG_TYPEINDEX_H
 
-#include <set>
 #include <vector>
 
 #include <opencog/atomspace/Atom.h>
-#include <opencog/atomspace/FixedIntegerIndex.h>
 #include <opencog/atomspace/Handle.h>
 #include <opencog/atomspace/types.h>
 
@@ -37,58 +35,71 @@ namespace opencog
  */
 
 /**
- * Implements an integer index as an RB-tree (C++ set) That is, given
- * an atom Type, this returns all of the Handles for that Type.
+ * Implements an index of atoms by type.  That is, given an atom Type,
+ * this returns all of the Handles for that Type.
  *
- * The primary interface for this is an iterator, and that is because
- * the index will typically contain millions of atoms, and this is far
- * too much to try to return in some temporary array.  Iterating is much
- * safer.
+ * The atoms of each type are kept in a vector, sorted by UUID.  Since
+ * new atoms get ever-larger UUIDs, insertion is almost always an
+ * append.  Removal leaves a hole in the vector, which is squeezed out
+ * once holes make up a quarter of it.
  *
- * @todo The iterator is NOT thread-safe against the insertion or
- * removal of atoms!  Either inserting or removing an atom will cause
- * the iterator references to be freed, leading to mystery crashes!
+ * The index will typically contain millions of atoms, and this is far
+ * too much to try to return in some temporary array, or to walk while
+ * holding a lock.  So the primary interface is fetch(), which hands
+ * out the atoms a chunk at a time.  The place where a chunk ended is
+ * remembered as a (type, UUID) pair, and not as a pointer into the
+ * index; so the index may change freely between two chunks.
+ *
+ * This index is not thread-safe, by itself; users of this class must
+ * guarantee single-threaded access.
  */
-class TypeIndex : public FixedIntegerIndex
+class TypeIndex
 {
 	private:
+		struct Entry
+		{
+			UUID uuid;
+			Atom* atom;     // NULL once the atom has been removed
+		};
+		struct Bucket
+		{
+			std::vector<Entry> atoms;
+			size_t dead;
+			Bucket(void) : dead(0) {}
+		};
+		std::vector<Bucket> idx;
 		size_t num_types;
+		size_t count;
+
+		static bool before(const Entry& e, UUID u) { return e.uuid < u; }
+		void compact(Bucket&);
+
 	public:
 		TypeIndex(void);
 		void resize(void);
-		void insertAtom(Atom* a)
-		{
-			insert(a->getType(), a);
-		}
-		void removeAtom(Atom* a)
-		{
-			remove(a->getType(), a);
-		}
-   		size_t getNumAtomsOfType(Type type, bool subclass) const;
+		void insertAtom(Atom*);
+		void removeAtom(Atom*);
+		size_t size(void) const { return count; }
+		size_t getNumAtomsOfType(Type type, bool subclass) const;
 
-		class iterator
-			: public std::iterator<std::forward_iterator_tag, Handle>
+		/// Where a chunked walk is to resume: the type it was in,
+		/// and the smallest UUID not yet handed out.
+		struct Position
 		{
-			friend class TypeIndex;
-			public:
-				iterator(Type, bool);
-				iterator& operator++();
-				iterator& operator++(int);
-				iterator& operator=(iterator);
-				bool operator==(iterator);
-				bool operator!=(iterator);
-				Handle operator*(void);
-			private:
-				Type type;
-				bool subclass;
-				std::vector<UnorderedAtomSet>::const_iterator s;
-				std::vector<UnorderedAtomSet>::const_iterator send;
-				Type currtype;
-				UnorderedAtomSet::const_iterator se;
+			Type type;
+			UUID uuid;
+			Position(void) : type(0), uuid(0) {}
 		};
 
-		iterator begin(Type, bool) const;
-		iterator end(void) const;
+		/**
+		 * Append to chunk up to n handles of the given type (and its
+		 * subtypes, if subclass is set), resuming at pos, and skipping
+		 * any atom whose UUID is not below upto.  The position is
+		 * advanced past the handles returned.  Returns false if the
+		 * walk reached the end of the index.
+		 */
+		bool fetch(Type, bool subclass, UUID upto,
+		           Position& pos, HandleSeq& chunk, size_t n) const;
 };
 
 /** @}*/
@@ -52,17 +52,15 @@ public:
 	{
 		// Look for incoming links that are of the given type.
 		// Then grab the thing that they link to.
-		link_type = ltype;
 		from_atom = h;
 		to_atom = Handle::UNDEFINED;
 		position_from = from;
 		position_to = to;
-		h->foreach_incoming(&FollowLink::find_link_type, this);
+		h->foreach_incoming_by_type(ltype, &FollowLink::find_link_type, this);
 		return to_atom;
 	}
 
 private:
-	Type link_type;
 	Handle from_atom;
 	Handle to_atom;
 	int position_from;
@@ -74,9 +72,8 @@ private:
 	 */
 	inline bool find_link_type(const Handle& h)
 	{
-		// Make sure that the link is of the desired type.
-		if (link_type != h->getType()) return false;
-
+		// foreach_incoming_by_type() hands us only links of the
+		// desired type.
 		cnt = -1;
 		to_atom = Handle::UNDEFINED;
 		LinkPtr l(LinkCast(h));
@@ -143,7 +143,6 @@ public:
 	}
 
 private:
-	Type link_type;
 	Handle from_atom;
 	Handle to_atom;
 	int position_from;
@@ -158,14 +157,14 @@ private:
 	{
 		// Look for incoming links that are of the given type.
 		// Then grab the thing that they link to.
-		link_type = ltype;
 		from_atom = h;
 		to_atom = Handle::UNDEFINED;
 		position_from = from;
 		position_to = to;
 		user_data = data;
 		endpoint_matcher = &PrivateUseOnlyChaseLink::pursue_link;
-		bool rc = h->foreach_incoming(&PrivateUseOnlyChaseLink::find_link_type, this);
+		bool rc = h->foreach_incoming_by_type(ltype,
+		               &PrivateUseOnlyChaseLink::find_link_type, this);
 		return rc;
 	}
 
@@ -173,23 +172,22 @@ private:
 	{
 		// Look for incoming links that are of the given type.
 		// Then grab the thing that they link to.
-		link_type = ltype;
 		from_atom = h;
 		to_atom = Handle::UNDEFINED;
 		user_data = data;
 		endpoint_matcher = &PrivateUseOnlyChaseLink::pursue_unordered_link;
-		bool rc = h->foreach_incoming(&PrivateUseOnlyChaseLink::find_link_type, this);
+		bool rc = h->foreach_incoming_by_type(ltype,
+		               &PrivateUseOnlyChaseLink::find_link_type, this);
 		return rc;
 	}
 
 	/**
-	 * Check for link of the desired type, then loop over its outgoing set.
+	 * Loop over the outgoing set of a link of the desired type.
+	 * Only links of that type are handed to us, by
+	 * foreach_incoming_by_type().
 	 */
 	inline bool find_link_type(const Handle& link_h)
 	{
-		// Make sure the link is of the specified link type
-		if (link_type != link_h->getType()) return false;
-
 		cnt = -1;
 		to_atom = Handle::UNDEFINED;
 		// foreach_outgoing_handle(link_h, PrivateUseOnlyChaseLink::endpoint_matcher, this);
@@ -3,9 +3,13 @@
 
 #include <ctime>
 #include <iostream>
+#include <malloc.h>
+#include <map>
 #include <fstream>
+#include <thread>
 #include <sys/time.h>
 #include <sys/resource.h>
+#include <unistd.h>
 
 #include <boost/tuple/tuple_io.hpp>
 
@@ -21,6 +25,8 @@
 #include <opencog/atomspace/TruthValue.h>
 #include <opencog/cython/PythonEval.h>
 #include <opencog/guile/SchemeEval.h>
+#include <opencog/query/BindLinkAPI.h>
+#include <opencog/query/DefaultImplicator.h>
 
 #include "AtomSpaceBenchmark.h"
 
@@ -55,6 +61,11 @@ AtomSpaceBenchmark::AtomSpaceBenchmark()
     prg = new std::poisson_distribution<unsigned>(linkSize_mean);
 
     counter = 0;
+    incomingCount = 0;
+    maxThreads = 0;
+    asyncAdd = false;
+    isaThreads = 0;
+    queryWidth = 0;
     showTypeSizes = false;
     Nreps = 100000;
     Nloops = 1;
@@ -186,6 +197,128 @@ void AtomSpaceBenchmark::printTypeSizes()
     Handle el = LK(EVALUATION_LINK, np, ll);
     cout << "EvaluationLink with two ConceptNodes = "
          << estimateOfAtomSize(el) << endl;
+    cout << DIVIDER_LINE << endl;
+
+    printBytesPerAtom();
+    printNameIndexUsage();
+}
+
+static size_t heapInUse()
+{
+    return (size_t) mallinfo().uordblks;
+}
+
+// The current resident set size, in KB.  Unlike getMemUsage(), this is
+// not the high-water mark, so it can go down as well as up.
+static long currentRSS()
+{
+    long pages = 0, resident = 0;
+    std::ifstream statm("/proc/self/statm");
+    statm >> pages >> resident;
+    return resident * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+// Unlike the estimates above, this measures what the allocator actually
+// hands out: the atom object, the make_shared control block, the name or
+// outgoing set, and the incoming-set entries.  The "in table" column adds
+// the AtomTable indexes.  Atoms carry the default TV and AV.
+void AtomSpaceBenchmark::printBytesPerAtom()
+{
+    const size_t N = 20000;
+    const size_t MAX_ARITY = 5;
+
+    cout << "==Measured heap bytes per atom==" << endl;
+
+    AtomTable table;
+    HandleSeq pool;
+    for (size_t i = 0; i < N + MAX_ARITY; i++)
+        pool.push_back(table.add(createNode(CONCEPT_NODE,
+                                 "p" + std::to_string(i)), false));
+    table.barrier();
+
+    // Free-standing nodes, and then the same nodes placed in the table.
+    // The names are short enough to fit into the small-string buffer.
+    {
+        HandleSeq hs;
+        hs.reserve(N);
+        size_t before = heapInUse();
+        for (size_t i = 0; i < N; i++)
+            hs.push_back(Handle(createNode(CONCEPT_NODE, "n" + std::to_string(i))));
+        size_t mid = heapInUse();
+        for (const Handle& h : hs)
+            table.add(h, false);
+        table.barrier();
+        size_t after = heapInUse();
+        cout << "Node: " << (mid - before) / N << " bytes, "
+             << (after - before) / N << " in table" << endl;
+    }
+
+    // Links of arity 1 to 5 over the node pool.  Link i starts at node
+    // i, so that all of them are distinct.
+    for (size_t arity = 1; arity <= MAX_ARITY; arity++)
+    {
+        HandleSeq hs;
+        hs.reserve(N);
+        size_t before = heapInUse();
+        for (size_t i = 0; i < N; i++)
+        {
+            HandleSeq oset(pool.begin() + i, pool.begin() + i + arity);
+            hs.push_back(Handle(createLink(LIST_LINK, oset)));
+        }
+        size_t mid = heapInUse();
+        for (const Handle& h : hs)
+            table.add(h, false);
+        table.barrier();
+        size_t after = heapInUse();
+        cout << "Link of arity " << arity << ": " << (mid - before) / N
+             << " bytes, " << (after - before) / N << " in table" << endl;
+    }
+}
+
+// Measures the memory taken by indexing a batch of nodes, both on the
+// heap and in resident pages.  For comparison, the same names are put
+// into a std::map<std::string, Atom*>, which is what the name index
+// used to be; it holds a second copy of every name, and the names here
+// are too long to fit into the small-string buffer.
+void AtomSpaceBenchmark::printNameIndexUsage()
+{
+    const size_t N = 100000;
+
+    cout << "==Measured name index memory==" << endl;
+
+    HandleSeq hs;
+    hs.reserve(N);
+    for (size_t i = 0; i < N; i++)
+        hs.push_back(Handle(createNode(CONCEPT_NODE,
+                     "name index benchmark node " + std::to_string(i))));
+
+    {
+        std::map<std::string, Atom*> old_index;
+        size_t heap_before = heapInUse();
+        long rss_before = currentRSS();
+        for (const Handle& h : hs)
+            old_index[NodeCast(h)->getName()] = h.operator->();
+        size_t heap_after = heapInUse();
+        long rss_after = currentRSS();
+        cout << "std::map name index: " << (heap_after - heap_before) / N
+             << " heap bytes per node, RSS grew by "
+             << rss_after - rss_before << " KB" << endl;
+    }
+
+    // The table adds the nodes to its other indexes as well, so this is
+    // an upper bound on what the name index itself costs.
+    AtomTable table;
+    size_t heap_before = heapInUse();
+    long rss_before = currentRSS();
+    for (const Handle& h : hs)
+        table.add(h, false);
+    table.barrier();
+    size_t heap_after = heapInUse();
+    long rss_after = currentRSS();
+    cout << "AtomTable, all indexes: " << (heap_after - heap_before) / N
+         << " heap bytes per node, RSS grew by "
+         << rss_after - rss_before << " KB" << endl;
+    cout << DIVIDER_LINE << endl;
 }
 
 void AtomSpaceBenchmark::showMethods() {
@@ -203,6 +336,8 @@ void AtomSpaceBenchmark::showMethods() {
     cout << "  getHandlesByType" << endl;
     cout << "  getOutgoingSet" << endl;
     cout << "  getIncomingSet" << endl;
+    cout << "  foreachIncoming" << endl;
+    cout << "  addHubLink" << endl;
 }
 
 void AtomSpaceBenchmark::setMethod(std::string methodToTest)
@@ -277,6 +412,18 @@ void AtomSpaceBenchmark::setMethod(std::string methodToTest)
         foundMethod = true;
     } 
 
+    if (methodToTest == "all" || methodToTest == "foreachIncoming") {
+        methodsToTest.push_back( &AtomSpaceBenchmark::bm_foreachIncoming);
+        methodNames.push_back( "foreachIncoming");
+        foundMethod = true;
+    } 
+
+    if (methodToTest == "all" || methodToTest == "addHubLink") {
+        methodsToTest.push_back( &AtomSpaceBenchmark::bm_addHubLink);
+        methodNames.push_back( "addHubLink");
+        foundMethod = true;
+    } 
+
     if (!foundMethod) {
         std::cerr << "Error: specified a bad test name: " << methodToTest << std::endl;
         exit(1);
@@ -447,6 +594,233 @@ void AtomSpaceBenchmark::startBenchmark(int numThreads)
     //cout << estimateOfAtomSize(Handle(1020)) << endl;
 }
 
+// Worker for the scaling benchmark: add a chain of nodes and links,
+// then look all of them up again.  Returns the number of operations
+// performed in the count argument.
+static void scaling_worker(AtomSpace* as,
+                           const std::vector<std::string>* names,
+                           bool async, size_t* count)
+{
+    size_t nops = 0;
+    Handle prev;
+    for (const std::string& name : *names) {
+        Handle h(as->add_node(CONCEPT_NODE, name, async));
+        nops++;
+        if (prev) {
+            as->add_link(LIST_LINK, {prev, h}, async);
+            nops++;
+        }
+        prev = h;
+    }
+
+    prev = Handle::UNDEFINED;
+    for (const std::string& name : *names) {
+        Handle h(as->get_handle(CONCEPT_NODE, name));
+        nops++;
+        if (prev) {
+            as->get_handle(LIST_LINK, prev, h);
+            nops++;
+        }
+        prev = h;
+    }
+    *count = nops;
+}
+
+// Multi-threaded add/lookup benchmark.  Runs the same per-thread
+// workload with 1, 2, 4, ... maxThreads threads, all hitting the same
+// atomspace, and reports the aggregate throughput.  With no lock
+// contention, the throughput should scale linearly with the number of
+// threads (up to the number of cores).  Wall-clock time is used here,
+// since clock() adds up the cpu time of all threads.
+void AtomSpaceBenchmark::scalingBenchmark()
+{
+    cout << "OpenCog Atomspace Benchmark - " << VERSION_STRING << "\n";
+    cout << "Multi-threaded add/lookup scaling, " << Nreps
+         << " nodes per thread, up to " << maxThreads << " threads"
+         << (asyncAdd ? ", async adds\n" : "\n");
+    cout << DIVIDER_LINE << endl;
+
+    double base_rate = 0.0;
+    for (int nthreads = 1; nthreads <= maxThreads; nthreads *= 2)
+    {
+        // Build the names ahead of time, so that string formatting
+        // is not part of the measurement.
+        std::vector<std::vector<std::string>> names(nthreads);
+        for (int k = 0; k < nthreads; k++) {
+            for (unsigned int i = 0; i < Nreps; i++) {
+                std::ostringstream oss;
+                oss << "thread " << k << " node " << i;
+                names[k].push_back(oss.str());
+            }
+        }
+        std::vector<size_t> counts(nthreads, 0);
+
+        AtomSpace* as = new AtomSpace();
+        timeval tim;
+        gettimeofday(&tim, NULL);
+        double t1 = tim.tv_sec + (tim.tv_usec/1000000.0);
+
+        std::vector<std::thread> workers;
+        for (int k = 0; k < nthreads; k++)
+            workers.push_back(std::thread(scaling_worker, as,
+                                          &names[k], asyncAdd, &counts[k]));
+        for (std::thread& w : workers) w.join();
+
+        // The async adds are not done until the indexes have caught up.
+        as->barrier();
+
+        gettimeofday(&tim, NULL);
+        double t2 = tim.tv_sec + (tim.tv_usec/1000000.0);
+        delete as;
+
+        size_t nops = 0;
+        for (size_t c : counts) nops += c;
+        double rate = nops / (t2 - t1);
+        if (1 == nthreads) base_rate = rate;
+
+        printf("%3d threads: %.3f seconds, %.0f ops per second, "
+               "speedup %.2f (efficiency %.0f%%)\n",
+               nthreads, t2 - t1, rate, rate / base_rate,
+               100.0 * rate / (base_rate * nthreads));
+
+        // Run the top count, even if it is not a power of two.
+        if (nthreads < maxThreads and maxThreads < 2*nthreads)
+            nthreads = maxThreads / 2;
+    }
+    cout << DIVIDER_LINE << endl;
+}
+
+// Worker for the isA benchmark: check every pair of types, Nreps times.
+static void isa_worker(const std::vector<std::pair<Type,Type>>* pairs,
+                       unsigned int reps, size_t* count)
+{
+    size_t nyes = 0;
+    for (unsigned int r = 0; r < reps; r++)
+        for (const auto& p : *pairs)
+            if (classserver().isA(p.first, p.second)) nyes++;
+    *count = nyes;
+}
+
+// Multi-threaded ClassServer::isA() throughput.  isA() is called from
+// nearly everywhere, including the pattern matcher inner loops, and
+// so it must not serialize the threads calling it.
+void AtomSpaceBenchmark::isaBenchmark()
+{
+    Type ntypes = classserver().getNumberOfClasses();
+    std::vector<std::pair<Type,Type>> pairs;
+    for (Type sub = 0; sub < ntypes; sub++)
+        for (Type super = 0; super < ntypes; super++)
+            pairs.push_back(std::make_pair(sub, super));
+
+    // Each thread makes about Nreps isA calls.
+    unsigned int reps = std::max((size_t) 1, Nreps / pairs.size());
+
+    cout << "OpenCog Atomspace Benchmark - " << VERSION_STRING << "\n";
+    cout << "Multi-threaded ClassServer::isA, " << reps * pairs.size()
+         << " calls per thread, up to " << isaThreads << " threads\n";
+    cout << DIVIDER_LINE << endl;
+
+    double base_rate = 0.0;
+    for (int nthreads = 1; nthreads <= isaThreads; nthreads *= 2)
+    {
+        std::vector<size_t> counts(nthreads, 0);
+        timeval tim;
+        gettimeofday(&tim, NULL);
+        double t1 = tim.tv_sec + (tim.tv_usec/1000000.0);
+
+        std::vector<std::thread> workers;
+        for (int k = 0; k < nthreads; k++)
+            workers.push_back(std::thread(isa_worker, &pairs, reps,
+                                          &counts[k]));
+        for (std::thread& w : workers) w.join();
+
+        gettimeofday(&tim, NULL);
+        double t2 = tim.tv_sec + (tim.tv_usec/1000000.0);
+
+        double rate = nthreads * reps * pairs.size() / (t2 - t1);
+        if (1 == nthreads) base_rate = rate;
+
+        printf("%3d threads: %.3f seconds, %.0f calls per second, "
+               "speedup %.2f (efficiency %.0f%%)\n",
+               nthreads, t2 - t1, rate, rate / base_rate,
+               100.0 * rate / (base_rate * nthreads));
+
+        if (nthreads < isaThreads and isaThreads < 2*nthreads)
+            nthreads = isaThreads / 2;
+    }
+    cout << DIVIDER_LINE << endl;
+}
+
+// Pattern matcher start-point selection.  The query is
+//
+//    EvaluationLink
+//        PredicateNode "likes"
+//        ListLink
+//            ConceptNode "hub"
+//            VariableNode "$x"
+//
+// where "hub" has queryWidth ListLinks in its incoming set, and Nreps
+// InheritanceLinks, while "likes" has Nreps/2 other EvaluationLinks.
+// Going by the size of the whole incoming set, "likes" looks like the
+// better place to start; but only the ListLinks can hold the variable,
+// so "hub" is.  The report shows which was picked, and how many
+// candidates had to be explored to find the queryWidth answers.
+void AtomSpaceBenchmark::queryBenchmark()
+{
+    cout << "OpenCog Atomspace Benchmark - " << VERSION_STRING << "\n";
+    cout << "Pattern matcher starting point, " << queryWidth
+         << " answers, " << Nreps << " distractors\n";
+    cout << DIVIDER_LINE << endl;
+
+    AtomSpace* as = new AtomSpace();
+    Handle likes(as->add_node(PREDICATE_NODE, "likes"));
+    Handle hub(as->add_node(CONCEPT_NODE, "hub"));
+    for (unsigned int i = 0; i < Nreps; i++)
+    {
+        std::ostringstream oss;
+        oss << "thing " << i;
+        Handle thing(as->add_node(CONCEPT_NODE, oss.str()));
+        as->add_link(INHERITANCE_LINK, {thing, hub});
+        if (i % 2) continue;
+        oss << " other";
+        Handle other(as->add_node(CONCEPT_NODE, oss.str()));
+        as->add_link(EVALUATION_LINK,
+            {likes, as->add_link(LIST_LINK, {thing, other})});
+    }
+    for (int i = 0; i < queryWidth; i++)
+    {
+        std::ostringstream oss;
+        oss << "pal " << i;
+        Handle pal(as->add_node(CONCEPT_NODE, oss.str()));
+        as->add_link(EVALUATION_LINK,
+            {likes, as->add_link(LIST_LINK, {hub, pal})});
+    }
+
+    Handle var(as->add_node(VARIABLE_NODE, "$x"));
+    Handle clause(as->add_link(EVALUATION_LINK,
+        {likes, as->add_link(LIST_LINK, {hub, var})}));
+    Handle bind(as->add_link(BIND_LINK, {var, clause, var}));
+
+    DefaultImplicator impl(as);
+    timeval tim;
+    gettimeofday(&tim, NULL);
+    double t1 = tim.tv_sec + (tim.tv_usec/1000000.0);
+
+    Handle result(do_imply(as, bind, impl));
+
+    gettimeofday(&tim, NULL);
+    double t2 = tim.tv_sec + (tim.tv_usec/1000000.0);
+
+    Handle start(impl.get_starter_term());
+    cout << "Starter term: " << (Handle::UNDEFINED == start ?
+            std::string("(none)\n") : start->toShortString());
+    printf("Answers: %zu, candidates explored: %zu, %.3f seconds\n",
+           LinkCast(result)->getArity(), impl.get_num_candidates(),
+           t2 - t1);
+    delete as;
+    cout << DIVIDER_LINE << endl;
+}
+
 std::string
 AtomSpaceBenchmark::memoize_or_compile(std::string exp)
 {
@@ -1149,6 +1523,41 @@ timepair_t AtomSpaceBenchmark::bm_getIncomingSet()
     return timepair_t(0,0);
 }
 
+// Walks the incoming set in place, instead of copying it out as
+// getIncomingSet does.  There is no scheme or python equivalent.
+timepair_t AtomSpaceBenchmark::bm_foreachIncoming()
+{
+    Handle h = getRandomHandle();
+    clock_t t_begin = clock();
+    h->foreach_incoming(&AtomSpaceBenchmark::countIncoming, this);
+    clock_t time_taken = clock() - t_begin;
+    return timepair_t(time_taken,0);
+}
+
+// Adds links that all hold one hub node, so that the incoming set of
+// the hub grows to the size of the whole run; the time per add shows
+// whether incoming-set insertion stays cheap at high fan-in.  There is
+// no scheme or python equivalent.
+timepair_t AtomSpaceBenchmark::bm_addHubLink()
+{
+    static size_t spokes = 0;
+    Handle spoke(createNode(CONCEPT_NODE,
+                            "hub spoke " + std::to_string(spokes++)));
+
+    clock_t t_begin = clock();
+    if (testKind == BENCH_TABLE) {
+        Handle hub(atab->add(createNode(CONCEPT_NODE, "hub"), false));
+        spoke = atab->add(spoke, false);
+        atab->add(createLink(LIST_LINK, hub, spoke), false);
+    } else {
+        Handle hub(asp->add_node(CONCEPT_NODE, "hub"));
+        spoke = asp->add_atom(spoke);
+        asp->add_link(LIST_LINK, hub, spoke);
+    }
+    clock_t time_taken = clock() - t_begin;
+    return timepair_t(time_taken,0);
+}
+
 AtomSpaceBenchmark::TimeStats::TimeStats(
         const std::vector<record_t>& records)
 {
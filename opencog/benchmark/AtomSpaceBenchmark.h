@@ -107,8 +107,20 @@ public:
     float percentLinks;
     long atomCount; //! number of nodes to build atomspace with before testing
 
+    int maxThreads; //! upper limit for the multi-threaded scaling benchmark
+    bool asyncAdd;  //! use async adds in the scaling benchmark
+    void scalingBenchmark();
+
+    int isaThreads; //! upper limit for the ClassServer::isA benchmark
+    void isaBenchmark();
+
+    int queryWidth; //! answers for the pattern matcher start-point benchmark
+    void queryBenchmark();
+
     bool showTypeSizes;
     void printTypeSizes();
+    void printBytesPerAtom();
+    void printNameIndexUsage();
     size_t estimateOfAtomSize(Handle h);
 
     AtomSpaceBenchmark();
@@ -133,6 +145,10 @@ public:
     timepair_t bm_getHandlesByType();
     timepair_t bm_getOutgoingSet();
     timepair_t bm_getIncomingSet();
+    timepair_t bm_foreachIncoming();
+    timepair_t bm_addHubLink();
+    size_t incomingCount;
+    bool countIncoming(const Handle&) { incomingCount++; return false; }
 
     // Get and set TV and AV
     float chanceUseDefaultTV; // if set, this will use default TV for new atoms and bm_setTruthValue
@@ -30,6 +30,13 @@ int main(int argc, char** argv)
      "          \t(default: time(NULL))\n"
      "-S <int>  \tHow many random atoms to add after each measurement\n"
      "          \t(default: 0)\n"
+     "-T <int>  \tRun the multi-threaded add/lookup scaling benchmark,\n"
+     "          \twith up to this many threads; -n sets the nodes per thread\n"
+     "-y        \tIn the scaling benchmark, add atoms asynchronously\n"
+     "-j <int>  \tRun the ClassServer::isA throughput benchmark, with up\n"
+     "          \tto this many threads; -n sets the calls per thread\n"
+     "-Q <int>  \tRun the pattern matcher start-point benchmark, with\n"
+     "          \tthis many answers; -n sets the number of distractors\n"
      "-- Build test data --\n"
      "-p <float> \tSet the connection probability or coordination number\n"
      "         \t(default: 0.2)\n"
@@ -52,7 +59,7 @@ int main(int argc, char** argv)
     opterr = 0;
     benchmarker.testKind = opencog::AtomSpaceBenchmark::BENCH_AS;
 
-    while ((c = getopt (argc, argv, "tAXgMCcm:ln:r:R:S:p:s:d:kfi:")) != -1) {
+    while ((c = getopt (argc, argv, "tAXgMCcm:ln:r:R:S:T:yj:Q:p:s:d:kfi:")) != -1) {
        switch (c)
        {
            case 't':
@@ -109,6 +116,18 @@ int main(int argc, char** argv)
            case 'S':
              benchmarker.sizeIncrease = atoi(optarg);
              break;
+           case 'T':
+             benchmarker.maxThreads = atoi(optarg);
+             break;
+           case 'y':
+             benchmarker.asyncAdd = true;
+             break;
+           case 'j':
+             benchmarker.isaThreads = atoi(optarg);
+             break;
+           case 'Q':
+             benchmarker.queryWidth = atoi(optarg);
+             break;
            case 'p':
              benchmarker.percentLinks = atof(optarg);
              break;
@@ -177,6 +196,24 @@ int main(int argc, char** argv)
     }
 #endif // HAVE_GUILE
 
+    if (0 < benchmarker.maxThreads)
+    {
+        benchmarker.scalingBenchmark();
+        return 0;
+    }
+
+    if (0 < benchmarker.isaThreads)
+    {
+        benchmarker.isaBenchmark();
+        return 0;
+    }
+
+    if (0 < benchmarker.queryWidth)
+    {
+        benchmarker.queryBenchmark();
+        return 0;
+    }
+
     benchmarker.startBenchmark();
     return 0;
 }
@@ -15,10 +15,32 @@ cdef extern from "opencog/query/BindLinkAPI.h" namespace "opencog":
     #   Handle af_bindlink(AtomSpace*, Handle);
     #   TruthValuePtr satisfaction_link(AtomSpace*, Handle);
     #
-    cdef cHandle c_bindlink "bindlink" (cAtomSpace*, cHandle)
-    cdef cHandle c_single_bindlink "single_bindlink" (cAtomSpace*, cHandle)
-    cdef cHandle c_af_bindlink "af_bindlink" (cAtomSpace*, cHandle)
-    cdef tv_ptr c_satisfaction_link "satisfaction_link" (cAtomSpace*, cHandle)
+    cdef cHandle c_bindlink "bindlink" (cAtomSpace*, cHandle) nogil
+    cdef cHandle c_single_bindlink "single_bindlink" (cAtomSpace*, cHandle) nogil
+    cdef cHandle c_af_bindlink "af_bindlink" (cAtomSpace*, cHandle) nogil
+    cdef tv_ptr c_satisfaction_link "satisfaction_link" (cAtomSpace*, cHandle) nogil
+
+
+cdef extern from "opencog/query/EvaluationMemo.h" namespace "opencog":
+    # C++:
+    #   static size_t EvaluationMemo::total_hits(void);
+    #   static size_t EvaluationMemo::total_misses(void);
+    #
+    cdef size_t c_memo_hits "opencog::EvaluationMemo::total_hits" ()
+    cdef size_t c_memo_misses "opencog::EvaluationMemo::total_misses" ()
+
+
+cdef extern from "opencog/query/BindLinkStream.h" namespace "opencog":
+    # C++:
+    #   BindLinkStream(AtomSpace*, const Handle&, size_t offset,
+    #                  size_t limit, bool instantiate, size_t backlog);
+    #   bool next(Handle&);
+    #   void close(void);
+    #
+    cdef cppclass cBindLinkStream "opencog::BindLinkStream":
+        cBindLinkStream(cAtomSpace*, cHandle, size_t, size_t, bint, size_t)
+        bint next(cHandle&) nogil except +
+        void close() nogil
 
 
 cdef extern from "opencog/atoms/execution/EvaluationLink.h" namespace "opencog":
@@ -10,26 +10,86 @@ def stub_bindlink(AtomSpace atomspace, Handle handle):
     cdef Handle result = Handle(c_result.value())
     return result
 
+# The searches run without the GIL: they may call back into python, for
+# a GroundedPredicateNode, from threads of their own.
+
 def bindlink(AtomSpace atomspace, Handle handle):
-    cdef cHandle c_result = c_bindlink(atomspace.atomspace,
-                                       deref(handle.h))
+    cdef cAtomSpace* c_as = atomspace.atomspace
+    cdef cHandle c_handle = deref(handle.h)
+    cdef cHandle c_result
+    with nogil:
+        c_result = c_bindlink(c_as, c_handle)
     cdef Handle result = Handle(c_result.value())
     return result
 
 def single_bindlink(AtomSpace atomspace, Handle handle):
-    cdef cHandle c_result = c_single_bindlink(atomspace.atomspace,
-                                              deref(handle.h))
+    cdef cAtomSpace* c_as = atomspace.atomspace
+    cdef cHandle c_handle = deref(handle.h)
+    cdef cHandle c_result
+    with nogil:
+        c_result = c_single_bindlink(c_as, c_handle)
     cdef Handle result = Handle(c_result.value())
     return result
 
 def af_bindlink(AtomSpace atomspace, Handle handle):
-    cdef cHandle c_result = c_af_bindlink(atomspace.atomspace, deref(handle.h))
+    cdef cAtomSpace* c_as = atomspace.atomspace
+    cdef cHandle c_handle = deref(handle.h)
+    cdef cHandle c_result
+    with nogil:
+        c_result = c_af_bindlink(c_as, c_handle)
     cdef Handle result = Handle(c_result.value())
     return result
 
+def bindlink_stream(AtomSpace atomspace, Handle handle,
+                    offset=0, limit=None, instantiate=True, backlog=64):
+    """
+    Yield the results of the BindLink one at a time, as they are found,
+    instead of returning them all in a SetLink.  The first offset
+    groundings are skipped, and at most limit results are yielded.  If
+    instantiate is false, the groundings of the variables are yielded
+    instead of the implicand; a ListLink of them, if there are several.
+    """
+    cdef size_t c_limit = <size_t>-1 if limit is None else limit
+    cdef cBindLinkStream* stream = new cBindLinkStream(atomspace.atomspace,
+            deref(handle.h), offset, c_limit, instantiate, backlog)
+    cdef cHandle c_result
+    cdef bint ok
+    try:
+        while True:
+            # The search may call back into python, for a GroundedPredicateNode.
+            with nogil:
+                ok = stream.next(c_result)
+            if not ok:
+                break
+            yield Handle(c_result.value())
+    finally:
+        # Closing waits for the search thread, which may be waiting for
+        # the GIL, to run a python GroundedPredicateNode.
+        with nogil:
+            stream.close()
+            del stream
+
+def memo_hits():
+    """
+    The number of times that a GroundedPredicateNode in a pattern was
+    answered from a memo.  Memos are off unless turned on with the
+    PATTERN_MATCHER_MEMO config parameter.
+    """
+    return c_memo_hits()
+
+def memo_misses():
+    """
+    The number of times that a GroundedPredicateNode in a pattern was
+    evaluated, while a memo was on.
+    """
+    return c_memo_misses()
+
 def satisfaction_link(AtomSpace atomspace, Handle handle):
-    cdef tv_ptr result_tv_ptr = c_satisfaction_link(atomspace.atomspace,
-                                                 deref(handle.h))
+    cdef cAtomSpace* c_as = atomspace.atomspace
+    cdef cHandle c_handle = deref(handle.h)
+    cdef tv_ptr result_tv_ptr
+    with nogil:
+        result_tv_ptr = c_satisfaction_link(c_as, c_handle)
     cdef cTruthValue* result_tv = result_tv_ptr.get()
     cdef strength_t strength = deref(result_tv).getMean()
     cdef strength_t confidence = deref(result_tv).getConfidence()
@@ -5,6 +5,8 @@
  * Copyright (c) 2008, 2014, 2015 Linas Vepstas <linas@linas.org>
  */
 
+#include <exception>
+
 #include <opencog/atomspace/AtomSpace.h>
 #include <opencog/guile/SchemeModule.h>
 #include <opencog/guile/SchemePrimitive.h>
@@ -26,18 +28,59 @@ FunctionWrap::FunctionWrap(TruthValuePtr (p)(AtomSpace*, const Handle&),
 	define_scheme_primitive(_name, &FunctionWrap::prapper, this, modname);
 }
 
+/// The call is made outside of guile mode.  The function may run a
+/// search on several threads, and wait for them; a thread that waits
+/// in guile mode holds up every other thread that wants to run scheme,
+/// such as a GroundedSchemaNode in the search.  Scheme code that the
+/// function runs re-enters guile mode on its own.
+struct FunctionWrap::Call
+{
+	FunctionWrap* self;
+	AtomSpace* as;
+	Handle h;
+	Handle hresult;
+	TruthValuePtr tvresult;
+	std::exception_ptr failure;
+};
+
+void* FunctionWrap::call_without_guile(void* data)
+{
+	Call* c = (Call*) data;
+	try
+	{
+		if (c->self->_func) c->hresult = c->self->_func(c->as, c->h);
+		else c->tvresult = c->self->_pred(c->as, c->h);
+	}
+	catch (...)
+	{
+		// Exceptions must not unwind through guile's C frames.
+		c->failure = std::current_exception();
+	}
+	return NULL;
+}
+
 Handle FunctionWrap::wrapper(Handle h)
 {
 	// XXX we should also allow opt-args to be a list of handles
-	AtomSpace *as = SchemeSmob::ss_get_env_as(_name);
-	return _func(as, h);
+	Call c;
+	c.self = this;
+	c.as = SchemeSmob::ss_get_env_as(_name);
+	c.h = h;
+	scm_without_guile(call_without_guile, &c);
+	if (c.failure) std::rethrow_exception(c.failure);
+	return c.hresult;
 }
 
 TruthValuePtr FunctionWrap::prapper(Handle h)
 {
 	// XXX we should also allow opt-args to be a list of handles
-	AtomSpace *as = SchemeSmob::ss_get_env_as(_name);
-	return _pred(as, h);
+	Call c;
+	c.self = this;
+	c.as = SchemeSmob::ss_get_env_as(_name);
+	c.h = h;
+	scm_without_guile(call_without_guile, &c);
+	if (c.failure) std::rethrow_exception(c.failure);
+	return c.tvresult;
 }
 
 // ========================================================
@@ -25,6 +25,9 @@ class FunctionWrap
 		TruthValuePtr (*_pred)(AtomSpace*, const Handle&);
 		TruthValuePtr prapper(Handle);
 
+		struct Call;
+		static void* call_without_guile(void*);
+
 		const char *_name;  // scheme name of the c++ function.
 	public:
 		FunctionWrap(Handle (*)(AtomSpace*, const Handle&),
@@ -13,6 +13,7 @@
 #define _OPENCOG_SCHEME_PRIMITIVE_H
 
 #include <string>
+#include <utility>
 
 #include <opencog/atomspace/Handle.h>
 #include <opencog/atomspace/TruthValue.h>
@@ -25,6 +26,10 @@ namespace opencog {
  *  @{
  */
 
+/// A count, and a list of handles; passed to scheme as a list, with
+/// the count first.
+typedef std::pair<int, HandleSeq> CountedHandleSeq;
+
 class PrimitiveEnviron
 {
 	friend class SchemeEval;
@@ -77,6 +82,7 @@ class SchemePrimitive : public PrimitiveEnviron
 			// d == double
 			// h == Handle
 			// i == int
+			// n == CountedHandleSeq
 			// q == HandleSeq
 			// k == HandleSeqSeq
 			// s == string
@@ -98,7 +104,11 @@ class SchemePrimitive : public PrimitiveEnviron
 			Handle (T::*h_sq)(const std::string&, const HandleSeq&);
 			Handle (T::*h_sqq)(const std::string&,
 			                   const HandleSeq&, const HandleSeq&);
+			int (T::*i_hi)(Handle, int);
+			int (T::*i_v)(void);
+			CountedHandleSeq (T::*n_hii)(Handle, int, int);
 			HandleSeq (T::*q_h)(Handle);
+			HandleSeq (T::*q_ii)(int, int);
 			HandleSeq (T::*q_hti)(Handle, Type, int);
 			HandleSeq (T::*q_htib)(Handle, Type, int, bool);
 			HandleSeqSeq (T::*k_h)(Handle);
@@ -111,6 +121,7 @@ class SchemePrimitive : public PrimitiveEnviron
 			                               const std::string&);
 			TruthValuePtr (T::*p_h)(Handle);
 			void (T::*v_h)(Handle);
+			void (T::*v_i)(int);
 			void (T::*v_s)(const std::string&);
 			void (T::*v_ss)(const std::string&,
 			                const std::string&);
@@ -137,7 +148,11 @@ class SchemePrimitive : public PrimitiveEnviron
 			H_HS,  // return handle, take handle and string
 			H_SQ,  // return handle, take string and HandleSeq
 			H_SQQ, // return handle, take string, HandleSeq and HandleSeq
+			I_HI,  // return int, take handle and int
+			I_V,   // return int, take void
+			N_HII, // return count and HandleSeq, take handle, int and int
 			Q_H,   // return HandleSeq, take handle
+			Q_II,  // return HandleSeq, take two ints
 			Q_HTI, // return HandleSeq, take handle, type, and int
 			Q_HTIB,// return HandleSeq, take handle, type, and bool
 			K_H,   // return HandleSeqSeq, take Handle
@@ -147,6 +162,7 @@ class SchemePrimitive : public PrimitiveEnviron
 			S_SSS, // return string, take three strings
 			P_H,   // return truth value, take Handle
 			V_H,   // return void, take Handle
+			V_I,   // return void, take int
 			V_S,   // return void, take string
 			V_SS,  // return void, take two strings
 			V_SSS, // return void, take three strings
@@ -268,6 +284,42 @@ class SchemePrimitive : public PrimitiveEnviron
 					rc = SchemeSmob::handle_to_scm(rh);
 					break;
 				}
+				case I_HI:
+				{
+					Handle h(SchemeSmob::verify_handle(scm_car(args), scheme_name));
+					int i = SchemeSmob::verify_int(scm_cadr(args), scheme_name, 2);
+					int ri = (that->*method.i_hi)(h, i);
+					rc = scm_from_int(ri);
+					break;
+				}
+				case I_V:
+				{
+					int ri = (that->*method.i_v)();
+					rc = scm_from_int(ri);
+					break;
+				}
+				case N_HII:
+				{
+					// First arg is a handle
+					Handle h(SchemeSmob::verify_handle(scm_car(args), scheme_name, 1));
+
+					// Second and third args are ints
+					int i = SchemeSmob::verify_int(scm_cadr(args), scheme_name, 2);
+					int j = SchemeSmob::verify_int(scm_caddr(args), scheme_name, 3);
+
+					CountedHandleSeq rCHS((that->*method.n_hii)(h, i, j));
+					const HandleSeq& rHS = rCHS.second;
+
+					rc = SCM_EOL;
+
+					// Reverse iteration to preserve order when doing cons
+					for (HandleSeq::const_reverse_iterator rit = rHS.rbegin(); rit != rHS.rend(); ++rit)
+						rc = scm_cons(SchemeSmob::handle_to_scm(*rit), rc);
+
+					// The count goes in front.
+					rc = scm_cons(scm_from_int(rCHS.first), rc);
+					break;
+				}
 				case Q_H:
 				{
 					// the only argument is a handle
@@ -282,6 +334,20 @@ class SchemePrimitive : public PrimitiveEnviron
 
 					break;
 				}
+				case Q_II:
+				{
+					int i = SchemeSmob::verify_int(scm_car(args), scheme_name, 1);
+					int j = SchemeSmob::verify_int(scm_cadr(args), scheme_name, 2);
+					HandleSeq rHS((that->*method.q_ii)(i, j));
+
+					rc = SCM_EOL;
+
+					// Reverse iteration to preserve order when doing cons
+					for (HandleSeq::reverse_iterator rit = rHS.rbegin(); rit != rHS.rend(); ++rit)
+						rc = scm_cons(SchemeSmob::handle_to_scm(*rit), rc);
+
+					break;
+				}
 				case Q_HTI:
 				{
 					// First arg is a handle
@@ -420,6 +486,12 @@ class SchemePrimitive : public PrimitiveEnviron
 					(that->*method.v_h)(h);
 					break;
 				}
+				case V_I:
+				{
+					int i = SchemeSmob::verify_int(scm_car(args), scheme_name, 1);
+					(that->*method.v_i)(i);
+					break;
+				}
 				case V_S:
 				{
 					// First argument is a string
@@ -575,7 +647,10 @@ class SchemePrimitive : public PrimitiveEnviron
 		DECLARE_CONSTR_2(H_HS, h_hs, Handle, Handle, const std::string&)
 		DECLARE_CONSTR_2(H_SQ, h_sq, Handle, const std::string&, const HandleSeq&)
 		DECLARE_CONSTR_3(H_SQQ, h_sqq, Handle, const std::string&, const HandleSeq&, const HandleSeq&)
+		DECLARE_CONSTR_2(I_HI, i_hi, int, Handle, int)
+		DECLARE_CONSTR_3(N_HII, n_hii, CountedHandleSeq, Handle, int, int)
 		DECLARE_CONSTR_1(Q_H, q_h, HandleSeq, Handle)
+		DECLARE_CONSTR_2(Q_II, q_ii, HandleSeq, int, int)
 		DECLARE_CONSTR_3(Q_HTI, q_hti, HandleSeq, Handle, Type, int)
 		DECLARE_CONSTR_4(Q_HTIB, q_htib, HandleSeq, Handle, Type, int, bool)
 		DECLARE_CONSTR_1(K_H, k_h, HandleSeqSeq, Handle)
@@ -587,6 +662,7 @@ class SchemePrimitive : public PrimitiveEnviron
 		                             const std::string&, const std::string&)
 		DECLARE_CONSTR_1(P_H,  p_h,  TruthValuePtr, Handle)
 		DECLARE_CONSTR_1(V_H,  v_h,  void, Handle)
+		DECLARE_CONSTR_1(V_I,  v_i,  void, int)
 		DECLARE_CONSTR_1(V_S,  v_s,  void, const std::string&)
 		DECLARE_CONSTR_2(V_SS, v_ss, void, const std::string&,
 		                             const std::string&)
@@ -607,6 +683,18 @@ class SchemePrimitive : public PrimitiveEnviron
 			signature = V_V;
 			do_register(module, name, 0); // cb has 0 args
 		}
+
+		// Below is DECLARE_CONSTR_0(I_V, i_v, int, void);
+		SchemePrimitive(const char *module, const char *name,
+		                int (T::*cb)(void), T *data)
+		{
+			that = data;
+			method.i_v = cb;
+			scheme_module = module;
+			scheme_name = name;
+			signature = I_V;
+			do_register(module, name, 0); // cb has 0 args
+		}
 };
 
 #define DECLARE_DECLARE_1(RET,ARG) \
@@ -650,9 +738,11 @@ DECLARE_DECLARE_1(HandleSeqSeq, Handle)
 DECLARE_DECLARE_1(const std::string&, const std::string&)
 DECLARE_DECLARE_1(TruthValuePtr, Handle)
 DECLARE_DECLARE_1(void, Handle)
+DECLARE_DECLARE_1(void, int)
 DECLARE_DECLARE_1(void, const std::string&)
 DECLARE_DECLARE_1(void, Type)
 DECLARE_DECLARE_1(void, void)
+DECLARE_DECLARE_1(int, void)
 DECLARE_DECLARE_2(bool, Handle, int)
 DECLARE_DECLARE_2(bool, Handle, Handle)
 DECLARE_DECLARE_2(Handle, Handle, int)
@@ -660,11 +750,14 @@ DECLARE_DECLARE_2(Handle, Handle, Handle)
 DECLARE_DECLARE_2(Handle, Handle, const std::string&)
 DECLARE_DECLARE_2(Handle, const std::string&, const HandleSeq&)
 DECLARE_DECLARE_2(HandleSeqSeq, Handle, int)
+DECLARE_DECLARE_2(HandleSeq, int, int)
+DECLARE_DECLARE_2(int, Handle, int)
 DECLARE_DECLARE_2(const std::string&, const std::string&, const std::string&)
 DECLARE_DECLARE_2(void, const std::string&, const std::string&)
 DECLARE_DECLARE_2(void, Type, int)
 DECLARE_DECLARE_3(double, Handle, Handle, Type)
 DECLARE_DECLARE_3(Handle, const std::string&, const HandleSeq&, const HandleSeq&)
+DECLARE_DECLARE_3(CountedHandleSeq, Handle, int, int)
 DECLARE_DECLARE_3(HandleSeq, Handle, Type, int)
 DECLARE_DECLARE_3(const std::string&, const std::string&,
                   const std::string&, const std::string&)
@@ -32,6 +32,9 @@
 #include <unistd.h>
 
 #include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
 #include <memory>
 #include <thread>
 
@@ -125,12 +128,22 @@ class AtomStorage::Response
 			}
 			return false;
 		}
-		bool create_atom_cb(void)
-		{
-			// printf ("---- New atom found ----\n");
-			rs->foreach_column(&Response::create_atom_column_cb, this);
 
-			return false;
+		// The same, for a row of one of the prepared queries, whose
+		// columns are the ATOM_COLUMNS, in that order.  The numbers
+		// arrive in binary, so there's nothing to look up or parse,
+		// except for the outgoing set.
+		void decode_statement_row(ODBCStatement *st)
+		{
+			handle = Handle((UUID) st->get_long(0));
+			itype = st->get_long(1);
+			tv_type = st->get_long(2);
+			mean = st->get_double(3);
+			confidence = st->get_double(4);
+			count = st->get_double(5);
+			name = st->get_text(6);
+			if (NULL == name) name = "";
+			outlist = st->get_text(7);
 		}
 
 		AtomTable *table;
@@ -177,23 +190,27 @@ class AtomStorage::Response
 				{
 					if (table->holds(h)) continue;
 					AtomPtr a(store->getAtom(h));
+					if (NULL == a)
+						throw RuntimeException(TRACE_INFO,
+							"Link %lu holds atom %lu, which is not in "
+							"the database", atom->getHandle().value(),
+							h.value());
 					load_recursive_if_not_exists(a);
 				}
 			}
 			table->add(atom, true);
 		}
 
-		std::vector<Handle> *hvec;
-		bool fetch_incoming_set_cb(void)
+		// Decode the atoms, but leave it to the caller to add them to
+		// the table.  If the table is set, the atoms it already holds
+		// are skipped, so as not to clobber their truth values.
+		std::vector<AtomPtr> *atoms;
+		bool decode_atom_cb(void)
 		{
-			// printf ("---- New atom found ----\n");
 			rs->foreach_column(&Response::create_atom_column_cb, this);
 
-			// Note, unlike the above 'load' routines, this merely fetches
-			// the atoms, and returns a vector of them.  They are loaded
-			// into the atomspace later, by the caller.
-			Handle h(store->makeAtom(*this, handle));
-			hvec->push_back(h);
+			if (table and table->holds(handle)) return false;
+			atoms->push_back(store->makeAtom(*this, handle));
 			return false;
 		}
 
@@ -422,6 +439,22 @@ void AtomStorage::init(const char * dbname,
 	}
 
 	local_id_cache_is_inited = false;
+
+	// Batches of a few thousand rows amortize the round-trip and the
+	// commit well; larger ones just make the statement strings big.
+#define DEFAULT_BATCH_SIZE 2000
+#define DEFAULT_FLUSH_INTERVAL_MS 500
+	_batch_size = DEFAULT_BATCH_SIZE;
+	_flush_interval = std::chrono::milliseconds(DEFAULT_FLUSH_INTERVAL_MS);
+	_num_batches = 0;
+	_num_batch_rows = 0;
+	_batch_usec = 0;
+	_max_batch_usec = 0;
+	_num_dropped_rows = 0;
+	_stored_hand = 0;
+	_flush_stop = false;
+	_flush_thread = std::thread(&AtomStorage::flush_loop, this);
+
 	if (!connected()) return;
 
 	reserve();
@@ -445,8 +478,18 @@ AtomStorage::AtomStorage(const std::string& dbname,
 
 AtomStorage::~AtomStorage()
 {
+	{
+		std::lock_guard<std::mutex> lck(_batch_mutex);
+		_flush_stop = true;
+		_flush_cv.notify_all();
+	}
+	_flush_thread.join();
+
 	if (connected())
+	{
+		flushStoreQueue();
 		setMaxHeight(getMaxObservedHeight());
+	}
 
 	while (not conn_pool.is_empty())
 	{
@@ -659,9 +702,42 @@ std::string AtomStorage::oset_to_string(const std::vector<Handle>& out,
 	return str;
 }
 
+std::string AtomStorage::tv_to_string(const TruthValuePtr& tv)
+{
+	TruthValueType tvt = NULL_TRUTH_VALUE;
+	if (tv) tvt = tv->getType();
+
+	// The casts give the columns a type, even when the first row of
+	// an UPDATE ... FROM (VALUES ...) is all NULLs.
+	char buff[BUFSZ];
+	switch (tvt)
+	{
+		case NULL_TRUTH_VALUE:
+			snprintf(buff, BUFSZ,
+			         "%u, NULL::FLOAT, NULL::FLOAT, NULL::FLOAT", tvt);
+			break;
+		case SIMPLE_TRUTH_VALUE:
+		case COUNT_TRUTH_VALUE:
+			snprintf(buff, BUFSZ, "%u, %12.8g, %12.8g, %12.8g", tvt,
+			         tv->getMean(), tv->getConfidence(), tv->getCount());
+			break;
+		case INDEFINITE_TRUTH_VALUE:
+		{
+			IndefiniteTruthValuePtr itv = std::static_pointer_cast<IndefiniteTruthValue>(tv);
+			snprintf(buff, BUFSZ, "%u, %12.8g, %12.8g, %12.8g", tvt,
+			         itv->getL(), itv->getConfidenceLevel(), itv->getU());
+			break;
+		}
+		default:
+			throw RuntimeException(TRACE_INFO,
+				"Error: store_single: Unknown truth value type\n");
+	}
+	return buff;
+}
+
 /* ================================================================ */
 
-/// Drain the pending store queue.
+/// Drain the pending store queue, and write out the batch.
 /// Caution: this is slightly racy; a writer could still be busy
 /// even though this returns. (There's a window in writeLoop, between
 /// the dequeue, and the busy_writer increment. I guess we should fix
@@ -669,14 +745,463 @@ std::string AtomStorage::oset_to_string(const std::vector<Handle>& out,
 void AtomStorage::flushStoreQueue()
 {
 	_write_queue.flush_queue();
+	flush_batch();
+}
+
+/* ================================================================ */
+/**
+ * Add a row to the current batch.  An atom that is stored a second
+ * time, before the first store was written, is written just once,
+ * with the latest truth value.  Returns true if the batch is full.
+ */
+bool AtomStorage::queue_row(UUID uuid, bool update, Row& row)
+{
+	std::lock_guard<std::mutex> lck(_batch_mutex);
+	if (_batch_inserts.empty() and _batch_updates.empty())
+	{
+		_batch_oldest = std::chrono::steady_clock::now();
+		_flush_cv.notify_all();
+	}
+
+	if (not update)
+		_batch_inserts[uuid] = std::move(row);
+	else
+	{
+		auto it = _batch_inserts.find(uuid);
+		if (it != _batch_inserts.end())
+		{
+			it->second.tv = std::move(row.tv);
+			it->second.value = std::move(row.value);
+		}
+		else
+			_batch_updates[uuid] = std::move(row);
+	}
+	return _batch_size <= _batch_inserts.size() + _batch_updates.size();
+}
+
+/**
+ * Put the rows of a batch that failed back into the current batch, so
+ * that they are written with the next one.  A row that was queued
+ * again in the meantime holds the newer truth value, and wins.
+ */
+void AtomStorage::requeue_batch(std::map<UUID, Row>& inserts,
+                                std::map<UUID, Row>& updates)
+{
+	std::lock_guard<std::mutex> lck(_batch_mutex);
+	for (auto& pr : inserts)
+	{
+		// The atom was in the id cache, so any later store of it
+		// went into the updates.
+		auto it = _batch_updates.find(pr.first);
+		if (it != _batch_updates.end())
+		{
+			pr.second.tv = std::move(it->second.tv);
+			pr.second.value = std::move(it->second.value);
+			_batch_updates.erase(it);
+		}
+		_batch_inserts.emplace(pr.first, std::move(pr.second));
+	}
+	for (auto& pr : updates)
+		_batch_updates.emplace(pr.first, std::move(pr.second));
+
+	// Wait a whole flush interval before trying again.
+	_batch_oldest = std::chrono::steady_clock::now();
+}
+
+/**
+ * Write out the given rows, in one transaction.  The new atoms go in
+ * with a single multi-row INSERT, and the new truth values of the old
+ * atoms with a single UPDATE ... FROM (VALUES ...).  If any of it
+ * fails, the transaction is rolled back, and the exception is passed
+ * on.
+ */
+void AtomStorage::write_rows(const std::map<UUID, Row>& inserts,
+                             const std::map<UUID, Row>& updates)
+{
+	// Rolls back the transaction, unless it was committed, and puts
+	// the connection back into the pool, even if something threw.
+	class Transaction
+	{
+		AtomStorage* _store;
+	public:
+		ODBCConnection* db_conn;
+		bool committed;
+		Transaction(AtomStorage* store) :
+			_store(store), db_conn(store->get_conn()), committed(false) {}
+		~Transaction()
+		{
+			if (not committed)
+			{
+				try
+				{
+					ODBCRecordSet* rs = db_conn->exec("ROLLBACK;");
+					if (rs) rs->release();
+				}
+				catch (...) {}
+			}
+			_store->put_conn(db_conn);
+		}
+	};
+
+	Transaction txn(this);
+	ODBCConnection* db_conn = txn.db_conn;
+	Response rp;
+	rp.rs = db_conn->exec("BEGIN;");
+	if (rp.rs) rp.rs->release();
+
+	if (0 < inserts.size())
+	{
+		std::string qry = "INSERT INTO Atoms (uuid, space, type, height, "
+		                  "name, outgoing, tv_type, stv_mean, "
+		                  "stv_confidence, stv_count) VALUES ";
+		bool notfirst = false;
+		for (const auto& pr : inserts)
+		{
+			if (notfirst) qry += ", "; else notfirst = true;
+			qry += "(";
+			qry += pr.second.head;
+			qry += ", ";
+			qry += pr.second.tv;
+			qry += ")";
+		}
+		qry += ";";
+		rp.rs = db_conn->exec(qry.c_str());
+		if (rp.rs) rp.rs->release();
+	}
+
+	if (0 < updates.size())
+	{
+		std::string qry = "UPDATE Atoms SET tv_type = v.tv_type, "
+		                  "stv_mean = v.stv_mean, "
+		                  "stv_confidence = v.stv_confidence, "
+		                  "stv_count = v.stv_count FROM (VALUES ";
+		bool notfirst = false;
+		for (const auto& pr : updates)
+		{
+			if (notfirst) qry += ", "; else notfirst = true;
+			char buff[BUFSZ];
+			snprintf(buff, BUFSZ, "(%lu, ", pr.first);
+			qry += buff;
+			qry += pr.second.tv;
+			qry += ")";
+		}
+		qry += ") AS v (uuid, tv_type, stv_mean, stv_confidence, stv_count) "
+		       "WHERE Atoms.uuid = v.uuid;";
+		rp.rs = db_conn->exec(qry.c_str());
+		if (rp.rs) rp.rs->release();
+	}
+
+	rp.rs = db_conn->exec("COMMIT;");
+	if (rp.rs) rp.rs->release();
+	txn.committed = true;
+}
+
+/// Return true if the database answers a trivial query.
+bool AtomStorage::db_answers(void)
+{
+	ODBCConnection* db_conn = get_conn();
+	bool ok = true;
+	try
+	{
+		ODBCRecordSet* rs = db_conn->exec("SELECT 1;");
+		if (rs) rs->release();
+	}
+	catch (...)
+	{
+		ok = false;
+	}
+	put_conn(db_conn);
+	return ok;
+}
+
+/**
+ * Write the rows of a batch that failed one at a time, so that one
+ * bad row (a UUID that is taken, say, or a name that breaks the
+ * quoting) can't hold up all the others.  Each row is removed from
+ * the maps once it is written.  A row that fails on its own, while
+ * the database still answers, is reported and dropped.  If the
+ * database stops answering, this returns false, and the rows not yet
+ * written are left in the maps.
+ */
+bool AtomStorage::write_singly(std::map<UUID, Row>& inserts,
+                               std::map<UUID, Row>& updates)
+{
+	static const std::map<UUID, Row> none;
+
+	// The inserts go first, as in a whole batch.
+	for (std::map<UUID, Row>* rows : {&inserts, &updates})
+	{
+		bool insert = (rows == &inserts);
+		while (not rows->empty())
+		{
+			std::map<UUID, Row> one;
+			auto it = rows->begin();
+			UUID uuid = it->first;
+			one.emplace(uuid, std::move(it->second));
+			rows->erase(it);
+
+			std::string what;
+			try
+			{
+				if (insert) write_rows(one, none);
+				else write_rows(none, one);
+			}
+			catch (const std::exception& ex)
+			{
+				what = ex.what();
+				if (what.empty()) what = "unknown error";
+			}
+			catch (...)
+			{
+				what = "unknown error";
+			}
+
+			if (what.empty())
+			{
+				std::lock_guard<std::mutex> lck(_batch_mutex);
+				remember_tv(uuid, one.begin()->second.value);
+				_num_batch_rows ++;
+				continue;
+			}
+
+			if (not db_answers())
+			{
+				rows->emplace(uuid, std::move(one.begin()->second));
+				return false;
+			}
+
+			logger().warn("AtomStorage::flush_batch: dropped the %s of "
+			              "atom %lu: %s", insert ? "insert" : "update",
+			              uuid, what.c_str());
+			_num_dropped_rows ++;
+
+			// The atom isn't in the database after all; a later
+			// store tries the insert again.
+			if (insert)
+			{
+				std::lock_guard<std::mutex> lck(id_cache_mutex);
+				local_id_cache.erase(uuid);
+			}
+		}
+	}
+	return true;
+}
+
+/**
+ * Write out the current batch, in one transaction; see write_rows().
+ * If that fails, the rows are tried one at a time, and those that
+ * still fail are dropped; see write_singly().  If the database stops
+ * answering, the rows not yet written go back into the batch, and
+ * the exception is passed on.
+ */
+void AtomStorage::flush_batch(void)
+{
+	std::lock_guard<std::mutex> flck(_flush_mutex);
+
+	std::map<UUID, Row> inserts;
+	std::map<UUID, Row> updates;
+	{
+		std::lock_guard<std::mutex> lck(_batch_mutex);
+		inserts.swap(_batch_inserts);
+		updates.swap(_batch_updates);
+	}
+	size_t nrows = inserts.size() + updates.size();
+	if (0 == nrows) return;
+
+	auto start = std::chrono::steady_clock::now();
+	try
+	{
+		write_rows(inserts, updates);
+	}
+	catch (...)
+	{
+		if (write_singly(inserts, updates)) return;
+		requeue_batch(inserts, updates);
+		throw;
+	}
+
+	// Only now does the database hold these truth values.
+	{
+		std::lock_guard<std::mutex> lck(_batch_mutex);
+		for (const auto& pr : inserts)
+			remember_tv(pr.first, pr.second.value);
+		for (const auto& pr : updates)
+			remember_tv(pr.first, pr.second.value);
+	}
+
+	unsigned long usec = std::chrono::duration_cast<std::chrono::microseconds>(
+		std::chrono::steady_clock::now() - start).count();
+	_num_batches ++;
+	_num_batch_rows += nrows;
+	_batch_usec += usec;
+	unsigned long prev = _max_batch_usec;
+	while (prev < usec and not _max_batch_usec.compare_exchange_weak(prev, usec));
+}
+
+static bool same_tv(const TruthValuePtr& a, const TruthValuePtr& b)
+{
+	if (a == b) return true;
+	if (NULL == a or NULL == b) return false;
+	return *a == *b;
+}
+
+/// Return true if the truth value differs from the one last written,
+/// or from the one waiting in the batch to be written, or if neither
+/// is known.
+bool AtomStorage::tv_changed(UUID uuid, const TruthValuePtr& tv)
+{
+	std::lock_guard<std::mutex> lck(_batch_mutex);
+	auto up = _batch_updates.find(uuid);
+	if (up != _batch_updates.end())
+		return not same_tv(up->second.value, tv);
+
+	auto in = _batch_inserts.find(uuid);
+	if (in != _batch_inserts.end())
+		return not same_tv(in->second.value, tv);
+
+	auto it = _stored_index.find(uuid);
+	if (it == _stored_index.end()) return true;
+	StoredTV& stv = _stored_tvs[it->second];
+	stv.used = true;
+	return not same_tv(stv.tv, tv);
+}
+
+/// Record the truth value that the database holds for the atom.
+void AtomStorage::note_stored_tv(UUID uuid, const TruthValuePtr& tv)
+{
+	std::lock_guard<std::mutex> lck(_batch_mutex);
+	remember_tv(uuid, tv);
+}
+
+/// The caller must hold the batch mutex.
+void AtomStorage::remember_tv(UUID uuid, const TruthValuePtr& tv)
+{
+	auto it = _stored_index.find(uuid);
+	if (it != _stored_index.end())
+	{
+		StoredTV& stv = _stored_tvs[it->second];
+		stv.tv = tv;
+		stv.used = true;
+		return;
+	}
+
+	// A few million entries are some hundreds of megabytes; past
+	// that, an entry that wasn't used since the hand last went by
+	// makes room, rather than keep a copy of the database.
+#define MAX_STORED_TVS 2000000
+	if (_stored_tvs.size() < MAX_STORED_TVS)
+	{
+		_stored_index[uuid] = _stored_tvs.size();
+		_stored_tvs.push_back({uuid, tv, false});
+		return;
+	}
+
+	while (_stored_tvs[_stored_hand].used)
+	{
+		_stored_tvs[_stored_hand].used = false;
+		_stored_hand = (_stored_hand + 1) % _stored_tvs.size();
+	}
+	StoredTV& stv = _stored_tvs[_stored_hand];
+	_stored_index.erase(stv.uuid);
+	_stored_index[uuid] = _stored_hand;
+	stv = {uuid, tv, false};
+	_stored_hand = (_stored_hand + 1) % _stored_tvs.size();
+}
+
+/// Write out any batch whose oldest row has waited for longer than
+/// the flush interval.  A batch that can't be written, because the
+/// database doesn't answer, is reported, and tried again after another
+/// interval.
+void AtomStorage::flush_loop(void)
+{
+	std::unique_lock<std::mutex> lck(_batch_mutex);
+	while (not _flush_stop)
+	{
+		bool empty = _batch_inserts.empty() and _batch_updates.empty();
+		if (empty or std::chrono::milliseconds::zero() == _flush_interval)
+		{
+			_flush_cv.wait(lck);
+			continue;
+		}
+
+		auto due = _batch_oldest + _flush_interval;
+		if (std::chrono::steady_clock::now() < due)
+		{
+			_flush_cv.wait_until(lck, due);
+			continue;
+		}
+
+		lck.unlock();
+		try
+		{
+			flush_batch();
+		}
+		catch (const std::exception& ex)
+		{
+			logger().warn("AtomStorage::flush_loop: batch not written: %s",
+			              ex.what());
+		}
+		catch (...)
+		{
+			logger().warn("AtomStorage::flush_loop: batch not written");
+		}
+		lck.lock();
+	}
+}
+
+void AtomStorage::setBatchSize(size_t sz)
+{
+	bool full = false;
+	{
+		std::lock_guard<std::mutex> lck(_batch_mutex);
+		_batch_size = (0 < sz) ? sz : 1;
+		full = _batch_size <= _batch_inserts.size() + _batch_updates.size();
+	}
+	if (full) flush_batch();
+}
+
+void AtomStorage::setFlushInterval(double secs)
+{
+	std::lock_guard<std::mutex> lck(_batch_mutex);
+	if (secs < 0.0) secs = 0.0;
+	_flush_interval = std::chrono::milliseconds((long) (1000.0 * secs));
+	_flush_cv.notify_all();
+}
+
+unsigned long AtomStorage::getNumRowsWritten(void)
+{
+	return _num_batch_rows;
+}
+
+unsigned long AtomStorage::getNumRowsDropped(void)
+{
+	return _num_dropped_rows;
+}
+
+void AtomStorage::print_stats(void)
+{
+	unsigned long nb = _num_batches;
+	unsigned long nr = _num_batch_rows;
+	unsigned long us = _batch_usec;
+	printf("sql-stats: batch size=%zu flush interval=%ld msecs\n",
+	       _batch_size, (long) _flush_interval.count());
+	printf("sql-stats: wrote %lu rows in %lu batches\n", nr, nb);
+	if (0 < _num_dropped_rows)
+		printf("sql-stats: dropped %lu rows that failed\n",
+		       (unsigned long) _num_dropped_rows);
+	if (0 < nb)
+		printf("sql-stats: batch latency avg=%lu max=%lu usecs, "
+		       "avg rows/batch=%lu\n",
+		       us / nb, (unsigned long) _max_batch_usec, nr / nb);
 }
 
 /* ================================================================ */
 /**
  * Recursively store the indicated atom, and all that it points to.
- * Store its truth values too. The recursive store is unconditional;
- * its assumed that all sorts of underlying truuth values have changed, 
- * so that the whole thing needs to be stored.
+ * Store its truth values too. The recursion is unconditional; its
+ * assumed that all sorts of underlying truuth values may have changed.
+ * However, only the atoms that are new to the database, or whose truth
+ * value changed since it was last written, are actually written.
  *
  * By default, the actual store is done asynchronously (in a different
  * thread); this routine merely queues up the atom. If the synchronous
@@ -690,6 +1215,7 @@ void AtomStorage::storeAtom(AtomPtr atom, bool synchronous)
 	if (synchronous)
 	{
 		do_store_atom(atom);
+		flush_batch();
 		return;
 	}
 	_write_queue.enqueue(atom);
@@ -702,10 +1228,21 @@ void AtomStorage::storeAtom(AtomPtr atom, bool synchronous)
  */
 int AtomStorage::do_store_atom(AtomPtr atom)
 {
+	StoreSession session;
+	return do_store_atom(atom, session);
+}
+
+int AtomStorage::do_store_atom(AtomPtr atom, StoreSession& session)
+{
+	UUID uuid = atom->getHandle().value();
+	auto seen = session.find(uuid);
+	if (seen != session.end()) return seen->second;
+
 	LinkPtr l(LinkCast(atom));
 	if (NULL == l)
 	{
 		do_store_single_atom(atom, 0);
+		session[uuid] = 0;
 		return 0;
 	}
 
@@ -715,7 +1252,7 @@ int AtomStorage::do_store_atom(AtomPtr atom)
 	for (int i=0; i<arity; i++)
 	{
 		// Recurse.
-		int heig = do_store_atom(out[i]);
+		int heig = do_store_atom(out[i], session);
 		if (lheight < heig) lheight = heig;
 	}
 
@@ -723,6 +1260,7 @@ int AtomStorage::do_store_atom(AtomPtr atom)
 	// atom in outgoing set.
 	lheight ++;
 	do_store_single_atom(atom, lheight);
+	session[uuid] = lheight;
 	return lheight;
 }
 
@@ -740,19 +1278,20 @@ void AtomStorage::vdo_store_atom(AtomPtr& atom)
 void AtomStorage::storeSingleAtom(AtomPtr atom)
 {
 	get_ids();
-	int height = get_height(atom);
-	do_store_single_atom(atom, height);
+	do_store_single_atom(atom, -1);
+	flush_batch();
 }
 
-void AtomStorage::do_store_single_atom(AtomPtr atom, int aheight)
+/**
+ * Queue up the row for the atom, if it is new to the database, or if
+ * its truth value changed since it was last written.  A height of -1
+ * means that it is not yet known; it is only needed for new atoms.
+ * Returns true if a row was queued.
+ */
+bool AtomStorage::do_store_single_atom(AtomPtr atom, int aheight)
 {
 	setup_typemap();
 
-	int notfirst = 0;
-	std::string cols;
-	std::string vals;
-	std::string coda;
-
 	// Use the TLB Handle as the UUID.
 	char uuidbuff[BUFSZ];
 	Handle h(atom->getHandle());
@@ -760,26 +1299,23 @@ void AtomStorage::do_store_single_atom(AtomPtr atom, int aheight)
 		throw RuntimeException(TRACE_INFO, "Trying to save atom with an invalid handle!");
 
 	UUID uuid = h.value();
-	snprintf(uuidbuff, BUFSZ, "%lu", uuid);
 
 	std::unique_lock<std::mutex> lck = maybe_create_id(uuid);
 	bool update = not lck.owns_lock();
-	if (update)
-	{
-		cols = "UPDATE Atoms SET ";
-		vals = "";
-		coda = " WHERE uuid = ";
-		coda += uuidbuff;
-		coda += ";";
-	}
-	else
-	{
-		cols = "INSERT INTO Atoms (";
-		vals = ") VALUES (";
-		coda = ");";
 
-		STMT("uuid", uuidbuff);
-	}
+	// The structure of an atom never changes, so an atom that is
+	// already in the database needs writing only if its truth value
+	// changed.
+	TruthValuePtr tv(atom->getTruthValue());
+	if (update and not tv_changed(uuid, tv))
+		return false;
+
+	// The row goes into the current batch; see flush_batch() for the
+	// INSERT and UPDATE statements.  For an update, only the truth
+	// value is written.
+	Row row;
+	row.tv = tv_to_string(tv);
+	row.value = tv;
 
 	// Store the atom type and node name only if storing for the
 	// first time ever. Once an atom is in an atom table, it's
@@ -792,91 +1328,49 @@ void AtomStorage::do_store_single_atom(AtomPtr atom, int aheight)
 		AtomTable * at = atom->getAtomTable();
 		// We allow storage of atoms that don't belong to an atomspace.
 		if (at) asuid = at->get_uuid();
-		snprintf(uuidbuff, BUFSZ, "%lu", asuid);
-		STMT("space", uuidbuff);
 
 		// Store the atom UUID
 		Type t = atom->getType();
 		int dbtype = storing_typemap[t];
-		STMTI("type", dbtype);
-	
-		// Store the node name, if its a node
+
+		// Nodes have a height of zero by definition.
+		int height = 0;
 		NodePtr n(NodeCast(atom));
+		if (NULL == n)
+		{
+			if (aheight < 0) aheight = get_height(atom);
+			if (max_height < aheight) max_height = aheight;
+			height = aheight;
+		}
+
+		snprintf(uuidbuff, BUFSZ, "%lu, %lu, %d, %d, ",
+		         uuid, asuid, dbtype, height);
+		row.head = uuidbuff;
+
+		// Store the node name, if its a node
 		if (n)
 		{
-#if 0
-			std::string qname = n->getName();
-			escape_single_quotes(qname);
-			qname.insert(0U,1U,'\'');
-			qname += "'";
-#else
 			// Use postgres $-quoting to make unicode strings
-			// easier to deal with. 
-			std::string qname = " $ocp$";
-			qname += n->getName();
-			qname += "$ocp$ ";
-#endif
-			STMT("name", qname);
-
-			// Nodes have a height of zero by definition.
-			STMTI("height", 0);
+			// easier to deal with.
+			row.head += " $ocp$";
+			row.head += n->getName();
+			row.head += "$ocp$ , NULL";
 		}
 		else
 		{
-			if (max_height < aheight) max_height = aheight;
-			STMTI("height", aheight);
-
-#ifdef USE_INLINE_EDGES
+			row.head += "NULL, ";
 			LinkPtr l(LinkCast(atom));
-			if (l)
-			{
-				int arity = l->getArity();
-				if (arity)
-				{
-					cols += ", outgoing";
-					vals += ", ";
-					vals += oset_to_string(l->getOutgoingSet(), arity);
-				}
-			}
+			int arity = l->getArity();
+#ifdef USE_INLINE_EDGES
+			if (arity)
+				row.head += oset_to_string(l->getOutgoingSet(), arity);
+			else
 #endif /* USE_INLINE_EDGES */
+				row.head += "NULL";
 		}
 	}
 
-	// Store the truth value
-	TruthValuePtr tv(atom->getTruthValue());
-	TruthValueType tvt = NULL_TRUTH_VALUE;
-	if (tv) tvt = tv->getType();
-	STMTI("tv_type", tvt);
-
-	switch (tvt)
-	{
-		case NULL_TRUTH_VALUE:
-			break;
-		case SIMPLE_TRUTH_VALUE:
-		case COUNT_TRUTH_VALUE:
-			STMTF("stv_mean", tv->getMean());
-			STMTF("stv_confidence", tv->getConfidence());
-			STMTF("stv_count", tv->getCount());
-			break;
-		case INDEFINITE_TRUTH_VALUE:
-		{
-			IndefiniteTruthValuePtr itv = std::static_pointer_cast<IndefiniteTruthValue>(tv);
-			STMTF("stv_mean", itv->getL());
-			STMTF("stv_count", itv->getU());
-			STMTF("stv_confidence", itv->getConfidenceLevel());
-			break;
-		}
-		default:
-			throw RuntimeException(TRACE_INFO,
-				"Error: store_single: Unknown truth value type\n");
-	}
-
-	std::string qry = cols + vals + coda;
-	ODBCConnection* db_conn = get_conn();
-	Response rp;
-	rp.rs = db_conn->exec(qry.c_str());
-	rp.rs->release();
-	put_conn(db_conn);
+	bool full = queue_row(uuid, update, row);
 
 #ifndef USE_INLINE_EDGES
 	// Store the outgoing handles only if we are storing for the first
@@ -888,8 +1382,14 @@ void AtomStorage::do_store_single_atom(AtomPtr atom, int aheight)
 	}
 #endif /* USE_INLINE_EDGES */
 
-	// Make note of the fact that this atom has been stored.
+	// Make note of the fact that this atom has been stored.  It may
+	// still be waiting in the batch; flushStoreQueue() writes it out.
 	add_id_to_cache(uuid);
+
+	// Don't make the other writers wait on the database.
+	if (lck.owns_lock()) lck.unlock();
+	if (full) flush_batch();
+	return true;
 }
 
 /* ================================================================ */
@@ -1144,28 +1644,62 @@ void AtomStorage::getOutgoing(std::vector<Handle> &outv, Handle h)
 
 /* ================================================================ */
 
-/* One-size-fits-all atom fetcher */
-AtomPtr  AtomStorage::getAtom(const char * query, int height)
+/*
+ * The hot fetches are prepared statements, so that the server parses
+ * and plans them once per connection, instead of once per call, and
+ * so that the numeric columns come back in binary.  They all return
+ * these columns, in this order; see Response::decode_statement_row().
+ */
+#define ATOM_COLUMNS "uuid, type, tv_type, stv_mean, stv_confidence, " \
+                     "stv_count, name, outgoing"
+
+static const std::vector<ODBCConnection::ColType> atom_column_types = {
+	ODBCConnection::INTEGER, ODBCConnection::INTEGER,
+	ODBCConnection::INTEGER, ODBCConnection::DOUBLE,
+	ODBCConnection::DOUBLE, ODBCConnection::DOUBLE,
+	ODBCConnection::TEXT, ODBCConnection::TEXT,
+};
+
+#define GET_ATOM_BY_UUID \
+	"SELECT " ATOM_COLUMNS " FROM Atoms WHERE uuid = ?;"
+
+// Note: "select * from atoms where outgoing@>array[556];" will return
+// all links with atom 556 in the outgoing set -- i.e. the incoming set of 556.
+// Could also use && here instead of @> Don't know if one is faster or not.
+// The cast to BIGINT is needed, as otherwise on gets
+// ERROR:  operator does not exist: bigint[] @> integer[]
+#define GET_INCOMING_SET \
+	"SELECT " ATOM_COLUMNS " FROM Atoms " \
+	"WHERE outgoing @> ARRAY[CAST(? AS BIGINT)];"
+
+// The name is passed as a parameter, and so needs no quoting.
+#define GET_NODE \
+	"SELECT " ATOM_COLUMNS " FROM Atoms WHERE type = ? AND name = ?;"
+
+// There is no ODBC type for arrays; the outgoing set is passed as
+// the text of one, e.g. {1, 2, 3}
+#define GET_LINK \
+	"SELECT " ATOM_COLUMNS " FROM Atoms " \
+	"WHERE type = ? AND outgoing = CAST(? AS BIGINT[]);"
+
+/* One-size-fits-all atom fetcher.  The parameters of the statement
+ * must have been set already. */
+AtomPtr  AtomStorage::getAtom(ODBCStatement * st, int height)
 {
-	ODBCConnection* db_conn = get_conn();
-	Response rp;
-	rp.handle = Handle::UNDEFINED;
-	rp.rs = db_conn->exec(query);
-	rp.rs->foreach_row(&Response::create_atom_cb, &rp);
+	if (NULL == st or not st->execute()) return NULL;
 
 	// Did we actually find anything?
-	// DO NOT USE TLB::IsInvalidHandle() HERE! It won't work, duhh!
-	if (rp.handle.value() == Handle::UNDEFINED.value())
+	if (0 == st->fetch_row())
 	{
-		rp.rs->release();
-		put_conn(db_conn);
+		st->close();
 		return NULL;
 	}
 
+	Response rp;
+	rp.decode_statement_row(st);
 	rp.height = height;
 	AtomPtr atom(makeAtom(rp, rp.handle));
-	rp.rs->release();
-	put_conn(db_conn);
+	st->close();
 	return atom;
 }
 
@@ -1179,11 +1713,14 @@ AtomPtr  AtomStorage::getAtom(const char * query, int height)
 AtomPtr  AtomStorage::getAtom(Handle h)
 {
 	setup_typemap();
-	char buff[BUFSZ];
-	UUID uuid = h.value();
-	snprintf(buff, BUFSZ, "SELECT * FROM Atoms WHERE uuid = %lu;", uuid);
 
-	return getAtom(buff, -1);
+	ODBCConnection* db_conn = get_conn();
+	ODBCStatement* st = db_conn->prepare(GET_ATOM_BY_UUID, 1,
+	                                     atom_column_types);
+	if (st) st->set_param(0, (long) h.value());
+	AtomPtr atom(getAtom(st, -1));
+	put_conn(db_conn);
+	return atom;
 }
 
 /**
@@ -1194,25 +1731,32 @@ std::vector<Handle> AtomStorage::getIncomingSet(Handle h)
 	std::vector<Handle> iset;
 
 	setup_typemap();
-	char buff[BUFSZ];
-	UUID uuid = h.value();
-	snprintf(buff, BUFSZ,
-		"SELECT * FROM Atoms WHERE outgoing @> ARRAY[CAST(%lu AS BIGINT)];", uuid);
-
-	// Note: "select * from atoms where outgoing@>array[556];" will return
-	// all links with atom 556 in the outgoing set -- i.e. the incoming set of 556.
-	// Could also use && here instead of @> Don't know if one is faster or not.
-	// The cast to BIGINT is needed, as otherwise on gets
-	// ERROR:  operator does not exist: bigint[] @> integer[]
 
 	ODBCConnection* db_conn = get_conn();
-	Response rp;
-	rp.store = this;
-	rp.height = -1;
-	rp.hvec = &iset;
-	rp.rs = db_conn->exec(buff);
-	rp.rs->foreach_row(&Response::fetch_incoming_set_cb, &rp);
-	rp.rs->release();
+	ODBCStatement* st = db_conn->prepare(GET_INCOMING_SET, 1,
+	                                     atom_column_types);
+	if (NULL == st)
+	{
+		put_conn(db_conn);
+		return iset;
+	}
+
+	st->set_param(0, (long) h.value());
+	if (st->execute())
+	{
+		// Note, unlike the 'load' routines, this merely fetches the
+		// atoms, and returns a vector of them.  They are loaded into
+		// the atomspace later, by the caller.
+		Response rp;
+		rp.height = -1;
+		while (st->fetch_row())
+		{
+			rp.decode_statement_row(st);
+			Handle hi(makeAtom(rp, rp.handle));
+			iset.push_back(hi);
+		}
+		st->close();
+	}
 	put_conn(db_conn);
 
 	return iset;
@@ -1231,21 +1775,17 @@ std::vector<Handle> AtomStorage::getIncomingSet(Handle h)
 NodePtr AtomStorage::getNode(Type t, const char * str)
 {
 	setup_typemap();
-	char buff[40*BUFSZ];
-
-	// Use postgres $-quoting to make unicode strings easier to deal with. 
-	int nc = snprintf(buff, 4*BUFSZ, "SELECT * FROM Atoms WHERE "
-	    "type = %hu AND name = $ocp$%s$ocp$ ;", storing_typemap[t], str);
 
-	if (40*BUFSZ-1 <= nc)
+	ODBCConnection* db_conn = get_conn();
+	ODBCStatement* st = db_conn->prepare(GET_NODE, 2, atom_column_types);
+	if (st)
 	{
-		fprintf(stderr, "Error: AtomStorage::getNode: buffer overflow!\n");
-		buff[40*BUFSZ-1] = 0x0;
-		fprintf(stderr, "\tnc=%d buffer=>>%s<<\n", nc, buff);
-		return NULL;
+		st->set_param(0, (long) storing_typemap[t]);
+		st->set_param(1, std::string(str));
 	}
-
-	return NodeCast(getAtom(buff, 0));
+	AtomPtr atom(getAtom(st, 0));
+	put_conn(db_conn);
+	return NodeCast(atom);
 }
 
 /**
@@ -1262,16 +1802,20 @@ LinkPtr AtomStorage::getLink(Type t, const std::vector<Handle>&oset)
 {
 	setup_typemap();
 
-	char buff[BUFSZ];
-	snprintf(buff, BUFSZ, 
-	    "SELECT * FROM Atoms WHERE type = %hu AND outgoing = ",
-	    storing_typemap[t]);
-
-	std::string ostr = buff;
-	ostr += oset_to_string(oset, oset.size());
-	ostr += ";";
+	// oset_to_string() quotes the array, for pasting into a query;
+	// as a parameter, it must go without the quotes.
+	std::string ostr = oset_to_string(oset, oset.size());
+	ostr = ostr.substr(1, ostr.size() - 2);
 
-	AtomPtr atom = getAtom(ostr.c_str(), 1);
+	ODBCConnection* db_conn = get_conn();
+	ODBCStatement* st = db_conn->prepare(GET_LINK, 2, atom_column_types);
+	if (st)
+	{
+		st->set_param(0, (long) storing_typemap[t]);
+		st->set_param(1, ostr);
+	}
+	AtomPtr atom(getAtom(st, 1));
+	put_conn(db_conn);
 	return LinkCast(atom);
 }
 
@@ -1373,6 +1917,10 @@ AtomPtr AtomStorage::makeAtom(Response &rp, Handle h)
 				"Error: makeAtom: Unknown truth value type\n");
 	}
 
+	// A later store need not write it again, unless it changes.
+	if (NULL_TRUTH_VALUE != rp.tv_type)
+		note_stored_tv(h.value(), atom->getTruthValue());
+
 	load_count ++;
 	if (load_count%10000 == 0)
 	{
@@ -1385,6 +1933,155 @@ AtomPtr AtomStorage::makeAtom(Response &rp, Handle h)
 
 /* ================================================================ */
 
+static double per_second(unsigned long n,
+                         std::chrono::steady_clock::time_point start)
+{
+	std::chrono::duration<double> secs =
+		std::chrono::steady_clock::now() - start;
+	if (secs.count() <= 0.0) return 0.0;
+	return n / secs.count();
+}
+
+// It appears that, when the select statment returns more than
+// about a 100K to a million atoms or so, some sort of heap
+// corruption occurs in the iodbc code, causing future mallocs
+// to fail. So limit the number of records processed in one go.
+// It also appears that asking for lots of records increases
+// the memory fragmentation (and/or there's a memory leak in iodbc??)
+// XXX Not clear is UnixODBC suffers from this same problem.
+#define STEP 12003
+
+// Fewer than DEFAULT_NUM_CONNS, so that the writers, and getAtom(),
+// can still get a connection while a load is running.
+#define NUM_LOAD_THREADS 4
+
+// Decoded ranges waiting to be added to the table.
+#define MAX_LOAD_BACKLOG 16
+
+/**
+ * Load all of the atoms of the given height, whose rows match the
+ * where-clause (which must be empty, or end with AND).
+ *
+ * Several threads, each with its own connection, fetch UUID ranges
+ * at the same time, and decode the rows into atoms.  The calling
+ * thread adds the atoms to the table, a range at a time, as they
+ * arrive.  All of them are in the table when this returns; the links
+ * of the next height up can then find their outgoing sets.
+ *
+ * If only_new is set, the atoms that are already in the table are
+ * left alone, and the outgoing sets of the new ones are fetched if
+ * they are not in the table yet.
+ */
+void AtomStorage::load_height(AtomTable &table, int hei,
+                              const std::string& where,
+                              unsigned long max_nrec, bool only_new)
+{
+	size_t nranges = max_nrec / STEP + 1;
+	std::atomic<size_t> next_range(0);
+
+	std::mutex mtx;
+	std::condition_variable cv;
+	std::deque<std::vector<AtomPtr>> ready;
+	int running = NUM_LOAD_THREADS;
+	bool stop = false;
+	std::exception_ptr error;
+
+	auto fetch = [&](void)
+	{
+		try
+		{
+			while (true)
+			{
+				size_t r = next_range++;
+				if (nranges <= r) break;
+
+				unsigned long rec = r * STEP;
+				char buff[BUFSZ];
+				snprintf(buff, BUFSZ, "SELECT * FROM Atoms WHERE %s"
+				        "height = %d AND uuid > %lu AND uuid <= %lu;",
+				         where.c_str(), hei, rec, rec+STEP);
+
+				std::vector<AtomPtr> atoms;
+				Response rp;
+				rp.store = this;
+				rp.table = only_new ? &table : NULL;
+				rp.height = hei;
+				rp.atoms = &atoms;
+
+				ODBCConnection* db_conn = get_conn();
+				rp.rs = db_conn->exec(buff);
+				if (rp.rs)
+				{
+					rp.rs->foreach_row(&Response::decode_atom_cb, &rp);
+					rp.rs->release();
+				}
+				put_conn(db_conn);
+				if (atoms.empty()) continue;
+
+				std::unique_lock<std::mutex> lck(mtx);
+				cv.wait(lck, [&]() {
+					return stop or ready.size() < MAX_LOAD_BACKLOG; });
+				if (stop) break;
+				ready.push_back(std::move(atoms));
+				cv.notify_all();
+			}
+		}
+		catch (...)
+		{
+			std::lock_guard<std::mutex> lck(mtx);
+			if (not error) error = std::current_exception();
+			stop = true;
+		}
+		std::lock_guard<std::mutex> lck(mtx);
+		running--;
+		cv.notify_all();
+	};
+
+	std::vector<std::thread> fetchers;
+	for (int i=0; i<NUM_LOAD_THREADS; i++)
+		fetchers.push_back(std::thread(fetch));
+
+	Response rp;
+	rp.store = this;
+	rp.table = &table;
+	try
+	{
+		while (true)
+		{
+			std::vector<AtomPtr> atoms;
+			{
+				std::unique_lock<std::mutex> lck(mtx);
+				cv.wait(lck, [&]() {
+					return stop or not ready.empty() or 0 == running; });
+				if (stop or ready.empty()) break;
+				atoms.swap(ready.front());
+				ready.pop_front();
+				cv.notify_all();
+			}
+
+			for (const AtomPtr& atom : atoms)
+			{
+				if (only_new)
+					rp.load_recursive_if_not_exists(atom);
+				else
+					table.add(atom, true);
+			}
+		}
+	}
+	catch (...)
+	{
+		std::lock_guard<std::mutex> lck(mtx);
+		if (not error) error = std::current_exception();
+		stop = true;
+		cv.notify_all();
+	}
+
+	for (std::thread& t : fetchers) t.join();
+	if (error) std::rethrow_exception(error);
+}
+
+/* ================================================================ */
+
 void AtomStorage::load(AtomTable &table)
 {
 	unsigned long max_nrec = getMaxObservedUUID();
@@ -1396,14 +2093,18 @@ void AtomStorage::load(AtomTable &table)
 
 	setup_typemap();
 
+#if GET_ONE_BIG_BLOB
 	ODBCConnection* db_conn = get_conn();
 	Response rp;
 	rp.table = &table;
 	rp.store = this;
+#endif
+	auto start = std::chrono::steady_clock::now();
 
 	for (int hei=0; hei<=max_height; hei++)
 	{
 		unsigned long cur = load_count;
+		auto hstart = std::chrono::steady_clock::now();
 
 #if GET_ONE_BIG_BLOB
 		char buff[BUFSZ];
@@ -1413,32 +2114,16 @@ void AtomStorage::load(AtomTable &table)
 		rp.rs->foreach_row(&Response::load_all_atoms_cb, &rp);
 		rp.rs->release();
 #else
-		// It appears that, when the select statment returns more than
-		// about a 100K to a million atoms or so, some sort of heap
-		// corruption occurs in the iodbc code, causing future mallocs
-		// to fail. So limit the number of records processed in one go.
-		// It also appears that asking for lots of records increases
-		// the memory fragmentation (and/or there's a memory leak in iodbc??)
-		// XXX Not clear is UnixODBC suffers from this same problem.
-#define STEP 12003
-		unsigned long rec;
-		for (rec = 0; rec <= max_nrec; rec += STEP)
-		{
-			char buff[BUFSZ];
-			snprintf(buff, BUFSZ, "SELECT * FROM Atoms WHERE "
-			        "height = %d AND uuid > %lu AND uuid <= %lu;",
-			         hei, rec, rec+STEP);
-			rp.height = hei;
-			rp.rs = db_conn->exec(buff);
-			rp.rs->foreach_row(&Response::load_all_atoms_cb, &rp);
-			rp.rs->release();
-		}
+		load_height(table, hei, "", max_nrec, false);
 #endif
-		fprintf(stderr, "Loaded %lu atoms at height %d\n", load_count - cur, hei);
+		fprintf(stderr, "Loaded %lu atoms at height %d (%.0f atoms/sec)\n",
+			load_count - cur, hei, per_second(load_count - cur, hstart));
 	}
+#if GET_ONE_BIG_BLOB
 	put_conn(db_conn);
-	fprintf(stderr, "Finished loading %lu atoms in total\n",
-		(unsigned long) load_count);
+#endif
+	fprintf(stderr, "Finished loading %lu atoms in total (%.0f atoms/sec)\n",
+		(unsigned long) load_count, per_second(load_count, start));
 
 	// synchrnonize!
 	table.barrier();
@@ -1462,14 +2147,18 @@ void AtomStorage::loadType(AtomTable &table, Type atom_type)
 	setup_typemap();
 	int db_atom_type = storing_typemap[atom_type];
 
+#if GET_ONE_BIG_BLOB
 	ODBCConnection* db_conn = get_conn();
 	Response rp;
 	rp.table = &table;
 	rp.store = this;
+#endif
+	auto start = std::chrono::steady_clock::now();
 
 	for (int hei=0; hei<=max_height; hei++)
 	{
 		unsigned long cur = load_count;
+		auto hstart = std::chrono::steady_clock::now();
 
 #if GET_ONE_BIG_BLOB
 		char buff[BUFSZ];
@@ -1481,33 +2170,18 @@ void AtomStorage::loadType(AtomTable &table, Type atom_type)
 		rp.rs->foreach_row(&Response::load_if_not_exists_cb, &rp);
 		rp.rs->release();
 #else
-		// It appears that, when the select statment returns more than
-		// about a 100K to a million atoms or so, some sort of heap
-		// corruption occurs in the iodbc code, causing future mallocs
-		// to fail. So limit the number of records processed in one go.
-		// It also appears that asking for lots of records increases
-		// the memory fragmentation (and/or there's a memory leak in iodbc??)
-		// XXX Not clear is UnixODBC suffers from this same problem.
-#define STEP 12003
-		unsigned long rec;
-		for (rec = 0; rec <= max_nrec; rec += STEP)
-		{
-			char buff[BUFSZ];
-			snprintf(buff, BUFSZ, "SELECT * FROM Atoms WHERE type = %d "
-			        "AND height = %d AND uuid > %lu AND uuid <= %lu;",
-			         db_atom_type, hei, rec, rec+STEP);
-			rp.height = hei;
-			rp.rs = db_conn->exec(buff);
-			rp.rs->foreach_row(&Response::load_if_not_exists_cb, &rp);
-			rp.rs->release();
-		}
+		char where[BUFSZ];
+		snprintf(where, BUFSZ, "type = %d AND ", db_atom_type);
+		load_height(table, hei, where, max_nrec, true);
 #endif
-		logger().debug("AtomStorage::loadType: Loaded %lu atoms of type %d at height %d\n",
-			load_count - cur, db_atom_type, hei);
+		logger().debug("AtomStorage::loadType: Loaded %lu atoms of type %d at height %d (%.0f atoms/sec)\n",
+			load_count - cur, db_atom_type, hei, per_second(load_count - cur, hstart));
 	}
+#if GET_ONE_BIG_BLOB
 	put_conn(db_conn);
-	logger().debug("AtomStorage::loadType: Finished loading %lu atoms in total\n",
-		(unsigned long) load_count);
+#endif
+	logger().debug("AtomStorage::loadType: Finished loading %lu atoms in total (%.0f atoms/sec)\n",
+		(unsigned long) load_count, per_second(load_count, start));
 
 	// Synchronize!
 	table.barrier();
@@ -1515,7 +2189,9 @@ void AtomStorage::loadType(AtomTable &table, Type atom_type)
 
 bool AtomStorage::store_cb(AtomPtr atom)
 {
-	storeSingleAtom(atom);
+	// The rows are batched; store() writes out the last batch.
+	// Atoms that did not change since the last store are skipped.
+	if (not do_store_single_atom(atom, -1)) return false;
 	store_count ++;
 	if (store_count%1000 == 0)
 	{
@@ -1554,6 +2230,7 @@ void AtomStorage::store(const AtomTable &table)
 
 	table.foreachHandleByType(
 	    [&](Handle h)->void { store_cb(h); }, ATOM, true);
+	flush_batch();
 
 #ifndef USE_INLINE_EDGES
 	// Create indexes
@@ -1658,6 +2335,18 @@ void AtomStorage::kill_data(void)
 	rp.rs = db_conn->exec("UPDATE Global SET max_height = 0;");
 	rp.rs->release();
 	put_conn(db_conn);
+
+	// Nothing is stored any more.
+	{
+		std::lock_guard<std::mutex> lck(id_cache_mutex);
+		local_id_cache.clear();
+	}
+	{
+		std::lock_guard<std::mutex> lck(_batch_mutex);
+		_stored_tvs.clear();
+		_stored_index.clear();
+		_stored_hand = 0;
+	}
 }
 
 /* ================================================================ */
@@ -26,9 +26,14 @@
 #define _OPENCOG_PERSITENT_ATOM_STORAGE_H
 
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <map>
 #include <mutex>
 #include <set>
+#include <string>
 #include <thread>
+#include <unordered_map>
 #include <vector>
 
 #include <opencog/util/async_method_caller.h>
@@ -59,18 +64,27 @@ class AtomStorage
 
 		void init(const char *, const char *, const char *);
 		AtomPtr makeAtom (Response &, Handle);
-		AtomPtr getAtom (const char *, int);
+		AtomPtr getAtom (ODBCStatement *, int);
+		void load_height(AtomTable &, int, const std::string&,
+		                 unsigned long, bool);
 
 		int get_height(AtomPtr);
 		int max_height;
 		void setMaxHeight(int);
 		int getMaxHeight(void);
 
+		// The atoms already visited while storing, and their heights.
+		// Shared subterms are stored once per session, not once for
+		// every link that holds them.
+		typedef std::unordered_map<UUID, int> StoreSession;
+
 		int do_store_atom(AtomPtr);
+		int do_store_atom(AtomPtr, StoreSession&);
 		void vdo_store_atom(AtomPtr&);
-		void do_store_single_atom(AtomPtr, int);
+		bool do_store_single_atom(AtomPtr, int);
 
 		std::string oset_to_string(const HandleSeq&, int);
+		std::string tv_to_string(const TruthValuePtr&);
 		void storeOutgoing(AtomPtr, Handle);
 		void getOutgoing(HandleSeq&, Handle);
 		bool store_cb(AtomPtr);
@@ -123,6 +137,69 @@ class AtomStorage
 		// Provider of asynchronous store of atoms.
 		async_caller<AtomStorage, AtomPtr> _write_queue;
 
+		// Rows waiting to be written.  A batch is written with one
+		// multi-row INSERT and one multi-row UPDATE, in a single
+		// transaction.  The head holds the columns that are written
+		// only once, the tv the truth value columns, and value the
+		// truth value they were made from.  Updates have no head.
+		struct Row
+		{
+			std::string head;
+			std::string tv;
+			TruthValuePtr value;
+		};
+		std::mutex _batch_mutex;
+		std::map<UUID, Row> _batch_inserts;
+		std::map<UUID, Row> _batch_updates;
+		std::chrono::steady_clock::time_point _batch_oldest;
+		size_t _batch_size;
+		std::chrono::milliseconds _flush_interval;
+
+		// Only one batch is written at a time, so that an UPDATE can
+		// never reach the database ahead of the INSERT of its atom.
+		std::mutex _flush_mutex;
+		bool queue_row(UUID, bool, Row&);
+		void requeue_batch(std::map<UUID, Row>&, std::map<UUID, Row>&);
+		void write_rows(const std::map<UUID, Row>&,
+		                const std::map<UUID, Row>&);
+		bool write_singly(std::map<UUID, Row>&, std::map<UUID, Row>&);
+		bool db_answers(void);
+		void flush_batch(void);
+
+		// The truth value that the database holds for each atom, as
+		// far as it is known, so that an atom is written again only
+		// if it changed.  It is recorded once the batch holding it is
+		// committed, or once the atom is loaded.  Guarded by the batch
+		// mutex.  Forgetting an entry only costs one needless write,
+		// and so, once there are too many, the clock hand sweeps the
+		// slots, and evicts the first one not used since its last
+		// sweep.
+		struct StoredTV
+		{
+			UUID uuid;
+			TruthValuePtr tv;
+			bool used;
+		};
+		std::vector<StoredTV> _stored_tvs;
+		std::unordered_map<UUID, size_t> _stored_index;
+		size_t _stored_hand;
+		bool tv_changed(UUID, const TruthValuePtr&);
+		void note_stored_tv(UUID, const TruthValuePtr&);
+		void remember_tv(UUID, const TruthValuePtr&);
+
+		// Writes out batches that have waited too long.
+		std::thread _flush_thread;
+		std::condition_variable _flush_cv;
+		bool _flush_stop;
+		void flush_loop(void);
+
+		// Batch statistics.
+		std::atomic<unsigned long> _num_batches;
+		std::atomic<unsigned long> _num_batch_rows;
+		std::atomic<unsigned long> _batch_usec;
+		std::atomic<unsigned long> _max_batch_usec;
+		std::atomic<unsigned long> _num_dropped_rows;
+
 	public:
 		AtomStorage(const std::string& dbname, 
 		            const std::string& username,
@@ -142,6 +219,22 @@ class AtomStorage
 		void storeAtom(AtomPtr, bool synchronous = false);
 		void flushStoreQueue();
 
+		// Writes are batched; a batch is written once it holds this
+		// many rows, or once its oldest row is this many seconds old.
+		// A batch size of one writes each atom as it comes.  An
+		// interval of zero waits for the batch to fill up, or for
+		// flushStoreQueue().
+		void setBatchSize(size_t);
+		void setFlushInterval(double);
+		void print_stats(void);
+
+		// The number of rows written so far, in all batches.
+		unsigned long getNumRowsWritten(void);
+
+		// The number of rows that failed on their own, and were
+		// dropped; each is reported in the log.
+		unsigned long getNumRowsDropped(void);
+
 		// Fetch atoms from DB
 		bool atomExists(Handle);
 		AtomPtr getAtom(Handle);
@@ -23,6 +23,7 @@
 
 #include <opencog/atomspace/AtomSpace.h>
 #include <opencog/atomspace/BackingStore.h>
+#include <opencog/atomspace/BackingStoreCache.h>
 #include <opencog/guile/SchemePrimitive.h>
 
 #include "SQLPersistSCM.h"
@@ -102,6 +103,11 @@ SQLPersistSCM::SQLPersistSCM(AtomSpace *as)
 	_store = NULL;
 	_backing = new SQLBackingStore();
 
+	// The AtomSpace asks the backing store about every atom that it
+	// does not have; the cache remembers the answers, so that asking
+	// again, e.g. while ingesting, does not go back to the database.
+	_cache = new BackingStoreCache(_backing);
+
 	// XXX FIXME Huge hack alert.
 	// As of 2013, no one uses this thing, except for NLP processing.
 	// Since I'm too lazy to find an elegant solution right now, I'm
@@ -158,11 +164,14 @@ void SQLPersistSCM::init(void)
 	define_scheme_primitive("sql-close", &SQLPersistSCM::do_close, this, "persist-sql");
 	define_scheme_primitive("sql-load", &SQLPersistSCM::do_load, this, "persist-sql");
 	define_scheme_primitive("sql-store", &SQLPersistSCM::do_store, this, "persist-sql");
+	define_scheme_primitive("sql-stats", &SQLPersistSCM::do_stats, this, "persist-sql");
+	define_scheme_primitive("sql-cache-size", &SQLPersistSCM::do_cache_size, this, "persist-sql");
 #endif
 }
 
 SQLPersistSCM::~SQLPersistSCM()
 {
+	delete _cache;
 	delete _backing;
 }
 
@@ -191,7 +200,8 @@ void SQLPersistSCM::do_open(const std::string& dbname,
 	if (NULL == as)
 		as = SchemeSmob::ss_get_env_as("sql-open");
 #endif
-	as->registerBackingStore(_backing);
+	_cache->clear();
+	as->registerBackingStore(_cache);
 }
 
 void SQLPersistSCM::do_close(void)
@@ -205,8 +215,9 @@ void SQLPersistSCM::do_close(void)
 	if (NULL == as)
 		as = SchemeSmob::ss_get_env_as("sql-close");
 #endif
-	as->unregisterBackingStore(_backing);
+	as->unregisterBackingStore(_cache);
 
+	_cache->clear();
 	_backing->set_store(NULL);
 	delete _store;
 	_store = NULL;
@@ -241,6 +252,29 @@ void SQLPersistSCM::do_store(void)
 #endif
 	// XXX TODO This should really be started in a new thread ...
 	_store->store(const_cast<AtomTable&>(as->get_atomtable()));
+
+	// The store went around the cache, which may now hold stale
+	// "no such atom" answers.
+	_cache->clear();
+}
+
+void SQLPersistSCM::do_stats(void)
+{
+	if (_store == NULL)
+		throw RuntimeException(TRACE_INFO,
+			"sql-stats: Error: Database not open");
+
+	_store->print_stats();
+	_cache->print_stats("sql-stats");
+}
+
+void SQLPersistSCM::do_cache_size(int max_entries)
+{
+	if (max_entries < 0)
+		throw RuntimeException(TRACE_INFO,
+			"sql-cache-size: Error: size must not be negative");
+
+	_cache->set_capacity(max_entries);
 }
 
 void opencog_persist_sql_init(void)
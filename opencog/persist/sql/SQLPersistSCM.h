@@ -37,6 +37,7 @@ namespace opencog
  *  @{
  */
 
+class BackingStoreCache;
 class SQLBackingStore;
 class SQLPersistSCM
 {
@@ -46,6 +47,7 @@ private:
 	void init(void);
 
 	SQLBackingStore *_backing;
+	BackingStoreCache *_cache;
 	AtomStorage *_store;
 	AtomSpace *_as;
 
@@ -57,6 +59,8 @@ public:
 	void do_close(void);
 	void do_load(void);
 	void do_store(void);
+	void do_stats(void);
+	void do_cache_size(int);
 
 }; // class
 
@@ -146,6 +146,10 @@ ODBCConnection::ODBCConnection(const char * _dbname,
 
 ODBCConnection::~ODBCConnection()
 {
+	for (auto& pr : prepared)
+		delete pr.second;
+	prepared.clear();
+
 	if (sql_hdbc)
 	{
 		SQLDisconnect(sql_hdbc);
@@ -238,6 +242,182 @@ ODBCConnection::exec(const char * buff)
 #define DEFAULT_COLUMN_NAME_SIZE 121
 #define DEFAULT_VARCHAR_SIZE 4040
 
+ODBCStatement *
+ODBCConnection::prepare(const char * query, int nparams,
+                        const std::vector<ColType>& cols)
+{
+	if (!is_connected) return NULL;
+
+	auto it = prepared.find(query);
+	if (it != prepared.end()) return it->second;
+
+	ODBCStatement *st = new ODBCStatement(this, query, nparams, cols);
+	if (not st->is_prepared)
+	{
+		delete st;
+		return NULL;
+	}
+	prepared[query] = st;
+	return st;
+}
+
+/* =========================================================== */
+
+ODBCStatement::ODBCStatement(ODBCConnection *_conn, const char * query,
+                             int nparams,
+                             const std::vector<ODBCConnection::ColType>& cols)
+	: conn(_conn), sql_hstmt(NULL), is_prepared(false), bad_param(false),
+	  int_params(nparams, 0), text_params(nparams),
+	  param_lens(nparams, 0),
+	  col_types(cols), int_cols(cols.size(), 0),
+	  double_cols(cols.size(), 0.0), text_cols(cols.size(), NULL),
+	  col_lens(cols.size(), 0)
+{
+	SQLRETURN rc = SQLAllocHandle(SQL_HANDLE_STMT, conn->sql_hdbc, &sql_hstmt);
+	if ((SQL_SUCCESS != rc) && (SQL_SUCCESS_WITH_INFO != rc))
+	{
+		PERR("Can't allocate statement handle, rc=%d", rc);
+		PRINT_SQLERR (SQL_HANDLE_DBC, conn->sql_hdbc);
+		sql_hstmt = NULL;
+		return;
+	}
+
+	rc = SQLPrepare(sql_hstmt, (SQLCHAR *) query, SQL_NTS);
+	if ((SQL_SUCCESS != rc) && (SQL_SUCCESS_WITH_INFO != rc))
+	{
+		PERR ("Can't prepare query rc=%d ", rc);
+		PRINT_SQLERR (SQL_HANDLE_STMT, sql_hstmt);
+		PERR ("\tQuery was: %s\n", query);
+		return;
+	}
+
+	for (size_t i=0; i<cols.size(); i++)
+	{
+		switch (cols[i])
+		{
+			case ODBCConnection::INTEGER:
+				rc = SQLBindCol(sql_hstmt, i+1, SQL_C_SBIGINT,
+				                &int_cols[i], 0, &col_lens[i]);
+				break;
+			case ODBCConnection::DOUBLE:
+				rc = SQLBindCol(sql_hstmt, i+1, SQL_C_DOUBLE,
+				                &double_cols[i], 0, &col_lens[i]);
+				break;
+			case ODBCConnection::TEXT:
+				text_cols[i] = new char[DEFAULT_VARCHAR_SIZE];
+				text_cols[i][0] = 0;
+				rc = SQLBindCol(sql_hstmt, i+1, SQL_C_CHAR,
+				                text_cols[i], DEFAULT_VARCHAR_SIZE, &col_lens[i]);
+				break;
+		}
+		if ((SQL_SUCCESS != rc) && (SQL_SUCCESS_WITH_INFO != rc))
+		{
+			PERR ("Can't bind col=%zu rc=%d", i, rc);
+			PRINT_SQLERR (SQL_HANDLE_STMT, sql_hstmt);
+			return;
+		}
+	}
+	is_prepared = true;
+}
+
+ODBCStatement::~ODBCStatement()
+{
+	if (sql_hstmt) SQLFreeHandle(SQL_HANDLE_STMT, sql_hstmt);
+	sql_hstmt = NULL;
+	for (char * buf : text_cols) delete[] buf;
+}
+
+void
+ODBCStatement::set_param(int i, long val)
+{
+	int_params[i] = val;
+	param_lens[i] = 0;
+	SQLRETURN rc = SQLBindParameter(sql_hstmt, i+1, SQL_PARAM_INPUT,
+	                 SQL_C_SBIGINT, SQL_BIGINT, 0, 0,
+	                 &int_params[i], 0, &param_lens[i]);
+	if ((SQL_SUCCESS != rc) && (SQL_SUCCESS_WITH_INFO != rc))
+	{
+		PERR ("Can't bind param=%d rc=%d", i, rc);
+		PRINT_SQLERR (SQL_HANDLE_STMT, sql_hstmt);
+		bad_param = true;
+	}
+}
+
+void
+ODBCStatement::set_param(int i, const std::string& val)
+{
+	// The string is copied, and the copy bound, since the driver only
+	// reads it when the statement is run.
+	text_params[i] = val;
+	param_lens[i] = text_params[i].size();
+
+	// A column size of zero is an error (HY104), even for an empty
+	// string, such as the name of an anonymous node; its length, in
+	// param_lens, is still zero.  The buffer includes the NUL.
+	SQLULEN colsize = text_params[i].size();
+	if (0 == colsize) colsize = 1;
+	SQLRETURN rc = SQLBindParameter(sql_hstmt, i+1, SQL_PARAM_INPUT,
+	                 SQL_C_CHAR, SQL_VARCHAR, colsize, 0,
+	                 (SQLPOINTER) text_params[i].c_str(),
+	                 text_params[i].size() + 1, &param_lens[i]);
+	if ((SQL_SUCCESS != rc) && (SQL_SUCCESS_WITH_INFO != rc))
+	{
+		PERR ("Can't bind param=%d rc=%d", i, rc);
+		PRINT_SQLERR (SQL_HANDLE_STMT, sql_hstmt);
+		bad_param = true;
+	}
+}
+
+bool
+ODBCStatement::execute(void)
+{
+	// Don't run it with a stale parameter from an earlier run.
+	if (bad_param)
+	{
+		PERR ("Can't execute prepared query: a parameter wasn't bound\n");
+		bad_param = false;
+		return false;
+	}
+
+	SQLRETURN rc = SQLExecute(sql_hstmt);
+
+	// No rows is not an error.
+	if (SQL_NO_DATA == rc) return true;
+
+	if ((SQL_SUCCESS != rc) && (SQL_SUCCESS_WITH_INFO != rc))
+	{
+		PERR ("Can't execute prepared query rc=%d ", rc);
+		PRINT_SQLERR (SQL_HANDLE_STMT, sql_hstmt);
+		close();
+		return false;
+	}
+	return true;
+}
+
+int
+ODBCStatement::fetch_row(void)
+{
+	SQLRETURN rc = SQLFetch(sql_hstmt);
+
+	/* no more data */
+	if (SQL_NO_DATA == rc) return 0;
+	if ((SQL_SUCCESS != rc) && (SQL_SUCCESS_WITH_INFO != rc))
+	{
+		// Fetching after a statement that returned no result set
+		// lands here too; that is not worth complaining about.
+		return 0;
+	}
+	return 1;
+}
+
+void
+ODBCStatement::close(void)
+{
+	SQLFreeStmt(sql_hstmt, SQL_CLOSE);
+}
+
+/* =========================================================== */
+
 void
 ODBCRecordSet::alloc_and_bind_cols(int new_ncols)
 {
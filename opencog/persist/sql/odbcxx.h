@@ -28,8 +28,10 @@
 #ifndef _OPENCOG_PERSISTENT_ODBC_DRIVER_H
 #define _OPENCOG_PERSISTENT_ODBC_DRIVER_H
 
+#include <map>
 #include <stack>
 #include <string>
+#include <vector>
 
 #include <sql.h>
 #include <sqlext.h>
@@ -39,10 +41,12 @@
  */
 
 class ODBCRecordSet;
+class ODBCStatement;
 
 class ODBCConnection
 {
 	friend class ODBCRecordSet;
+	friend class ODBCStatement;
 	private:
 		std::string dbname;
 		std::string username;
@@ -50,6 +54,7 @@ class ODBCConnection
 		SQLHENV sql_henv;
 		SQLHDBC sql_hdbc;
 		std::stack<ODBCRecordSet *> free_pool;
+		std::map<std::string, ODBCStatement *> prepared;
 
 		ODBCRecordSet *get_record_set(void);
 
@@ -62,6 +67,65 @@ class ODBCConnection
 		bool connected(void) const;
 
 		ODBCRecordSet *exec(const char * buff);
+
+		enum ColType { INTEGER, DOUBLE, TEXT };
+
+		// Return the prepared statement for the query, preparing it
+		// the first time it is asked for.  The query has nparams '?'
+		// placeholders, and returns columns of the given types.
+		ODBCStatement *prepare(const char * query, int nparams,
+		                       const std::vector<ColType>& cols);
+};
+
+/**
+ * A prepared, parameterized statement.  The server parses and plans
+ * it only once, no matter how often it is run.  The result columns are
+ * bound in binary, so that numbers are not printed by the server, only
+ * to be parsed again here.  (ODBC has no C type for arrays, so those
+ * still come back as text.)
+ *
+ * A statement belongs to its connection, and is freed along with it.
+ */
+class ODBCStatement
+{
+	friend class ODBCConnection;
+	private:
+		ODBCConnection *conn;
+		SQLHSTMT sql_hstmt;
+		bool is_prepared;
+
+		std::vector<SQLBIGINT> int_params;
+		std::vector<std::string> text_params;
+		std::vector<SQLLEN> param_lens;
+		bool bad_param;  // a parameter failed to bind; don't execute
+
+		std::vector<ODBCConnection::ColType> col_types;
+		std::vector<SQLBIGINT> int_cols;
+		std::vector<double> double_cols;
+		std::vector<char *> text_cols;
+		std::vector<SQLLEN> col_lens;
+
+		ODBCStatement(ODBCConnection *, const char *, int,
+		              const std::vector<ODBCConnection::ColType>&);
+		~ODBCStatement();
+
+	public:
+		// Parameters are numbered from zero.  A parameter that fails
+		// to bind is reported, and makes the next execute() fail.
+		void set_param(int, long);
+		void set_param(int, const std::string&);
+
+		// Run the statement; returns false on error.  Call close()
+		// when done with the rows.
+		bool execute(void);
+		int fetch_row(void); // return non-zero value if there's another row.
+		void close(void);
+
+		// Columns are numbered from zero.
+		bool is_null(int col) const { return SQL_NULL_DATA == col_lens[col]; }
+		long get_long(int col) const { return is_null(col) ? 0 : int_cols[col]; }
+		double get_double(int col) const { return is_null(col) ? 0.0 : double_cols[col]; }
+		const char * get_text(int col) const { return is_null(col) ? NULL : text_cols[col]; }
 };
 
 class ODBCRecordSet
@@ -35,6 +35,9 @@ using namespace opencog;
 AttentionalFocusCB::AttentionalFocusCB(AtomSpace* as) :
 	DefaultPatternMatchCB(as)
 {
+	// link_match() below only adds an STI check to the default one.
+	_exact_link_types = true;
+
 	// Temporarily disable the AF mechanism during the URE development
 	// _as->setAttentionalFocusBoundary(AttentionValue::MINSTI);
 }
@@ -51,10 +54,57 @@ bool AttentionalFocusCB::link_match(const LinkPtr& lpat, const LinkPtr& lsoln)
 		and lsoln->getSTI() > _as->get_attentional_focus_boundary();
 }
 
+// For a heavily-used atom, the incoming set can be far larger than
+// the attentional focus; in that case, it is cheaper to walk the AF
+// (via the ImportanceIndex) and pick out the links that contain h.
 IncomingSet AttentionalFocusCB::get_incoming_set(const Handle& h)
 {
-	const IncomingSet &incoming_set = h->getIncomingSet();
+	AttentionValue::sti_t lo = _as->get_attentional_focus_boundary();
+	if (lo < AttentionValue::MAXSTI and
+	    _as->estimate_size_by_AV(lo + 1) < h->getIncomingSetSize())
+		return from_focus(h, NOTYPE);
+
+	return in_focus(h->getIncomingSet());
+}
+
+IncomingSet AttentionalFocusCB::get_incoming_set(const Handle& h, Type t)
+{
+	AttentionValue::sti_t lo = _as->get_attentional_focus_boundary();
+	if (lo < AttentionValue::MAXSTI and
+	    _as->estimate_size_by_AV(lo + 1) < h->getIncomingSetSize())
+		return from_focus(h, t);
+
+	return in_focus(DefaultPatternMatchCB::get_incoming_set(h, t));
+}
+
+IncomingSet AttentionalFocusCB::from_focus(const Handle& h, Type t)
+{
+	HandleSeq focus;
+	_as->get_handles_by_AV(back_inserter(focus),
+	                       _as->get_attentional_focus_boundary() + 1);
 
+	IncomingSet filtered_set;
+	for (const Handle& fh : focus)
+	{
+		LinkPtr l(LinkCast(fh));
+		if (NULL == l) continue;
+		if (NOTYPE != t and l->getType() != t) continue;
+		for (const Handle& oh : l->getOutgoingSet())
+		{
+			if (oh == h)
+			{
+				filtered_set.push_back(l);
+				break;
+			}
+		}
+	}
+
+	std::sort(filtered_set.begin(), filtered_set.end(), compare_sti);
+	return filtered_set;
+}
+
+IncomingSet AttentionalFocusCB::in_focus(const IncomingSet& incoming_set)
+{
 	// Discard the part of the incoming set that is below the
 	// AF boundary.  The PM will look only at those links that
 	// this callback returns; thus we avoid searching the low-AF
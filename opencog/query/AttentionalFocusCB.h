@@ -34,6 +34,8 @@ private:
 	{
 		return lptr1->getSTI() > lptr2->getSTI();
 	}
+	IncomingSet in_focus(const IncomingSet&);
+	IncomingSet from_focus(const Handle&, Type);
 public:
 	AttentionalFocusCB(AtomSpace*);
 
@@ -45,6 +47,7 @@ public:
 
 	// Only get incoming sets that are in the attentional focus
 	IncomingSet get_incoming_set(const Handle&);
+	IncomingSet get_incoming_set(const Handle&, Type);
 };
 
 } //namespace opencog
@@ -22,6 +22,8 @@
 #ifndef _OPENCOG_BINDLINK_API_H
 #define _OPENCOG_BINDLINK_API_H
 
+#include <functional>
+
 #include <opencog/atomspace/Handle.h>
 #include <opencog/atomspace/TruthValue.h>
 #include <opencog/query/Implicator.h>
@@ -35,6 +37,17 @@ Handle single_bindlink (AtomSpace*, const Handle&);
 Handle af_bindlink(AtomSpace*, const Handle&);
 TruthValuePtr satisfaction_link(AtomSpace*, const Handle&);
 Handle satisfying_set(AtomSpace*, const Handle&);
+Handle multi_bindlink(AtomSpace*, const Handle&);
+HandleSeq do_multi_imply(AtomSpace*, const HandleSeq&);
+
+/// Called with each result, as it is found; return false to stop.
+typedef std::function<bool(const Handle&)> ResultSink;
+size_t bindlink_foreach(AtomSpace*, const Handle&, const ResultSink&,
+                        size_t offset = 0, size_t limit = SIZE_MAX,
+                        bool instantiate = true, size_t* consumed = NULL);
+HandleSeq bindlink_range(AtomSpace*, const Handle&,
+                         size_t offset, size_t limit,
+                         bool instantiate = true, size_t* consumed = NULL);
     Handle do_imply(AtomSpace* as,const Handle& hbindlink,Implicator& impl,
                 bool do_conn_check=false);
 
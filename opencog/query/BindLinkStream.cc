@@ -0,0 +1,260 @@
+/*
+ * BindLinkStream.cc
+ *
+ * Copyright (C) 2015 OpenCog Foundation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <opencog/atoms/bind/BindLink.h>
+
+#include "BindLinkAPI.h"
+#include "BindLinkStream.h"
+#include "DefaultImplicator.h"
+
+using namespace opencog;
+
+/**
+ * Hands each result to the sink as soon as it is found, instead of
+ * collecting them all.  The first `offset` groundings are skipped,
+ * without being instantiated; the search stops after `limit` results,
+ * or as soon as the sink returns false.  The groundings after the
+ * offset are counted, whether or not they gave a result, so that the
+ * next page can start right after the last one used.
+ */
+class StreamImplicator : public DefaultImplicator
+{
+	public:
+		StreamImplicator(AtomSpace* as, const ResultSink& sink,
+		                 size_t offset, size_t limit, bool instantiate) :
+			Implicator(as),
+			InitiateSearchCB(as),
+			DefaultPatternMatchCB(as),
+			DefaultImplicator(as),
+			_varseq(NULL), _atomspace(as), _sink(sink), _offset(offset),
+			_limit(limit), _instantiate(instantiate),
+			_skipped(0), _consumed(0), _count(0), _stopped(false) {}
+
+		const HandleSeq* _varseq;
+		size_t count(void) const { return _count; }
+		size_t consumed(void) const { return _consumed; }
+		bool stopped(void) const { return _stopped; }
+
+		/// Deliver one result; returns true to stop the search.
+		bool deliver(const Handle& h)
+		{
+			_consumed++;
+			_count++;
+			if (not _sink(h)) _stopped = true;
+			return _stopped or _limit <= _count;
+		}
+
+		virtual bool grounding(const std::map<Handle, Handle> &var_soln,
+		                       const std::map<Handle, Handle> &term_soln)
+		{
+			if (_skipped < _offset)
+			{
+				_skipped++;
+				return false;
+			}
+
+			if (_instantiate)
+			{
+				Handle h(inst.instantiate(implicand, var_soln));
+				if (Handle::UNDEFINED == h)
+				{
+					_consumed++;
+					return false;
+				}
+				return deliver(h);
+			}
+
+			// The bare groundings, as for a GetLink.
+			if (1 == _varseq->size())
+				return deliver(var_soln.at(_varseq->at(0)));
+
+			HandleSeq vargnds;
+			for (const Handle& hv : *_varseq)
+				vargnds.push_back(var_soln.at(hv));
+			return deliver(_atomspace->add_link(LIST_LINK, vargnds));
+		}
+
+	private:
+		AtomSpace* _atomspace;
+		const ResultSink& _sink;
+		size_t _offset;
+		size_t _limit;
+		bool _instantiate;
+		size_t _skipped;
+		size_t _consumed;
+		size_t _count;
+		bool _stopped;
+};
+
+namespace opencog
+{
+
+/**
+ * Run a BindLink, handing each result to the sink as it is found,
+ * instead of collecting them into a SetLink.  Nothing is held on to:
+ * a query with millions of results costs no more memory than one with
+ * a single result.
+ *
+ * The first `offset` groundings are skipped, and at most `limit`
+ * results are delivered.  The sink returns false to stop the search
+ * early.  If `instantiate` is false, the implicand is ignored, and the
+ * groundings of the variables are delivered instead: the grounding,
+ * if there is one variable, else a ListLink of the groundings, in
+ * order, just as for a GetLink.
+ *
+ * Returns the number of results delivered.  If `consumed` is given,
+ * it is set to the number of groundings used up after the offset,
+ * including those whose implicand did not instantiate to anything.
+ * The next page starts at offset plus that; not at offset plus the
+ * number of results, which may be fewer.
+ */
+size_t bindlink_foreach(AtomSpace* as, const Handle& hbindlink,
+                        const ResultSink& sink,
+                        size_t offset, size_t limit, bool instantiate,
+                        size_t* consumed)
+{
+	if (consumed) *consumed = 0;
+	if (0 == limit) return 0;
+
+	BindLinkPtr bl(BindLinkCast(hbindlink));
+	if (NULL == bl)
+		bl = createBindLink(*LinkCast(hbindlink));
+
+	StreamImplicator impl(as, sink, offset, limit, instantiate);
+	impl.set_evaluation_memo(DefaultPatternMatchCB::default_evaluation_memo());
+	impl.implicand = bl->get_implicand();
+	impl._varseq = &bl->get_variables().varseq;
+	bl->imply(impl, false);
+
+	// The AbsentLink case; see do_imply().
+	const Pattern& pat = bl->get_pattern();
+	if (0 == impl.count() and not impl.stopped() and 0 == offset and
+	    0 == pat.mandatory.size() and 0 < pat.optionals.size() and
+	    not impl.optionals_present())
+	{
+		std::map<Handle, Handle> empty_map;
+		Handle h(impl.inst.instantiate(impl.implicand, empty_map));
+		if (Handle::UNDEFINED != h)
+			impl.deliver(h);
+	}
+	if (consumed) *consumed = impl.consumed();
+	return impl.count();
+}
+
+/**
+ * One page of the results of a BindLink: at most `limit` of them,
+ * after skipping the first `offset` groundings.  See bindlink_foreach(),
+ * also for `consumed`.
+ */
+HandleSeq bindlink_range(AtomSpace* as, const Handle& hbindlink,
+                         size_t offset, size_t limit, bool instantiate,
+                         size_t* consumed)
+{
+	HandleSeq page;
+	bindlink_foreach(as, hbindlink,
+		[&](const Handle& h)->bool { page.push_back(h); return true; },
+		offset, limit, instantiate, consumed);
+	return page;
+}
+
+}
+
+/* ======================================================== */
+
+BindLinkStream::BindLinkStream(AtomSpace* as, const Handle& bindlink,
+                               size_t offset, size_t limit,
+                               bool instantiate, size_t backlog) :
+	_backlog(0 < backlog ? backlog : 1), _done(false), _closed(false)
+{
+	_producer = std::thread(&BindLinkStream::produce, this,
+	                        as, bindlink, offset, limit, instantiate);
+}
+
+BindLinkStream::~BindLinkStream()
+{
+	close();
+}
+
+void BindLinkStream::produce(AtomSpace* as, Handle bindlink,
+                             size_t offset, size_t limit, bool instantiate)
+{
+	try
+	{
+		bindlink_foreach(as, bindlink,
+			[this](const Handle& h)->bool { return push(h); },
+			offset, limit, instantiate);
+	}
+	catch (...)
+	{
+		std::lock_guard<std::mutex> lck(_mtx);
+		_error = std::current_exception();
+	}
+
+	std::lock_guard<std::mutex> lck(_mtx);
+	_done = true;
+	_cv.notify_all();
+}
+
+/// Called by the search; blocks while the queue is full.  Returns
+/// false, to stop the search, once the stream is closed.
+bool BindLinkStream::push(const Handle& h)
+{
+	std::unique_lock<std::mutex> lck(_mtx);
+	_cv.wait(lck, [this]() {
+		return _closed or _queue.size() < _backlog; });
+	if (_closed) return false;
+	_queue.push_back(h);
+	_cv.notify_all();
+	return true;
+}
+
+bool BindLinkStream::next(Handle& h)
+{
+	std::unique_lock<std::mutex> lck(_mtx);
+	_cv.wait(lck, [this]() { return _done or not _queue.empty(); });
+	if (not _queue.empty())
+	{
+		h = _queue.front();
+		_queue.pop_front();
+		_cv.notify_all();
+		return true;
+	}
+	if (_error)
+	{
+		std::exception_ptr err(_error);
+		_error = nullptr;
+		std::rethrow_exception(err);
+	}
+	return false;
+}
+
+void BindLinkStream::close(void)
+{
+	{
+		std::lock_guard<std::mutex> lck(_mtx);
+		_closed = true;
+		_queue.clear();
+		_cv.notify_all();
+	}
+	if (_producer.joinable()) _producer.join();
+}
+
+/* ===================== END OF FILE ===================== */
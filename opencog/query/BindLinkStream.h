@@ -0,0 +1,82 @@
+/*
+ * BindLinkStream.h
+ *
+ * Copyright (C) 2015 OpenCog Foundation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _OPENCOG_BINDLINK_STREAM_H
+#define _OPENCOG_BINDLINK_STREAM_H
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+#include <opencog/atomspace/AtomSpace.h>
+
+namespace opencog {
+
+/**
+ * Pull the results of a BindLink one at a time, as the search finds
+ * them, instead of waiting for all of them to be wrapped in a SetLink.
+ *
+ * The search runs on a thread of its own, and hands the results over
+ * through a queue of at most `backlog` entries; when the queue is full,
+ * the search waits for the reader to catch up.  Closing the stream (or
+ * destroying it) stops the search.
+ *
+ * The offset, limit and instantiate arguments are as for
+ * bindlink_foreach(); see BindLinkAPI.h.
+ *
+ * Note that the search thread calls into scheme or python, if the
+ * pattern has grounded predicates in it; a python reader must release
+ * the GIL while it waits in next().
+ */
+class BindLinkStream
+{
+	public:
+		BindLinkStream(AtomSpace*, const Handle& bindlink,
+		               size_t offset = 0, size_t limit = SIZE_MAX,
+		               bool instantiate = true, size_t backlog = 64);
+		~BindLinkStream();
+
+		/// Wait for the next result.  Returns false once there are no
+		/// more.  If the search threw, the exception is re-thrown here.
+		bool next(Handle&);
+
+		/// Stop the search, and wait for it to finish.
+		void close(void);
+
+	private:
+		std::mutex _mtx;
+		std::condition_variable _cv;
+		std::deque<Handle> _queue;
+		size_t _backlog;
+		bool _done;
+		bool _closed;
+		std::exception_ptr _error;
+		std::thread _producer;
+
+		bool push(const Handle&);
+		void produce(AtomSpace*, Handle, size_t, size_t, bool);
+};
+
+} // namespace opencog
+
+#endif // _OPENCOG_BINDLINK_STREAM_H
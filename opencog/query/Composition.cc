@@ -144,7 +144,7 @@ bool PatternMatchEngine::redex_compare(const LinkPtr& lp,
 	clear_current_state();
 // XXX TODO handle clause_grounding as well ?? why
 
-	SolnMap local_grounding;
+	std::map<Handle, Handle> local_grounding;
 	size_t sz = redex_args.size();
 	for (size_t i=0; i< sz; i++)
 	{
@@ -153,7 +153,8 @@ bool PatternMatchEngine::redex_compare(const LinkPtr& lp,
 		if (iter == var_grounding.end()) continue;
 		local_grounding.insert({local_args.varseq[i], iter->second});
 	}
-	var_grounding = local_grounding;
+	for (const auto& pr : local_grounding)
+		var_grounding.set(pr.first, pr.second);
 
 	if (1 != _pat->cnf_clauses.size())
 		throw InvalidParamException(TRACE_INFO,
@@ -208,8 +209,9 @@ bool PatternMatchEngine::redex_compare(const LinkPtr& lp,
 	for (size_t i=0; i< sz; i++)
 	{
 		auto iter = local_grounding.find(local_args.varseq[i]);
-		if (iter != local_grounding.end())
-			var_grounding.insert({redex_args[i], iter->second});
+		if (iter != local_grounding.end() and
+		    0 == var_grounding.count(redex_args[i]))
+			var_grounding.set(redex_args[i], iter->second);
 	}
 
 	pop_redex();
@@ -24,6 +24,8 @@
 #ifndef _OPENCOG_DEFAULT_IMPLICATOR_H
 #define _OPENCOG_DEFAULT_IMPLICATOR_H
 
+#include <typeinfo>
+
 #include "AttentionalFocusCB.h"
 #include "DefaultPatternMatchCB.h"
 #include "Implicator.h"
@@ -42,7 +44,8 @@ class DefaultImplicator:
 		DefaultImplicator(AtomSpace* asp) :
 			Implicator(asp),
 			InitiateSearchCB(asp),
-			DefaultPatternMatchCB(asp) {}
+			DefaultPatternMatchCB(asp)
+		{ _exact_link_types = true; }
 
 	virtual void set_pattern(const Variables& vars,
 	                         const Pattern& pat)
@@ -50,6 +53,23 @@ class DefaultImplicator:
 		InitiateSearchCB::set_pattern(vars, pat);
 		DefaultPatternMatchCB::set_pattern(vars, pat);
 	}
+
+	virtual PatternMatchCallback* clone(void)
+	{
+		if (typeid(*this) != typeid(DefaultImplicator)) return NULL;
+		return clone_matcher();
+	}
+
+protected:
+	// A subclass that changes only grounding() matches just like a
+	// plain DefaultImplicator, and can clone itself as one.
+	PatternMatchCallback* clone_matcher(void)
+	{
+		DefaultImplicator* cb = new DefaultImplicator(InitiateSearchCB::_as);
+		cb->set_pattern(*_variables, *_pattern);
+		cb->set_evaluation_memo(_memo);
+		return cb;
+	}
 };
 
 
@@ -75,6 +95,15 @@ class AFImplicator:
 		InitiateSearchCB::set_pattern(vars, pat);
 		DefaultPatternMatchCB::set_pattern(vars, pat);
 	}
+
+	virtual PatternMatchCallback* clone(void)
+	{
+		if (typeid(*this) != typeid(AFImplicator)) return NULL;
+		AFImplicator* cb = new AFImplicator(InitiateSearchCB::_as);
+		cb->set_pattern(*_variables, *_pattern);
+		cb->set_evaluation_memo(_memo);
+		return cb;
+	}
 };
 
 }; // namespace opencog
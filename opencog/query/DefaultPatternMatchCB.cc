@@ -21,6 +21,9 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
  */
 
+#include <stdlib.h>
+
+#include <opencog/util/Config.h>
 #include <opencog/atoms/execution/EvaluationLink.h>
 #include <opencog/atoms/execution/Instantiator.h>
 #include <opencog/atomutils/FindUtils.h>
@@ -51,6 +54,29 @@ DefaultPatternMatchCB::DefaultPatternMatchCB(AtomSpace* as) :
 	_connectives.insert(NOT_LINK);
 }
 
+std::shared_ptr<EvaluationMemo> DefaultPatternMatchCB::default_evaluation_memo(void)
+{
+	if (not config().has("PATTERN_MATCHER_MEMO")) return NULL;
+	std::string how(config().get("PATTERN_MATCHER_MEMO"));
+	if ("query" == how)
+		return std::make_shared<EvaluationMemo>();
+
+	double ttl = atof(how.c_str());
+	if (ttl <= 0.0) return NULL;
+
+	// One memo for all queries; a new one if the time-to-live changes.
+	static std::mutex mtx;
+	static std::shared_ptr<EvaluationMemo> shared;
+	static double shared_ttl = 0.0;
+	std::lock_guard<std::mutex> lck(mtx);
+	if (NULL == shared or ttl != shared_ttl)
+	{
+		shared = std::make_shared<EvaluationMemo>(ttl);
+		shared_ttl = ttl;
+	}
+	return shared;
+}
+
 void DefaultPatternMatchCB::set_pattern(const Variables& vars,
                                         const Pattern& pat)
 {
@@ -159,7 +185,7 @@ bool DefaultPatternMatchCB::post_link_match(const LinkPtr& lpat,
 	// one how the evaluation turned out.  Its "crisp logic"
 	// because we use a greater-than-half for the TV.
 	// This is the same behavior as used in evaluate_term().
-	TruthValuePtr tv(EvaluationLink::do_evaluate(_as, lgnd->getHandle()));
+	TruthValuePtr tv(evaluate(_as, lgnd->getHandle()));
 	return tv->getMean() >= 0.5;
 }
 
@@ -196,7 +222,7 @@ bool DefaultPatternMatchCB::clause_match(const Handle& ptrn,
 		// default callback ignores the TV on EvaluationLinks. So this
 		// is kind-of schizophrenic here.  Not sure what else to do.
 		_temp_aspace.clear();
-		TruthValuePtr tvp(EvaluationLink::do_evaluate(&_temp_aspace, grnd));
+		TruthValuePtr tvp(evaluate(&_temp_aspace, grnd));
 
 		dbgprt("clause_match evaluation yeilded tv=%s\n", tvp->toString().c_str());
 
@@ -225,6 +251,66 @@ bool DefaultPatternMatchCB::optional_clause_match(const Handle& ptrn,
 
 /* ======================================================== */
 
+/**
+ * The key under which an evaluation is memoized: the
+ * GroundedPredicateNode, followed by its arguments.  If gnds is given,
+ * then h is a term in the pattern, and the arguments are looked up
+ * there; else h is already grounded.  Returns false if there is no
+ * memo, if h is not a GroundedPredicateNode applied to a ListLink, or
+ * if some argument is not a variable or a constant, and so would have
+ * to be instantiated first.
+ */
+bool DefaultPatternMatchCB::memo_key(const Handle& h,
+                                     const std::map<Handle,Handle>* gnds,
+                                     HandleSeq& key)
+{
+	if (nullptr == _memo or EVALUATION_LINK != h->getType()) return false;
+
+	LinkPtr lev(LinkCast(h));
+	if (2 != lev->getArity()) return false;
+	const Handle& gpn = lev->getOutgoingAtom(0);
+	const Handle& args = lev->getOutgoingAtom(1);
+	if (GROUNDED_PREDICATE_NODE != gpn->getType() or
+	    LIST_LINK != args->getType()) return false;
+
+	// Atoms that were never put in an atomspace have no UUID.
+	if (Handle::UNDEFINED.value() == gpn.value()) return false;
+	key.push_back(gpn);
+
+	for (const Handle& a : LinkCast(args)->getOutgoingSet())
+	{
+		Handle g(a);
+		if (gnds)
+		{
+			auto it = gnds->find(a);
+			if (it != gnds->end())
+				g = it->second;
+			else if (NULL != LinkCast(a) or VARIABLE_NODE == a->getType())
+				return false;
+		}
+		if (Handle::UNDEFINED.value() == g.value()) return false;
+		key.push_back(g);
+	}
+	return true;
+}
+
+/// Evaluate a grounded term, going through the memo, if there is one.
+TruthValuePtr DefaultPatternMatchCB::evaluate(AtomSpace* as,
+                                              const Handle& h)
+{
+	HandleSeq key;
+	if (not memo_key(h, nullptr, key))
+		return EvaluationLink::do_evaluate(as, h);
+
+	TruthValuePtr tvp;
+	if (_memo->lookup(key, tvp)) return tvp;
+	tvp = EvaluationLink::do_evaluate(as, h);
+	_memo->store(key, tvp);
+	return tvp;
+}
+
+/* ======================================================== */
+
 bool DefaultPatternMatchCB::eval_term(const Handle& virt,
                                       const std::map<Handle, Handle>& gnds)
 {
@@ -234,6 +320,14 @@ bool DefaultPatternMatchCB::eval_term(const Handle& virt,
 	// proposed grounding into the "real" atomspace, because the
 	// grounding might be insane.  So we put it here. This is probably
 	// not very efficient, but will do for now...
+	//
+	// If the predicate was already evaluated on these arguments, then
+	// there is no need to ground it at all.
+	HandleSeq key;
+	bool memo = memo_key(virt, &gnds, key);
+	TruthValuePtr tvp;
+	if (memo and _memo->lookup(key, tvp))
+		return tvp->getMean() > 0.5;
 
 	Handle gvirt(_instor.instantiate(virt, gnds));
 
@@ -273,7 +367,8 @@ bool DefaultPatternMatchCB::eval_term(const Handle& virt,
 	// EvaluationLink::do_evaluate() method should do this ??? Its a toss-up.
 
 	_temp_aspace.clear();
-	TruthValuePtr tvp(EvaluationLink::do_evaluate(&_temp_aspace, gvirt));
+	tvp = EvaluationLink::do_evaluate(&_temp_aspace, gvirt);
+	if (memo) _memo->store(key, tvp);
 
 	dbgprt("eval_term evaluation yeilded tv=%s\n", tvp->toString().c_str());
 
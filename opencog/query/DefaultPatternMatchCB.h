@@ -28,6 +28,7 @@
 #include <opencog/atomspace/types.h>
 #include <opencog/atomspace/AtomSpace.h>
 #include <opencog/atoms/execution/Instantiator.h>
+#include <opencog/query/EvaluationMemo.h>
 #include <opencog/query/PatternMatchCallback.h>
 #include <opencog/query/PatternMatchEngine.h>
 
@@ -62,6 +63,18 @@ class DefaultPatternMatchCB : public virtual PatternMatchCallback
 		virtual bool link_match(const LinkPtr&, const LinkPtr&);
 		virtual bool post_link_match(const LinkPtr&, const LinkPtr&);
 
+		// link_match() wants the link types to be equal, so only
+		// the links of type t need to be looked at.  But subclasses
+		// may replace link_match() with one that accepts other types
+		// (the fuzzy matcher does), and so this is off unless the
+		// subclass turns it on; see _exact_link_types.
+		using PatternMatchCallback::get_incoming_set;
+		virtual IncomingSet get_incoming_set(const Handle& h, Type t)
+		{
+			if (_exact_link_types) return h->getIncomingSetByType(t);
+			return get_incoming_set(h);
+		}
+
 		virtual bool clause_match(const Handle&, const Handle&);
 		/**
 		 * Typically called for AbsentLink
@@ -83,6 +96,26 @@ class DefaultPatternMatchCB : public virtual PatternMatchCallback
 		}
 
 		bool optionals_present(void) { return _optionals_present; }
+
+		/**
+		 * Remember what each GroundedPredicateNode returned, for each
+		 * tuple of arguments, and don't evaluate it again; see
+		 * EvaluationMemo.  Off by default; pass the same memo to
+		 * several callbacks to share it between queries.
+		 */
+		void set_evaluation_memo(const std::shared_ptr<EvaluationMemo>& m)
+		{ _memo = m; }
+		const std::shared_ptr<EvaluationMemo>& get_evaluation_memo(void)
+		{ return _memo; }
+
+		/// The memo that the stock callbacks (bindlink,
+		/// satisfaction_link, and so on) use; set by the
+		/// PATTERN_MATCHER_MEMO config parameter.  "query" gives each
+		/// query a memo of its own; a number of seconds gives all of
+		/// them one memo, whose entries are kept that long.  The
+		/// default is none.
+		static std::shared_ptr<EvaluationMemo> default_evaluation_memo(void);
+
 	protected:
 
 		ClassServer& _classserver;
@@ -102,8 +135,18 @@ class DefaultPatternMatchCB : public virtual PatternMatchCallback
 		bool eval_sentence(const Handle& pat,
 		             const std::map<Handle,Handle>& gnds);
 
+		std::shared_ptr<EvaluationMemo> _memo;
+		bool memo_key(const Handle&, const std::map<Handle,Handle>*,
+		              HandleSeq&);
+		TruthValuePtr evaluate(AtomSpace*, const Handle&);
+
 		bool _optionals_present = false;
 		AtomSpace* _as;
+
+		// Set by subclasses whose link_match() rejects every link whose
+		// type differs from the pattern's, so that the incoming set can
+		// be filtered by type before it is explored.
+		bool _exact_link_types = false;
 };
 
 } // namespace opencog
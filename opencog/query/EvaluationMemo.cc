@@ -0,0 +1,90 @@
+/*
+ * EvaluationMemo.cc
+ *
+ * Copyright (C) 2015 OpenCog Foundation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "EvaluationMemo.h"
+
+using namespace opencog;
+
+// Expired entries are swept out once every this many stores.
+#define SWEEP_INTERVAL 4096
+
+std::atomic<size_t> EvaluationMemo::_total_hits(0);
+std::atomic<size_t> EvaluationMemo::_total_misses(0);
+
+EvaluationMemo::EvaluationMemo(double ttl, Now now) :
+	_ttl(std::chrono::duration_cast<Clock::duration>(
+		std::chrono::duration<double>(ttl))),
+	_now(now), _stores(0), _hits(0), _misses(0)
+{}
+
+bool EvaluationMemo::expired(const Entry& e, Clock::time_point now) const
+{
+	return Clock::duration::zero() < _ttl and _ttl < now - e.when;
+}
+
+bool EvaluationMemo::lookup(const HandleSeq& key, TruthValuePtr& tv)
+{
+	std::lock_guard<std::mutex> lck(_mtx);
+	auto it = _memo.find(key);
+	if (it == _memo.end() or expired(it->second, _now()))
+	{
+		_misses++;
+		_total_misses++;
+		return false;
+	}
+	_hits++;
+	_total_hits++;
+	tv = it->second.tv;
+	return true;
+}
+
+void EvaluationMemo::store(const HandleSeq& key, const TruthValuePtr& tv)
+{
+	Clock::time_point now = _now();
+	std::lock_guard<std::mutex> lck(_mtx);
+	Entry& e = _memo[key];
+	e.tv = tv;
+	e.when = now;
+
+	if (Clock::duration::zero() == _ttl or ++_stores < SWEEP_INTERVAL)
+		return;
+	_stores = 0;
+	for (auto it = _memo.begin(); it != _memo.end(); )
+	{
+		if (expired(it->second, now)) it = _memo.erase(it);
+		else it++;
+	}
+}
+
+void EvaluationMemo::clear(void)
+{
+	std::lock_guard<std::mutex> lck(_mtx);
+	_memo.clear();
+	_stores = 0;
+}
+
+size_t EvaluationMemo::size(void)
+{
+	std::lock_guard<std::mutex> lck(_mtx);
+	return _memo.size();
+}
+
+/* ===================== END OF FILE ===================== */
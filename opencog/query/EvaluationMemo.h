@@ -0,0 +1,101 @@
+/*
+ * EvaluationMemo.h
+ *
+ * Copyright (C) 2015 OpenCog Foundation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _OPENCOG_EVALUATION_MEMO_H
+#define _OPENCOG_EVALUATION_MEMO_H
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <mutex>
+
+#include <opencog/atomspace/Handle.h>
+#include <opencog/atomspace/TruthValue.h>
+
+namespace opencog {
+
+/**
+ * Remembers the truth values that GroundedPredicateNodes returned,
+ * so that the pattern matcher evaluates each one just once for each
+ * distinct tuple of arguments, instead of once for every grounding
+ * that it tries.  Calling into scheme or python is slow, and the same
+ * tuple typically turns up over and over in a search.
+ *
+ * The key is the GroundedPredicateNode, followed by the arguments,
+ * compared by UUID.  The argument atoms are never re-used, so a
+ * stale entry can only be wrong if the predicate itself depends on
+ * something that changed, such as a truth value, or the time.  That
+ * is why this is opt-in: see DefaultPatternMatchCB::set_evaluation_memo().
+ * A memo that lives for just one query is always safe for predicates
+ * without side effects; one that is shared between queries can be
+ * given a time-to-live, after which the entries are evaluated again.
+ *
+ * Safe to share between threads.
+ */
+class EvaluationMemo
+{
+	public:
+		typedef std::chrono::steady_clock Clock;
+		typedef std::function<Clock::time_point(void)> Now;
+
+		/// Entries older than ttl seconds are evaluated again; zero
+		/// means that they are kept for the life of the memo.  The
+		/// age is measured with the now function; tests pass their
+		/// own, to make time pass without waiting.
+		EvaluationMemo(double ttl = 0.0, Now now = Clock::now);
+
+		bool lookup(const HandleSeq& key, TruthValuePtr& tv);
+		void store(const HandleSeq& key, const TruthValuePtr& tv);
+		void clear(void);
+
+		size_t size(void);
+		size_t hits(void) const { return _hits; }
+		size_t misses(void) const { return _misses; }
+
+		/// The hits and misses of all memos, so far.
+		static size_t total_hits(void) { return _total_hits; }
+		static size_t total_misses(void) { return _total_misses; }
+
+	private:
+		struct Entry
+		{
+			TruthValuePtr tv;
+			Clock::time_point when;
+		};
+
+		Clock::duration _ttl;
+		Now _now;
+		std::mutex _mtx;
+		std::map<HandleSeq, Entry> _memo;
+		size_t _stores;
+
+		std::atomic<size_t> _hits;
+		std::atomic<size_t> _misses;
+		static std::atomic<size_t> _total_hits;
+		static std::atomic<size_t> _total_misses;
+
+		bool expired(const Entry&, Clock::time_point) const;
+};
+
+} // namespace opencog
+
+#endif // _OPENCOG_EVALUATION_MEMO_H
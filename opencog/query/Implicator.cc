@@ -132,6 +132,8 @@ Handle bindlink(AtomSpace* as, const Handle& hbindlink)
 {
 	// Now perform the search.
 	DefaultImplicator impl(as);
+	impl.set_search_threads(InitiateSearchCB::default_search_threads());
+	impl.set_evaluation_memo(DefaultPatternMatchCB::default_evaluation_memo());
 	return do_imply(as, hbindlink, impl);
 }
 
@@ -148,6 +150,8 @@ Handle single_bindlink (AtomSpace* as, const Handle& hbindlink)
 	// Now perform the search.
 	DefaultImplicator impl(as);
 	impl.max_results = 1;
+	impl.set_search_threads(InitiateSearchCB::default_search_threads());
+	impl.set_evaluation_memo(DefaultPatternMatchCB::default_evaluation_memo());
 	return do_imply(as, hbindlink, impl);
 }
 
@@ -158,6 +162,8 @@ Handle af_bindlink(AtomSpace* as, const Handle& hbindlink)
 {
 	// Now perform the search.
 	AFImplicator impl(as);
+	impl.set_search_threads(InitiateSearchCB::default_search_threads());
+	impl.set_evaluation_memo(DefaultPatternMatchCB::default_evaluation_memo());
 	return do_imply(as, hbindlink, impl, false);
 }
 
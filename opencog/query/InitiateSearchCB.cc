@@ -21,6 +21,14 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
  */
 
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <typeinfo>
+
+#include <opencog/util/Config.h>
 #include <opencog/atoms/execution/EvaluationLink.h>
 #include <opencog/atomutils/FindUtils.h>
 #include <opencog/atoms/bind/BetaRedex.h>
@@ -46,10 +54,296 @@ InitiateSearchCB::InitiateSearchCB(AtomSpace* as) :
 	_pattern(NULL),
 	_type_restrictions(NULL),
 	_dynamic(NULL),
+	_search_threads(1),
+	_num_candidates(0),
 	_as(as)
 {
 }
 
+unsigned int InitiateSearchCB::default_search_threads(void)
+{
+	if (not config().has("PATTERN_MATCHER_THREADS")) return 1;
+	int n = config().get_int("PATTERN_MATCHER_THREADS");
+	return (0 < n) ? n : 1;
+}
+
+/* ======================================================== */
+
+namespace opencog {
+
+/**
+ * Callback adapter for the parallel search.  Each thread matches with
+ * a callback of its own, made by clone(), so that the calls made for
+ * every atom compared (node_match(), link_match(), get_incoming_set()
+ * and so on) run in parallel, without a lock.  Only the calls that
+ * report back to the caller's callback go to it, under the lock, one
+ * at a time: grounding(), which keeps the results, evaluate_sentence(),
+ * which shares its scratch atomspace, and optional_clause_match(),
+ * which notes that an optional clause was present.  Once some
+ * grounding() has returned true, the matching callbacks reject
+ * everything, so that all of the engines unwind as fast as they can.
+ */
+class ParallelSearchCB : public PatternMatchCallback
+{
+	private:
+		PatternMatchCallback& _cb;
+		PatternMatchCallback& _own;
+		std::mutex& _mtx;
+		std::atomic<bool>& _stop;
+
+	public:
+		ParallelSearchCB(PatternMatchCallback& cb,
+		                 PatternMatchCallback& own,
+		                 std::mutex& mtx, std::atomic<bool>& stop)
+			: _cb(cb), _own(own), _mtx(mtx), _stop(stop) {}
+
+		bool node_match(const Handle& np, const Handle& ng) {
+			if (_stop) return false;
+			return _own.node_match(np, ng);
+		}
+		bool variable_match(const Handle& np, const Handle& ng) {
+			if (_stop) return false;
+			return _own.variable_match(np, ng);
+		}
+		bool link_match(const LinkPtr& lp, const LinkPtr& lg) {
+			if (_stop) return false;
+			return _own.link_match(lp, lg);
+		}
+		bool fuzzy_match(const Handle& hp, const Handle& hg) {
+			if (_stop) return false;
+			return _own.fuzzy_match(hp, hg);
+		}
+		IncomingSet get_incoming_set(const Handle& h) {
+			return _own.get_incoming_set(h);
+		}
+		IncomingSet get_incoming_set(const Handle& h, Type t) {
+			return _own.get_incoming_set(h, t);
+		}
+		const std::set<Type>& get_connectives(void) {
+			return _own.get_connectives();
+		}
+		bool post_link_match(const LinkPtr& lp, const LinkPtr& lg) {
+			return _own.post_link_match(lp, lg);
+		}
+		bool clause_match(const Handle& hp, const Handle& hg) {
+			return _own.clause_match(hp, hg);
+		}
+		void push(void) { _own.push(); }
+		void pop(void) { _own.pop(); }
+
+		bool evaluate_sentence(const Handle& eval,
+		                       const std::map<Handle,Handle>& gnds) {
+			std::lock_guard<std::mutex> lck(_mtx);
+			return _cb.evaluate_sentence(eval, gnds);
+		}
+		bool optional_clause_match(const Handle& hp, const Handle& hg) {
+			std::lock_guard<std::mutex> lck(_mtx);
+			return _cb.optional_clause_match(hp, hg);
+		}
+		bool grounding(const std::map<Handle, Handle> &var_soln,
+		               const std::map<Handle, Handle> &term_soln) {
+			std::lock_guard<std::mutex> lck(_mtx);
+			if (_stop) return true;
+			bool done = _cb.grounding(var_soln, term_soln);
+			if (done) _stop = true;
+			return done;
+		}
+
+		// The search itself is driven by InitiateSearchCB.
+		void set_pattern(const Variables&, const Pattern&) {}
+		bool initiate_search(PatternMatchEngine*) {
+			throw InvalidParamException(TRACE_INFO,
+			              "Not expecting a nested search here!");
+		}
+};
+
+} // namespace opencog
+
+/**
+ * Hand each candidate starting atom to explore_neighborhood(), until
+ * one of them reports a grounding that ends the search.
+ *
+ * With more than one search thread, the candidates are doled out in
+ * small chunks, first-come, first-served, so that a thread that drew
+ * some expensive candidates does not hold up the others.  Each thread
+ * explores with its own engine and its own clone of the callback,
+ * reporting through ParallelSearchCB.
+ *
+ * The search runs on one thread if the callback can't be cloned, or
+ * if the pattern has evaluatable terms: a GroundedPredicateNode may
+ * call into python or guile, and the caller may hold the GIL, or be
+ * in guile mode, while it waits for the threads.
+ */
+bool InitiateSearchCB::explore_candidates(PatternMatchEngine *pme,
+                                          const CandidateSource& next)
+{
+	HandleSeq chunk;
+	PatternMatchCallback& cb = pme->get_callback();
+	std::vector<std::unique_ptr<PatternMatchCallback>> clones;
+	if (1 < _search_threads and _pattern->evaluatable_terms.empty())
+	{
+		for (unsigned int i = 0; i < _search_threads; i++)
+		{
+			PatternMatchCallback* clone = cb.clone();
+			if (NULL == clone) break;
+			clones.emplace_back(clone);
+		}
+		if (clones.size() < _search_threads) clones.clear();
+	}
+
+	if (clones.empty())
+	{
+#ifdef DEBUG
+		size_t i = 0;
+#endif
+		while (next(chunk, 1024))
+		{
+			for (const Handle& h : chunk)
+			{
+				dbgprt("xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx\n");
+				dbgprt("Loop candidate (%lu):\n%s\n", ++i,
+				       h->toShortString().c_str());
+				_num_candidates++;
+				bool found = pme->explore_neighborhood(_root, _starter_term, h);
+
+				// Terminate search if satisfied.
+				if (found) return true;
+			}
+		}
+		return false;
+	}
+
+	std::mutex src_mtx;
+	std::mutex cb_mtx;
+	std::atomic<bool> stop(false);
+	std::atomic<size_t> explored(0);
+	std::exception_ptr failure;
+
+	auto worker = [&](PatternMatchCallback* own)
+	{
+		ParallelSearchCB pcb(cb, *own, cb_mtx, stop);
+		PatternMatchEngine wpme(pcb, *pme);
+		HandleSeq work;
+		try
+		{
+			while (not stop)
+			{
+				{
+					std::lock_guard<std::mutex> lck(src_mtx);
+					if (not next(work, 16)) return;
+				}
+				for (const Handle& h : work)
+				{
+					if (stop) return;
+					explored++;
+					wpme.explore_neighborhood(_root, _starter_term, h);
+				}
+			}
+		}
+		catch (...)
+		{
+			std::lock_guard<std::mutex> lck(src_mtx);
+			if (not failure) failure = std::current_exception();
+			stop = true;
+		}
+	};
+
+	std::vector<std::thread> pool;
+	for (std::unique_ptr<PatternMatchCallback>& clone : clones)
+		pool.push_back(std::thread(worker, clone.get()));
+	for (std::thread& t : pool)
+		t.join();
+
+	_num_candidates += explored;
+	if (failure) std::rethrow_exception(failure);
+	return stop;
+}
+
+/* ======================================================== */
+
+// Has the count gone up or down by more than a factor of two?  There's
+// some slack, so that small counts don't flip-flop.
+static inline bool drifted(size_t then, size_t now)
+{
+	return 2 * then + 64 < now or 2 * now + 64 < then;
+}
+
+/// Can a previously-made plan be used for the current search?  Only if
+/// it was made for the same clauses in the same atomspace, and neither
+/// the number of candidates it picked (width) nor the atomspace as a
+/// whole has changed much since.
+bool InitiateSearchCB::plan_fits(const SearchPlan& plan,
+                                 const HandleSeq& clauses,
+                                 size_t width)
+{
+	if (plan.atomspace != _as or plan.clauses != clauses) return false;
+	if (*plan.made_by != typeid(*this)) return false;
+	return not drifted(plan.width, width) and
+	       not drifted(plan.as_size, _as->get_size());
+}
+
+std::shared_ptr<const SearchPlan>
+InitiateSearchCB::make_plan(const HandleSeq& clauses,
+                            const Handle& root,
+                            const Handle& starter_term,
+                            const Handle& start,
+                            size_t width)
+{
+	std::shared_ptr<SearchPlan> plan(std::make_shared<SearchPlan>());
+	plan->atomspace = _as;
+	plan->clauses = clauses;
+	plan->made_by = &typeid(*this);
+	plan->root = root;
+	plan->starter_term = starter_term;
+	plan->start = start;
+	plan->width = width;
+	plan->as_size = _as->get_size();
+	return plan;
+}
+
+/// The plan that a callback of this type made, if any.
+std::shared_ptr<const SearchPlan>
+InitiateSearchCB::cached_plan(const PlanCache& cache)
+{
+	std::shared_ptr<const Pattern::SearchPlans> plans(std::atomic_load(&cache));
+	if (nullptr == plans) return nullptr;
+	for (const std::shared_ptr<const SearchPlan>& plan : *plans)
+		if (*plan->made_by == typeid(*this)) return plan;
+	return nullptr;
+}
+
+/// Replace the plan that a callback of this type made.  Two searches
+/// may race to do so, and one of the plans is then lost; that only
+/// costs the time to make it again.
+void InitiateSearchCB::cache_plan(PlanCache& cache,
+                                  const std::shared_ptr<const SearchPlan>& plan)
+{
+	std::shared_ptr<Pattern::SearchPlans> plans(
+		std::make_shared<Pattern::SearchPlans>());
+	std::shared_ptr<const Pattern::SearchPlans> old(std::atomic_load(&cache));
+	if (old)
+		for (const std::shared_ptr<const SearchPlan>& p : *old)
+			if (*p->made_by != *plan->made_by) plans->push_back(p);
+	plans->push_back(plan);
+	std::atomic_store(&cache,
+		std::shared_ptr<const Pattern::SearchPlans>(plans));
+}
+
+/* ======================================================== */
+/**
+ * The number of links that neighbor_search will walk, if it starts at
+ * the constant h, looking for groundings of the term that holds it.
+ * Only links of the same type as the holder can ground it, unless it
+ * is a quote or a redex, which the engine looks through.
+ */
+static size_t fan_in(const Handle& h, const Handle& holder)
+{
+	Type ht = (Handle::UNDEFINED == holder) ? NOTYPE : holder->getType();
+	if (NOTYPE == ht or QUOTE_LINK == ht or BETA_REDEX == ht)
+		return h->getIncomingSetSize();
+	return h->getIncomingSetSizeByType(ht);
+}
+
 /* ======================================================== */
 
 // Find a good place to start the search.
@@ -89,6 +383,13 @@ InitiateSearchCB::InitiateSearchCB(AtomSpace* as) :
 // set, but "blah" does not, then "blah" is a much better place to
 // start.
 //
+// More precisely, the search walks only those links in the incoming
+// set that have the same type as the term holding the constant (the
+// ListLink, for "item", above), so it is the number of those that is
+// the cost of starting there.  A ConceptNode used in a million
+// InheritanceLinks, but in only three ListLinks, is a fine place to
+// start looking for a ListLink.
+//
 // size_t& depth will be set to the depth of the thinnest constant found.
 // Handle& start will be set to the link containing that constant.
 // size_t& width will be set to the incoming-set size of the thinnest
@@ -106,7 +407,8 @@ InitiateSearchCB::find_starter(const Handle& h, size_t& depth,
 	Type t = h->getType();
 	if (_classserver.isNode(t)) {
 		if (t != VARIABLE_NODE) {
-			width = h->getIncomingSetSize();
+			// On the way in, start is the term holding this node.
+			width = fan_in(h, start);
 			return h;
 		}
 		return Handle::UNDEFINED;
@@ -211,25 +513,9 @@ Handle InitiateSearchCB::find_thinnest(const HandleSeq& clauses,
 
 /* ======================================================== */
 /**
- * Given a set of clauses, find a neighborhood to search, and perform
- * the search. A `neighborhood` is defined as all of the atoms that
- * can be reached from a given (non-variable) atom, by following either
- * it's incoming or its outgoing set.
- *
- * A neighborhood search is guaranteed to find all possible groundings
- * for the set of clauses. The reason for this is that, given a
- * non-variable atom in the pattern, any possible grounding of that
- * pattern must contain that atom, out of necessity. Thus, any possible
- * grounding must be contained in that neighborhood.  It is sufficient
- * to walk that graph until a suitable grounding is encountered.
- *
- * The return value is true if a grounding was found, else it returns
- * false. That is, this return value works just like all the other
- * satisfiability callbacks.  The flag '_search_fail' is set to true
- * if the search was not performed, due to a failure to find a sutiable
- * starting point.
+ * Pick, or re-use, the place at which neighbor_search() starts.
  */
-bool InitiateSearchCB::neighbor_search(PatternMatchEngine *pme)
+std::shared_ptr<const SearchPlan> InitiateSearchCB::find_neighbor_plan(void)
 {
 	// Sometimes, the number of mandatory clauses can be zero...
 	// We still want to search, though.
@@ -249,9 +535,56 @@ bool InitiateSearchCB::neighbor_search(PatternMatchEngine *pme)
 	// Note also: the user is allowed to specify patterns that have
 	// no constants in them at all.  In this case, the search is
 	// performed by looping over all links of the given types.
-	size_t bestclause;
-	Handle best_start = find_thinnest(clauses, _pattern->evaluatable_holders,
-	                                  _starter_term, bestclause);
+	//
+	// Finding the thinnest clause means walking all of them, so the
+	// result is kept with the pattern, and re-used, until the incoming
+	// set that was picked has grown or shrunk a lot.  A stale choice
+	// only costs speed: any constant at all is a valid place to start.
+	std::shared_ptr<const SearchPlan> plan(
+		cached_plan(_pattern->neighbor_plans));
+	if (nullptr == plan or not plan_fits(*plan, clauses,
+	          (Handle::UNDEFINED == plan->start) ?
+	                 0 : fan_in(plan->start, plan->starter_term)))
+	{
+		size_t bestclause;
+		Handle term;
+		Handle start = find_thinnest(clauses, _pattern->evaluatable_holders,
+		                             term, bestclause);
+		if (Handle::UNDEFINED == start)
+			plan = make_plan(clauses, Handle::UNDEFINED, term, start, 0);
+		else
+			plan = make_plan(clauses, clauses[bestclause], term, start,
+			                 fan_in(start, term));
+		cache_plan(_pattern->neighbor_plans, plan);
+	}
+	return plan;
+}
+
+/* ======================================================== */
+/**
+ * Given a set of clauses, find a neighborhood to search, and perform
+ * the search. A `neighborhood` is defined as all of the atoms that
+ * can be reached from a given (non-variable) atom, by following either
+ * it's incoming or its outgoing set.
+ *
+ * A neighborhood search is guaranteed to find all possible groundings
+ * for the set of clauses. The reason for this is that, given a
+ * non-variable atom in the pattern, any possible grounding of that
+ * pattern must contain that atom, out of necessity. Thus, any possible
+ * grounding must be contained in that neighborhood.  It is sufficient
+ * to walk that graph until a suitable grounding is encountered.
+ *
+ * The return value is true if a grounding was found, else it returns
+ * false. That is, this return value works just like all the other
+ * satisfiability callbacks.  The flag '_search_fail' is set to true
+ * if the search was not performed, due to a failure to find a sutiable
+ * starting point.
+ */
+bool InitiateSearchCB::neighbor_search(PatternMatchEngine *pme)
+{
+	std::shared_ptr<const SearchPlan> plan(find_neighbor_plan());
+	Handle best_start(plan->start);
+	_starter_term = plan->starter_term;
 
 	// Cannot find a starting point! This can happen if all of the
 	// clauses contain nothing but variables, or if all of the
@@ -264,7 +597,7 @@ bool InitiateSearchCB::neighbor_search(PatternMatchEngine *pme)
 		return false;
 	}
 
-	_root = clauses[bestclause];
+	_root = plan->root;
 	dbgprt("Search start node: %s\n", best_start->toShortString().c_str());
 	dbgprt("Start term is: %s\n", _starter_term == Handle::UNDEFINED ?
 	       "UNDEFINED" : _starter_term->toShortString().c_str());
@@ -272,24 +605,28 @@ bool InitiateSearchCB::neighbor_search(PatternMatchEngine *pme)
 
 	// This should be calling the over-loaded virtual method
 	// get_incoming_set(), so that, e.g. it gets sorted by attentional
-	// focus in the AttentionalFocusCB class...
-	IncomingSet iset = get_incoming_set(best_start);
-	size_t sz = iset.size();
-	for (size_t i = 0; i < sz; i++)
-	{
-		Handle h(iset[i]);
-		dbgprt("xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx\n");
-		dbgprt("Loop candidate (%lu/%lu):\n%s\n", i+1, sz,
-		       h->toShortString().c_str());
-		bool found = pme->explore_neighborhood(_root, _starter_term, h);
-
-		// Terminate search if satisfied.
-		if (found) return true;
-	}
+	// focus in the AttentionalFocusCB class...  Only links of the
+	// same type as the starter term can ground it, unless it is a
+	// quote or a redex, which the engine looks through.
+	IncomingSet iset;
+	Type st = (Handle::UNDEFINED == _starter_term) ?
+		NOTYPE : _starter_term->getType();
+	if (NOTYPE == st or QUOTE_LINK == st or BETA_REDEX == st)
+		iset = get_incoming_set(best_start);
+	else
+		iset = get_incoming_set(best_start, st);
+	size_t pos = 0;
+	bool found = explore_candidates(pme,
+		[&](HandleSeq& chunk, size_t n)->bool {
+			chunk.clear();
+			for (; pos < iset.size() and chunk.size() < n; pos++)
+				chunk.push_back(Handle(iset[pos]));
+			return not chunk.empty();
+		});
 
-	// If we are here, we have searched the entire neighborhood, and
-	// no satisfiable groundings were found.
-	return false;
+	// If we are here, and found is false, we have searched the entire
+	// neighborhood, and no satisfiable groundings were found.
+	return found;
 }
 
 /* ======================================================== */
@@ -390,6 +727,7 @@ void InitiateSearchCB::set_pattern(const Variables& vars,
                                    const Pattern& pat)
 {
 	_search_fail = false;
+	_num_candidates = 0;
 	_variables = &vars;
 	_pattern = &pat;
 	_type_restrictions = &vars.typemap;
@@ -546,23 +884,38 @@ bool InitiateSearchCB::link_type_search(PatternMatchEngine *pme)
 	const HandleSeq& clauses = _pattern->mandatory;
 
 	_search_fail = false;
-	_root = Handle::UNDEFINED;
-	_starter_term = Handle::UNDEFINED;
-	size_t count = SIZE_MAX;
 
-	for (const Handle& cl: clauses)
+	// As with the neighbor search, re-use the previous choice, unless
+	// the number of atoms of that type has changed a lot.
+	std::shared_ptr<const SearchPlan> plan(
+		cached_plan(_pattern->link_type_plans));
+	if (nullptr == plan or not plan_fits(*plan, clauses,
+	          (Handle::UNDEFINED == plan->starter_term) ? 0 :
+	          _as->get_num_atoms_of_type(plan->starter_term->getType())))
 	{
-		// Evaluatables don't exist in the atomspace, in general.
-		// Cannot start a search with them.
-		if (0 < _pattern->evaluatable_holders.count(cl)) continue;
-		size_t prev = count;
-		find_rarest(cl, _starter_term, count);
-		if (count < prev)
+		Handle root(Handle::UNDEFINED);
+		Handle term(Handle::UNDEFINED);
+		size_t count = SIZE_MAX;
+
+		for (const Handle& cl: clauses)
 		{
-			prev = count;
-			_root = cl;
+			// Evaluatables don't exist in the atomspace, in general.
+			// Cannot start a search with them.
+			if (0 < _pattern->evaluatable_holders.count(cl)) continue;
+			size_t prev = count;
+			find_rarest(cl, term, count);
+			if (count < prev)
+			{
+				prev = count;
+				root = cl;
+			}
 		}
+		if (Handle::UNDEFINED == root) count = 0;
+		plan = make_plan(clauses, root, term, term, count);
+		cache_plan(_pattern->link_type_plans, plan);
 	}
+	_root = plan->root;
+	_starter_term = plan->starter_term;
 
 	// The URE Reasoning case: if we found nothing, then there are no
 	// links!  Ergo, every clause must be a lone variable, all by
@@ -582,21 +935,13 @@ bool InitiateSearchCB::link_type_search(PatternMatchEngine *pme)
 	// Get type of the rarest link
 	Type ptype = _starter_term->getType();
 
-	HandleSeq handle_set;
-	_as->get_handles_by_type(handle_set, ptype);
-
-#ifdef DEBUG
-	size_t i = 0;
-#endif
-	for (const Handle& h : handle_set)
-	{
-		dbgprt("yyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyyy\n");
-		dbgprt("Loop candidate (%lu/%lu):\n%s\n", ++i, handle_set.size(),
-		       h->toShortString().c_str());
-		bool found = pme->explore_neighborhood(_root, _starter_term, h);
-		if (found) return true;
-	}
-	return false;
+	// Stream through the atoms of that type, rather than copying them
+	// all out first; the search may well stop early.
+	AtomTable::TypeCursor cursor(_as->get_type_cursor(ptype));
+	return explore_candidates(pme,
+		[&](HandleSeq& chunk, size_t n)->bool {
+			return cursor.next(chunk, n);
+		});
 }
 
 /* ======================================================== */
@@ -681,27 +1026,15 @@ bool InitiateSearchCB::variable_search(PatternMatchEngine *pme)
 		_root = _starter_term = clauses[0];
 	}
 
-	HandleSeq handle_set;
-	if (ptype == ATOM)
-		_as->get_handles_by_type(handle_set, ptype, true);
-	else
-		_as->get_handles_by_type(handle_set, ptype);
-
-	dbgprt("Atomspace reported %lu atoms\n", handle_set.size());
+	AtomTable::TypeCursor cursor(_as->get_type_cursor(ptype, ptype == ATOM));
 
-#ifdef DEBUG
-	size_t i = 0;
-#endif
-	for (const Handle& h : handle_set)
-	{
-		dbgprt("zzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzz\n");
-		dbgprt("Loop candidate (%lu/%lu):\n%s\n", ++i, handle_set.size(),
-		       h->toShortString().c_str());
-		bool found = pme->explore_neighborhood(_root, _starter_term, h);
-		if (found) return true;
-	}
+	dbgprt("Atomspace reported %d atoms\n",
+	       _as->get_num_atoms_of_type(ptype, ptype == ATOM));
 
-	return false;
+	return explore_candidates(pme,
+		[&](HandleSeq& chunk, size_t n)->bool {
+			return cursor.next(chunk, n);
+		});
 }
 
 /* ===================== END OF FILE ===================== */
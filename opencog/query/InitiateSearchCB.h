@@ -25,6 +25,9 @@
 #ifndef _OPENCOG_INITIATE_SEARCH_H
 #define _OPENCOG_INITIATE_SEARCH_H
 
+#include <functional>
+#include <memory>
+
 #include <opencog/atomspace/types.h>
 #include <opencog/atomspace/AtomSpace.h>
 #include <opencog/query/PatternMatchCallback.h>
@@ -52,6 +55,38 @@ class InitiateSearchCB : public virtual PatternMatchCallback
 		virtual void set_pattern(const Variables&, const Pattern&);
 		virtual bool initiate_search(PatternMatchEngine *);
 
+		/**
+		 * Explore the candidate starting atoms on this many threads,
+		 * each with a PatternMatchEngine of its own.  The default is
+		 * one thread: the plain, sequential search.
+		 *
+		 * Each engine matches with its own clone() of the callback;
+		 * only grounding(), evaluate_sentence() and
+		 * optional_clause_match() are made on this one, under a lock,
+		 * one at a time.  Once grounding() returns true, all threads
+		 * stop.  A callback that can't be cloned, and a pattern with
+		 * evaluatable terms, are searched on one thread.
+		 */
+		void set_search_threads(unsigned int n) { _search_threads = n; }
+
+		/// The number of threads that the stock callbacks (bindlink,
+		/// satisfaction_link, and so on) search with; set by the
+		/// PATTERN_MATCHER_THREADS config parameter.  The default is 1.
+		static unsigned int default_search_threads(void);
+
+		/// Where the last search started: the clause, the term within
+		/// it, and how many candidate groundings for that term were
+		/// explored.  For benchmarks and debugging.
+		const Handle& get_root(void) const { return _root; }
+		const Handle& get_starter_term(void) const { return _starter_term; }
+		size_t get_num_candidates(void) const { return _num_candidates; }
+
+		/// The place that neighbor_search() would start at, for the
+		/// current pattern; the start is UNDEFINED if the pattern has
+		/// no constants in it.  Used to share one pass over the
+		/// candidates between several patterns; see MultiImplicator.
+		std::shared_ptr<const SearchPlan> find_neighbor_plan(void);
+
 	protected:
 
 		ClassServer& _classserver;
@@ -70,12 +105,30 @@ class InitiateSearchCB : public virtual PatternMatchCallback
 		                             Handle&, size_t&);
 		virtual void find_rarest(const Handle&, Handle&, size_t&);
 
+		// Starting points for neighbor_search() and link_type_search()
+		// are cached on the Pattern, one per callback type; see
+		// SearchPlan.
+		typedef std::shared_ptr<const Pattern::SearchPlans> PlanCache;
+		std::shared_ptr<const SearchPlan> cached_plan(const PlanCache&);
+		void cache_plan(PlanCache&, const std::shared_ptr<const SearchPlan>&);
+		bool plan_fits(const SearchPlan&, const HandleSeq&, size_t);
+		std::shared_ptr<const SearchPlan> make_plan(const HandleSeq&,
+		              const Handle&, const Handle&, const Handle&, size_t);
+
 		bool _search_fail;
 		virtual bool neighbor_search(PatternMatchEngine *);
 		virtual bool disjunct_search(PatternMatchEngine *);
 		virtual bool link_type_search(PatternMatchEngine *);
 		virtual bool variable_search(PatternMatchEngine *);
 
+		// Fills the vector with up to the given number of candidate
+		// starting atoms; returns false once there are no more.
+		typedef std::function<bool(HandleSeq&, size_t)> CandidateSource;
+		unsigned int _search_threads;
+		size_t _num_candidates;
+		bool explore_candidates(PatternMatchEngine *,
+		                        const CandidateSource&);
+
 		AtomSpace *_as;
 };
 
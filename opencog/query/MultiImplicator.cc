@@ -0,0 +1,287 @@
+/*
+ * MultiImplicator.cc
+ *
+ * Copyright (C) 2015 OpenCog Foundation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <opencog/util/exceptions.h>
+#include <opencog/atomspace/ClassServer.h>
+
+#include "BindLinkAPI.h"
+#include "MultiImplicator.h"
+
+using namespace opencog;
+
+MultiImplicator::MultiImplicator(AtomSpace* as) :
+	_as(as), _num_shared(0), _num_pruned(0)
+{}
+
+MultiImplicator::~MultiImplicator()
+{}
+
+size_t MultiImplicator::add(const Handle& bindlink)
+{
+	Rule* r = new Rule;
+	r->bindlink = bindlink;
+	_rules.push_back(std::unique_ptr<Rule>(r));
+	return _rules.size() - 1;
+}
+
+/* ======================================================== */
+
+/// Set up the engine for the rule, and find where its search would
+/// start.  Returns false if the rule cannot take part in the shared
+/// search, and has to be grounded on its own.
+bool MultiImplicator::prepare(Rule& r)
+{
+	r.bl = BindLinkCast(r.bindlink);
+	if (NULL == r.bl)
+		r.bl = createBindLink(*LinkCast(r.bindlink));
+	r.impl.reset(new Deferred(_as));
+	r.impl->set_evaluation_memo(_memo);
+	r.impl->implicand = r.bl->get_implicand();
+
+	// Disconnected patterns are joined by PatternLink::satisfy(), and
+	// the absent clauses are sorted out by do_imply(), only after an
+	// exhaustive search; and a lone ChoiceLink is several searches,
+	// not one.  Leave all of these to bindlink().
+	if (1 != r.bl->get_num_comps()) return false;
+	const Variables& vars = r.bl->get_variables();
+	const Pattern& pat = r.bl->get_pattern();
+	if (0 < pat.optionals.size()) return false;
+	if (1 == pat.mandatory.size() and
+	    CHOICE_LINK == pat.mandatory[0]->getType()) return false;
+
+	r.pme.reset(new PatternMatchEngine(*r.impl, vars, pat));
+	r.impl->set_pattern(vars, pat);
+
+	r.plan = r.impl->find_neighbor_plan();
+	return Handle::UNDEFINED != r.plan->start and
+	       Handle::UNDEFINED != r.plan->starter_term;
+}
+
+/// Search for the groundings of a rule that does not take part in the
+/// shared search; the same search that bindlink() does.
+void MultiImplicator::search_alone(Rule& r)
+{
+	r.impl->set_search_threads(InitiateSearchCB::default_search_threads());
+	r.bl->imply(*r.impl, false);
+}
+
+/// Create the results of a rule, once all of the searches are done.
+/// As in do_imply(), a pattern made only of absent clauses, none of
+/// which were found, is instantiated once, with no groundings.
+Handle MultiImplicator::instantiate(Rule& r)
+{
+	Deferred& impl = *r.impl;
+	for (const std::map<Handle, Handle>& g : impl.groundings)
+	{
+		Handle h = impl.inst.instantiate(impl.implicand, g);
+		if (Handle::UNDEFINED != h)
+			impl.result_list.push_back(h);
+	}
+
+	const Pattern& pat = r.bl->get_pattern();
+	if (impl.groundings.empty() and 0 == pat.mandatory.size() and
+	    0 < pat.optionals.size() and not impl.optionals_present())
+	{
+		std::map<Handle, Handle> empty_map;
+		Handle h = impl.inst.instantiate(impl.implicand, empty_map);
+		if (Handle::UNDEFINED != h)
+			impl.result_list.push_back(h);
+	}
+
+	return _as->add_link(SET_LINK, impl.result_list);
+}
+
+/* ======================================================== */
+
+/// Terms that the engine does not compare atom-by-atom: it looks
+/// through quotes and redexes, tries each alternative of a ChoiceLink,
+/// and evaluates or executes the rest.  Any candidate might fit these.
+bool MultiImplicator::opaque(const Handle& h, const Pattern& pat)
+{
+	Type t = h->getType();
+	if (QUOTE_LINK == t or BETA_REDEX == t or CHOICE_LINK == t)
+		return true;
+	return 0 < pat.evaluatable_terms.count(h) or
+	       0 < pat.executable_terms.count(h);
+}
+
+/// The shape of a term: what shape_fits() looks at, written out, so
+/// that terms with equal keys fit exactly the same candidates.
+std::string MultiImplicator::shape_key(const Handle& h,
+                                       const Variables& vars,
+                                       const Pattern& pat)
+{
+	if (0 < vars.varset.count(h) or opaque(h, pat)) return "*";
+
+	std::string key(std::to_string(h->getType()));
+	LinkPtr l(LinkCast(h));
+	if (NULL == l)
+		return key + ":" + std::to_string(h.value());
+
+	const HandleSeq& oset = l->getOutgoingSet();
+	if (classserver().isA(h->getType(), UNORDERED_LINK))
+		return key + "{" + std::to_string(oset.size()) + "}";
+
+	key += "(";
+	for (const Handle& ho : oset)
+		key += shape_key(ho, vars, pat) + " ";
+	return key + ")";
+}
+
+/// A quick check of a candidate against a term, before running the
+/// engine on it: the link types, arities and constants have to be the
+/// same.  This is conservative; anything that the engine might accept,
+/// it accepts.
+bool MultiImplicator::shape_fits(const Handle& term, const Handle& cand,
+                                 const Variables& vars,
+                                 const Pattern& pat)
+{
+	if (term == cand) return true;
+	if (0 < vars.varset.count(term) or opaque(term, pat)) return true;
+
+	Type t = term->getType();
+	if (t != cand->getType()) return false;
+
+	// Distinct nodes never match.
+	LinkPtr lterm(LinkCast(term));
+	if (NULL == lterm) return false;
+
+	const HandleSeq& tset = lterm->getOutgoingSet();
+	const HandleSeq& cset = LinkCast(cand)->getOutgoingSet();
+	if (tset.size() != cset.size()) return false;
+	if (classserver().isA(t, UNORDERED_LINK)) return true;
+
+	for (size_t i = 0; i < tset.size(); i++)
+		if (not shape_fits(tset[i], cset[i], vars, pat)) return false;
+	return true;
+}
+
+/* ======================================================== */
+
+HandleSeq MultiImplicator::run(void)
+{
+	// Build the network.  Nothing is instantiated until all of the
+	// searches are done, so none of them sees the results of another.
+	std::map<std::pair<Handle, Type>, Branch> net;
+	for (size_t i = 0; i < _rules.size(); i++)
+	{
+		Rule& r = *_rules[i];
+		if (not prepare(r))
+		{
+			search_alone(r);
+			continue;
+		}
+		_num_shared++;
+
+		// Same as in neighbor_search(): only links of the type of the
+		// starter term are walked, unless the engine looks through it.
+		const Handle& term = r.plan->starter_term;
+		Type st = term->getType();
+		if (QUOTE_LINK == st or BETA_REDEX == st) st = NOTYPE;
+
+		Branch& b = net[std::make_pair(r.plan->start, st)];
+		b.start = r.plan->start;
+		b.type = st;
+		Shape& s = b.shapes[shape_key(term, r.bl->get_variables(),
+		                              r.bl->get_pattern())];
+		if (s.rules.empty()) s.proto = &r;
+		s.rules.push_back(&r);
+	}
+
+	// One walk over the candidates of each branch, for all of the
+	// rules in it.
+	for (auto& bp : net)
+	{
+		Branch& b = bp.second;
+		PatternMatchCallback& cb = *b.shapes.begin()->second.proto->impl;
+		IncomingSet iset = (NOTYPE == b.type) ?
+			cb.get_incoming_set(b.start) :
+			cb.get_incoming_set(b.start, b.type);
+
+		for (size_t pos = 0; pos < iset.size(); pos++)
+		{
+			Handle cand(iset[pos]);
+			for (auto& sp : b.shapes)
+			{
+				Shape& s = sp.second;
+				const Rule& p = *s.proto;
+				if (not shape_fits(p.plan->starter_term, cand,
+				                   p.bl->get_variables(), p.bl->get_pattern()))
+				{
+					_num_pruned++;
+					continue;
+				}
+				// Deferred::grounding() never stops the search, so
+				// every candidate is explored, for every rule.
+				for (Rule* r : s.rules)
+					r->pme->explore_neighborhood(r->plan->root,
+					                   r->plan->starter_term, cand);
+			}
+		}
+	}
+
+	HandleSeq results;
+	for (const auto& r : _rules)
+		results.push_back(instantiate(*r));
+	return results;
+}
+
+/* ======================================================== */
+
+namespace opencog
+{
+
+/**
+ * Ground a set of BindLinks together, sharing the search between the
+ * ones that start at the same place; see MultiImplicator.  All of
+ * them are run against the atomspace as it was before any of them
+ * ran.  Returns one SetLink per BindLink, in the same order.
+ */
+HandleSeq do_multi_imply(AtomSpace* as, const HandleSeq& bindlinks)
+{
+	MultiImplicator mi(as);
+	mi.set_evaluation_memo(DefaultPatternMatchCB::default_evaluation_memo());
+	for (const Handle& h : bindlinks)
+		mi.add(h);
+	return mi.run();
+}
+
+/**
+ * The scheme-friendly version: the argument is a ListLink of
+ * BindLinks, and the result is a ListLink of SetLinks, one for each
+ * of the BindLinks, in the same order.  Not a SetLink: its order is
+ * not the order that it was written in.
+ */
+Handle multi_bindlink(AtomSpace* as, const Handle& hlist)
+{
+	LinkPtr lp(LinkCast(hlist));
+	if (NULL == lp or LIST_LINK != lp->getType())
+		throw InvalidParamException(TRACE_INFO,
+			"Expecting a ListLink of BindLinks, got %s",
+			hlist->toShortString().c_str());
+
+	return as->add_link(LIST_LINK,
+		do_multi_imply(as, lp->getOutgoingSet()));
+}
+
+}
+
+/* ===================== END OF FILE ===================== */
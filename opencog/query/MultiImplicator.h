@@ -0,0 +1,154 @@
+/*
+ * MultiImplicator.h
+ *
+ * Copyright (C) 2015 OpenCog Foundation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _OPENCOG_MULTI_IMPLICATOR_H
+#define _OPENCOG_MULTI_IMPLICATOR_H
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <opencog/atomspace/AtomSpace.h>
+#include <opencog/atoms/bind/BindLink.h>
+
+#include "DefaultImplicator.h"
+#include "PatternMatchEngine.h"
+
+namespace opencog {
+
+/**
+ * Ground a whole set of BindLinks, such as the rules of a rule base,
+ * in one pass over the atomspace, instead of one search per rule.
+ *
+ * The rules are sorted into a small discrimination network.  The first
+ * level is the place where neighbor_search() would start each rule:
+ * a constant atom, and the type of the links, holding it, that are
+ * walked.  Rules that start at the same place share one walk over
+ * that incoming set.  The second level is the shape of the starter
+ * term: its link types, arities and constants, with the variables
+ * blanked out.  A candidate is checked against each shape just once;
+ * if it does not fit, none of the rules with that shape are tried.
+ * Only the candidates that fit are handed to the engines of the
+ * individual rules.
+ *
+ * Rules that cannot be started from a constant (no constants, a lone
+ * ChoiceLink, several components, or AbsentLinks) are searched on
+ * their own, as bindlink() would.
+ *
+ * All of the rules are run against the atomspace as it was when run()
+ * was called: the groundings of every rule are found first, and only
+ * then are the implicands instantiated.  So no rule ever sees what
+ * another one, or it itself, creates, and the results do not depend
+ * on the order of the rules.  Where the output of one rule would match
+ * another, the results differ from calling bindlink() on each rule in
+ * turn; run() again to chain them.
+ */
+class MultiImplicator
+{
+	public:
+		MultiImplicator(AtomSpace*);
+		~MultiImplicator();
+
+		/// Add a rule; returns its index in the results.
+		size_t add(const Handle& bindlink);
+
+		/// Share the memo between all of the rules; see
+		/// DefaultPatternMatchCB::set_evaluation_memo().
+		void set_evaluation_memo(const std::shared_ptr<EvaluationMemo>& m)
+		{ _memo = m; }
+
+		/// Ground all of the rules added so far.  Returns one SetLink
+		/// of results per rule, in the order that they were added.
+		HandleSeq run(void);
+
+		/// The number of rules grounded by the shared search, and the
+		/// number of candidates rejected by shape before any engine
+		/// saw them.  For tests and benchmarks.
+		size_t get_num_shared(void) const { return _num_shared; }
+		size_t get_num_pruned(void) const { return _num_pruned; }
+
+	private:
+		/// Remembers the groundings, instead of instantiating the
+		/// implicand right away.
+		class Deferred : public DefaultImplicator
+		{
+			public:
+				Deferred(AtomSpace* as) :
+					Implicator(as),
+					InitiateSearchCB(as),
+					DefaultPatternMatchCB(as),
+					DefaultImplicator(as)
+				{}
+				std::vector<std::map<Handle, Handle>> groundings;
+
+				virtual bool grounding(const std::map<Handle, Handle>& var_soln,
+				                       const std::map<Handle, Handle>&)
+				{
+					groundings.push_back(var_soln);
+					return false;
+				}
+
+				virtual PatternMatchCallback* clone(void)
+				{ return clone_matcher(); }
+		};
+
+		struct Rule
+		{
+			Handle bindlink;
+			BindLinkPtr bl;
+			std::unique_ptr<Deferred> impl;
+			std::unique_ptr<PatternMatchEngine> pme;
+			std::shared_ptr<const SearchPlan> plan;
+		};
+
+		struct Shape
+		{
+			Rule* proto;
+			std::vector<Rule*> rules;
+		};
+
+		struct Branch
+		{
+			Handle start;
+			Type type;
+			std::map<std::string, Shape> shapes;
+		};
+
+		AtomSpace* _as;
+		std::shared_ptr<EvaluationMemo> _memo;
+		std::vector<std::unique_ptr<Rule>> _rules;
+		size_t _num_shared;
+		size_t _num_pruned;
+
+		bool prepare(Rule&);
+		void search_alone(Rule&);
+		Handle instantiate(Rule&);
+		static bool opaque(const Handle&, const Pattern&);
+		static std::string shape_key(const Handle&, const Variables&,
+		                             const Pattern&);
+		static bool shape_fits(const Handle&, const Handle&,
+		                       const Variables&, const Pattern&);
+};
+
+} // namespace opencog
+
+#endif // _OPENCOG_MULTI_IMPLICATOR_H
@@ -25,8 +25,10 @@
 #define _OPENCOG_PATTERN_H
 
 #include <map>
+#include <memory>
 #include <set>
 #include <stack>
+#include <typeinfo>
 #include <unordered_map>
 #include <vector>
 
@@ -35,6 +37,8 @@
 
 namespace opencog {
 
+class AtomSpace;
+
 /** \addtogroup grp_atomspace
  *  @{
  */
@@ -66,6 +70,35 @@ struct Variables
 	std::map<Handle, unsigned int> index;
 };
 
+/// Where to start a search, as worked out by InitiateSearchCB the
+/// first time a pattern is searched for.  It is kept with the Pattern,
+/// and re-used for later searches, until the atom counts that the
+/// choice was based on have drifted too far.
+///
+/// Callbacks may pick the starting point their own way (by overriding
+/// find_starter() or find_thinnest()), so a plan is only ever re-used
+/// by a callback of the same type as the one that made it.
+///
+struct SearchPlan
+{
+	// What the plan was made for, and who made it.
+	const AtomSpace* atomspace;
+	HandleSeq clauses;
+	const std::type_info* made_by;
+
+	// The clause, and the term in it, to start at, and the atom whose
+	// incoming set (or the link type, whose atoms) will be explored.
+	// All undefined if no such start exists.
+	Handle root;
+	Handle starter_term;
+	Handle start;
+
+	// The number of candidates to explore, and the size of the
+	// atomspace, at the time the plan was made.
+	size_t width;
+	size_t as_size;
+};
+
 /// The Pattern struct defines a search pattern in a way that makes it
 /// easier and faster to work with in C++.  It implements the data that
 /// is shared between the various pattern-specification atoms and the
@@ -127,6 +160,14 @@ struct Pattern
 	// after one clause is solved, we know what parts of the unsolved
 	// clauses already have a solution.
 	ConnectMap       connectivity_map;     // setup by make_connectivity_map()
+
+	// Cached search plans, at most one per callback type; see
+	// InitiateSearchCB.  The lists are replaced as a whole, never
+	// modified, so they can be shared by concurrent searches (use
+	// std::atomic_load and std::atomic_store).
+	typedef std::vector<std::shared_ptr<const SearchPlan>> SearchPlans;
+	mutable std::shared_ptr<const SearchPlans> neighbor_plans;
+	mutable std::shared_ptr<const SearchPlans> link_type_plans;
 };
 
 /** @}*/
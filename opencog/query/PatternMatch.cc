@@ -21,6 +21,8 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
  */
 
+#include <unordered_map>
+
 #include <opencog/util/Logger.h>
 
 #include <opencog/atoms/bind/BindLink.h>
@@ -29,6 +31,7 @@
 
 #include <opencog/atomspace/AtomSpace.h>
 #include <opencog/atomspace/ClassServer.h>
+#include <opencog/atomutils/FindUtils.h>
 
 #include "PatternMatch.h"
 #include "PatternMatchEngine.h"
@@ -86,6 +89,9 @@ class PMCGroundings : public PatternMatchCallback
 		IncomingSet get_incoming_set(const Handle& h) {
 			return _cb.get_incoming_set(h);
 		}
+		IncomingSet get_incoming_set(const Handle& h, Type t) {
+			return _cb.get_incoming_set(h, t);
+		}
 		void push(void) { _cb.push(); }
 		void pop(void) { _cb.pop(); }
 		void set_pattern(const Variables& vars,
@@ -114,118 +120,316 @@ class PMCGroundings : public PatternMatchCallback
 };
 
 /**
- * Recursive evaluator/grounder/unifier of virtual link types.
- * The virtual links are in 'virtuals', a partial set of groundings
- * are in 'var_gnds' and 'term_gnds', and a collection of possible
- * groundings for disconnected graph components are in 'comp_var_gnds'
- * and 'comp_term_gnds'.
+ * A join plan for the groundings of the disconnected components.
+ *
+ * The components are grounded independently; a full grounding is one
+ * grounding from each component, and there are N_0 * N_1 * ... N_m of
+ * those.  Rather than building each one of these, and only then running
+ * it through the virtual clauses, the components are stacked up one at
+ * a time, and each virtual clause is evaluated as soon as all of the
+ * components it refers to have been grounded.  Combinations that fail
+ * a virtual clause early on are thus never extended any further.
  *
- * Notes below explain the recursive step: how the various disconnected
- * components are brought together into a candidate grounding. That
- * candidate is then run through each of the virtual links.  If these
- * accept the grounding, then the callback is called to make the final
- * determination.
+ * In addition, an EqualLink between variables of two different
+ * components is turned into a hash join: the groundings of the second
+ * component are indexed by the grounding of its variable, and only
+ * those that match the grounding of the first are tried.  This
+ * relies on EqualLink meaning identity, as EvaluationLink::do_evaluate
+ * has it.
  *
- * The recursion step terminates when comp_var_gnds, comp_term_gnds
- * are empty, at which point the actual unification is done.
+ * The groundings are accumulated, in place, in a single pair of maps,
+ * and the entries are removed again when backing out of a level, so
+ * nothing gets copied.
  */
-bool PatternMatch::recursive_virtual(PatternMatchCallback& cb,
-            const std::vector<Handle>& virtuals,
-            const std::vector<Handle>& negations, // currently ignored
-            const std::map<Handle, Handle>& var_gnds,
-            const std::map<Handle, Handle>& term_gnds,
-            // copies, NOT references!
-            std::vector<std::vector<std::map<Handle, Handle>>> comp_var_gnds,
-            std::vector<std::vector<std::map<Handle, Handle>>> comp_term_gnds)
+class VirtualJoin
+{
+	private:
+		typedef std::vector<std::map<Handle, Handle>> GroundingSeq;
+
+		PatternMatchCallback& _cb;
+		const GroundingSeq* _comp_var_gnds;
+		const GroundingSeq* _comp_term_gnds;
+
+		struct Level
+		{
+			// The component grounded at this level.
+			size_t comp;
+
+			// The virtual clauses that can be evaluated once this
+			// level is grounded.
+			HandleSeq virtuals;
+
+			// If non-null, a hash join: the groundings of this
+			// component, indexed by the grounding of join_var, must
+			// agree with the grounding of key_var.
+			Handle key_var;
+			Handle join_var;
+			std::unordered_map<Handle, std::vector<size_t>, handle_hash> index;
+		};
+		std::vector<Level> _levels;
+
+		// The virtual clauses that refer to no component at all.
+		HandleSeq _leftovers;
+
+		std::map<Handle, Handle> _var_gnds;
+		std::map<Handle, Handle> _term_gnds;
+
+		bool try_grounding(size_t lvl, size_t i);
+		bool recurse(size_t lvl);
+
+	public:
+		VirtualJoin(PatternMatchCallback&,
+		            const HandleSeq& virtuals,
+		            const std::vector<std::set<Handle>>& comp_vars,
+		            const std::vector<GroundingSeq>& comp_var_gnds,
+		            const std::vector<GroundingSeq>& comp_term_gnds);
+
+		bool run(void) { return recurse(0); }
+};
+
+VirtualJoin::VirtualJoin(PatternMatchCallback& cb,
+                         const HandleSeq& virtuals,
+                         const std::vector<std::set<Handle>>& comp_vars,
+                         const std::vector<GroundingSeq>& comp_var_gnds,
+                         const std::vector<GroundingSeq>& comp_term_gnds)
+	: _cb(cb),
+	_comp_var_gnds(comp_var_gnds.data()),
+	_comp_term_gnds(comp_term_gnds.data())
+{
+	size_t ncomps = comp_var_gnds.size();
+
+	// Which components does each virtual clause refer to?
+	std::vector<std::set<size_t>> virt_comps;
+	for (const Handle& virt : virtuals)
+	{
+		std::set<size_t> comps;
+		for (size_t c = 0; c < ncomps; c++)
+		{
+			for (const Handle& v : comp_vars[c])
+			{
+				if (is_atom_in_tree(virt, v))
+				{
+					comps.insert(c);
+					break;
+				}
+			}
+		}
+		virt_comps.push_back(comps);
+	}
+
+	// The EqualLinks that can serve as hash joins: one variable on
+	// each side, in two different components.
+	std::vector<std::pair<size_t, size_t>> eq_comps(virtuals.size(),
+	                                                {ncomps, ncomps});
+	for (size_t k = 0; k < virtuals.size(); k++)
+	{
+		if (EQUAL_LINK != virtuals[k]->getType()) continue;
+		const HandleSeq& oset = LinkCast(virtuals[k])->getOutgoingSet();
+		if (2 != oset.size()) continue;
+		for (size_t c = 0; c < ncomps; c++)
+		{
+			if (comp_vars[c].count(oset[0])) eq_comps[k].first = c;
+			if (comp_vars[c].count(oset[1])) eq_comps[k].second = c;
+		}
+		if (eq_comps[k].first == eq_comps[k].second)
+			eq_comps[k] = {ncomps, ncomps};
+	}
+
+	// Pick the order in which to stack up the components.  Greedily:
+	// a component that can be hash-joined onto those already placed,
+	// if there is one, and otherwise the one with fewest groundings.
+	std::vector<bool> placed(ncomps, false);
+	std::vector<bool> done(virtuals.size(), false);
+	for (size_t lvl = 0; lvl < ncomps; lvl++)
+	{
+		size_t best = ncomps;
+		size_t best_eq = virtuals.size();
+		for (size_t c = 0; c < ncomps; c++)
+		{
+			if (placed[c]) continue;
+			size_t eq = virtuals.size();
+			for (size_t k = 0; k < virtuals.size(); k++)
+			{
+				if ((eq_comps[k].first == c and
+				     eq_comps[k].second < ncomps and
+				     placed[eq_comps[k].second]) or
+				    (eq_comps[k].second == c and
+				     eq_comps[k].first < ncomps and
+				     placed[eq_comps[k].first]))
+				{
+					eq = k;
+					break;
+				}
+			}
+			bool joins = (eq < virtuals.size());
+			bool best_joins = (best_eq < virtuals.size());
+			bool better = (best == ncomps) or (joins and not best_joins) or
+				(joins == best_joins and
+				 comp_var_gnds[c].size() < comp_var_gnds[best].size());
+			if (better)
+			{
+				best = c;
+				best_eq = eq;
+			}
+		}
+
+		placed[best] = true;
+		Level level;
+		level.comp = best;
+
+		if (best_eq < virtuals.size())
+		{
+			// The join clause itself is enforced by the index.
+			const HandleSeq& oset = LinkCast(virtuals[best_eq])->getOutgoingSet();
+			bool first_here = (eq_comps[best_eq].first == best);
+			level.join_var = first_here ? oset[0] : oset[1];
+			level.key_var = first_here ? oset[1] : oset[0];
+			done[best_eq] = true;
+
+			const GroundingSeq& vg = comp_var_gnds[best];
+			for (size_t i = 0; i < vg.size(); i++)
+			{
+				auto it = vg[i].find(level.join_var);
+				if (it != vg[i].end())
+					level.index[it->second].push_back(i);
+			}
+		}
+
+		for (size_t k = 0; k < virtuals.size(); k++)
+		{
+			if (done[k] or virt_comps[k].empty()) continue;
+			bool ready = true;
+			for (size_t c : virt_comps[k])
+				if (not placed[c]) { ready = false; break; }
+			if (not ready) continue;
+			level.virtuals.push_back(virtuals[k]);
+			done[k] = true;
+		}
+		_levels.push_back(std::move(level));
+	}
+
+	for (size_t k = 0; k < virtuals.size(); k++)
+		if (not done[k]) _leftovers.push_back(virtuals[k]);
+}
+
+/// Add the i'th grounding of the component at this level to the
+/// accumulated groundings, recurse, and take it back out again.
+bool VirtualJoin::try_grounding(size_t lvl, size_t i)
+{
+	const Level& level = _levels[lvl];
+	const std::map<Handle, Handle>& cand_vg(_comp_var_gnds[level.comp][i]);
+	const std::map<Handle, Handle>& cand_pg(_comp_term_gnds[level.comp][i]);
+
+	// Different components may well share some constant terms, so
+	// only the entries that are new here get removed afterwards.
+	std::vector<std::map<Handle, Handle>::iterator> added_v, added_p;
+	for (const auto& pr : cand_vg)
+	{
+		auto ins = _var_gnds.insert(pr);
+		if (ins.second) added_v.push_back(ins.first);
+	}
+	for (const auto& pr : cand_pg)
+	{
+		auto ins = _term_gnds.insert(pr);
+		if (ins.second) added_p.push_back(ins.first);
+	}
+
+	bool accept = true;
+	for (const Handle& virt : level.virtuals)
+	{
+		if (not _cb.evaluate_sentence(virt, _var_gnds))
+		{
+			accept = false;
+			break;
+		}
+	}
+	if (accept)
+		accept = recurse(lvl + 1);
+
+	for (auto& it : added_v) _var_gnds.erase(it);
+	for (auto& it : added_p) _term_gnds.erase(it);
+	return accept;
+}
+
+bool VirtualJoin::recurse(size_t lvl)
 {
 	// If we are done with the recursive step, then we have one of the
 	// many combinatoric possibilities in the var_gnds and term_gnds
-	// maps. Submit this grounding map to the virtual links, and see
-	// what they've got to say about it.
-	if (0 == comp_var_gnds.size())
+	// maps, and it has passed all of the virtual clauses, except for
+	// any that do not refer to any of the components.
+	if (_levels.size() == lvl)
 	{
 #ifdef DEBUG
 		dbgprt("\nExplore one possible combinatoric grounding "
 		       "(var_gnds.size = %zu, term_gnds.size = %zu):\n",
-			   var_gnds.size(), term_gnds.size());
-		PatternMatchEngine::print_solution(var_gnds, term_gnds);
+			   _var_gnds.size(), _term_gnds.size());
+		PatternMatchEngine::print_solution(_var_gnds, _term_gnds);
 #endif
 
 		// Note, FYI, that if there are no virtual clauses at all,
 		// then this loop falls straight-through, and the grounding
 		// is reported as a match to the callback.  That is, the
 		// virtuals only serve to reject possibilities.
-		for (const Handle& virt : virtuals)
+		for (const Handle& virt : _leftovers)
 		{
-			// At this time, we expect all virtual links to be in
-			// one of two forms: either EvaluationLink's or
-			// GreaterThanLink's. The EvaluationLinks should have
-			// the structure
-			//
-			//   EvaluationLink
-			//       GroundedPredicateNode "scm:blah"
-			//       ListLink
-			//           Arg1Atom
-			//           Arg2Atom
-			//
-			// The GreaterThanLink's should have the "obvious" structure
-			//
-			//   GreaterThanLink
-			//       Arg1Atom
-			//       Arg2Atom
-			//
-			// In either case, one or more VariableNodes should appear
-			// in the Arg atoms. So, we ground the args, and pass that
-			// to the callback.
-
-			bool match = cb.evaluate_sentence(virt, var_gnds);
-
+			bool match = _cb.evaluate_sentence(virt, _var_gnds);
 			if (not match) return false;
 		}
 
 		// Yay! We found one! We now have a fully and completely grounded
 		// pattern! See what the callback thinks of it.
-		return cb.grounding(var_gnds, term_gnds);
+		return _cb.grounding(_var_gnds, _term_gnds);
 	}
-	dbgprt("Component recursion: num comp=%zd\n", comp_var_gnds.size());
 
-	// Recurse over all components. If component k has N_k groundings,
-	// and there are m components, then we have to explore all
-	// N_0 * N_1 * N_2 * ... N_m possible combinations of groundings.
-	// We do this recursively, by poping N_m off the back, and calling
-	// ourselves.
-	//
-	// vg and vp will be the collection of all of the different possible
-	// groundings for one of the components (well, its for component m,
-	// in the above notation.) So the loop below tries every possibility.
-	std::vector<std::map<Handle, Handle>> vg = comp_var_gnds.back();
-	comp_var_gnds.pop_back();
-	std::vector<std::map<Handle, Handle>> pg = comp_term_gnds.back();
-	comp_term_gnds.pop_back();
-
-	size_t ngnds = vg.size();
-	for (size_t i=0; i<ngnds; i++)
+	const Level& level = _levels[lvl];
+	dbgprt("Component recursion: level=%zu comp=%zu\n", lvl, level.comp);
+
+	if (nullptr == level.key_var)
+	{
+		size_t ngnds = _comp_var_gnds[level.comp].size();
+		for (size_t i = 0; i < ngnds; i++)
+		{
+			// Halt recursion immediately if match is accepted.
+			if (try_grounding(lvl, i)) return true;
+		}
+		return false;
+	}
+
+	// Hash join: look up only the groundings that agree.
+	auto gnd = _var_gnds.find(level.key_var);
+	if (gnd == _var_gnds.end()) return false;
+	auto bucket = level.index.find(gnd->second);
+	if (bucket == level.index.end()) return false;
+	for (size_t i : bucket->second)
 	{
-		// Given a set of groundings, tack on those for this component,
-		// and recurse, with one less component. We need to make a copy,
-		// of course.
-		std::map<Handle, Handle> rvg(var_gnds);
-		std::map<Handle, Handle> rpg(term_gnds);
-
-		const std::map<Handle, Handle>& cand_vg(vg[i]);
-		const std::map<Handle, Handle>& cand_pg(pg[i]);
-		rvg.insert(cand_vg.begin(), cand_vg.end());
-		rpg.insert(cand_pg.begin(), cand_pg.end());
-
-		bool accept = recursive_virtual(cb, virtuals, negations, rvg, rpg,
-		                                comp_var_gnds, comp_term_gnds);
-
-		// Halt recursion immediately if match is accepted.
-		if (accept) return true;
+		if (try_grounding(lvl, i)) return true;
 	}
 	return false;
 }
 
+/**
+ * Recursive evaluator/grounder/unifier of virtual link types.
+ * The virtual links are in 'virtuals', and a collection of possible
+ * groundings for disconnected graph components are in 'comp_var_gnds'
+ * and 'comp_term_gnds'; the variables of each component are in
+ * 'comp_vars'.
+ *
+ * Each combination of component groundings that gets past all of the
+ * virtual links is handed to the callback, to make the final
+ * determination.  See VirtualJoin, above, for how the combinations
+ * are put together.
+ */
+bool PatternMatch::recursive_virtual(PatternMatchCallback& cb,
+            const std::vector<Handle>& virtuals,
+            const std::vector<Handle>& negations, // currently ignored
+            const std::vector<std::set<Handle>>& comp_vars,
+            const std::vector<std::vector<std::map<Handle, Handle>>>& comp_var_gnds,
+            const std::vector<std::vector<std::map<Handle, Handle>>>& comp_term_gnds)
+{
+	VirtualJoin join(cb, virtuals, comp_vars, comp_var_gnds, comp_term_gnds);
+	return join.run();
+}
+
 /* ================================================================= */
 /**
  * Ground (solve) a pattern; perform unification. That is, find one
@@ -384,20 +588,17 @@ bool PatternLink::satisfy(PatternMatchCallback& pmcb) const
 		PatternLinkPtr clp(PatternLinkCast(_component_patterns.at(i)));
 		clp->satisfy(gcb);
 
-		comp_var_gnds.push_back(gcb._var_groundings);
-		comp_term_gnds.push_back(gcb._term_groundings);
+		comp_var_gnds.push_back(std::move(gcb._var_groundings));
+		comp_term_gnds.push_back(std::move(gcb._term_groundings));
 	}
 
 	// And now, try grounding each of the virtual clauses.
 	dbgprt("BEGIN component recursion: ====================== "
 	       "num comp=%zd num virts=%zd\n",
 	       comp_var_gnds.size(), _virtual.size());
-	std::map<Handle, Handle> empty_vg;
-	std::map<Handle, Handle> empty_pg;
 	std::vector<Handle> optionals; // currently ignored
 	return PatternMatch::recursive_virtual(pmcb, _virtual, optionals,
-	                  empty_vg, empty_pg,
-	                  comp_var_gnds, comp_term_gnds);
+	                  _component_vars, comp_var_gnds, comp_term_gnds);
 }
 
 /* ===================== END OF FILE ===================== */
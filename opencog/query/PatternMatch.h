@@ -42,10 +42,9 @@ class PatternMatch
 		static bool recursive_virtual(PatternMatchCallback& cb,
 		            const std::vector<Handle>& virtuals,
 		            const std::vector<Handle>& negations,
-		            const std::map<Handle, Handle>& var_gnds,
-		            const std::map<Handle, Handle>& term_gnds,
-		            std::vector<std::vector<std::map<Handle, Handle>>> comp_var_gnds,
-		            std::vector<std::vector<std::map<Handle, Handle>>> comp_term_gnds);
+		            const std::vector<std::set<Handle>>& comp_vars,
+		            const std::vector<std::vector<std::map<Handle, Handle>>>& comp_var_gnds,
+		            const std::vector<std::vector<std::map<Handle, Handle>>>& comp_term_gnds);
 };
 
 } // namespace opencog
@@ -250,6 +250,19 @@ class PatternMatchCallback
 			return h->getIncomingSet();
 		}
 
+		/**
+		 * Same as above, except that the only links that are of
+		 * interest are those that could match a pattern link of
+		 * type `t`.  Callbacks whose link_match() insists on equal
+		 * link types can return just the links of that type, which
+		 * is much cheaper for atoms with a huge, mixed incoming set.
+		 * By default, all of get_incoming_set() is returned.
+		 */
+		virtual IncomingSet get_incoming_set(const Handle& h, Type t)
+		{
+			return get_incoming_set(h);
+		}
+
 		/**
 		 * Called after a top-level clause (tree) has been fully
 		 * grounded. This gives the callee the opportunity to save
@@ -268,6 +281,19 @@ class PatternMatchCallback
 		virtual const std::set<Type>& get_connectives(void)
 		{ static const std::set<Type> _empty; return _empty; }
 
+		/**
+		 * Return a new callback, for the same pattern, that matches
+		 * exactly as this one does, for another search thread to use;
+		 * the caller deletes it.  The thread calls it for everything
+		 * except grounding(), evaluate_sentence() and
+		 * optional_clause_match(); those are still made on this
+		 * callback, one at a time.  Return NULL if there is no such
+		 * callback; the search then runs on one thread.  A subclass
+		 * that changes how atoms are matched must clone itself, and
+		 * not inherit this from its base class.
+		 */
+		virtual PatternMatchCallback* clone(void) { return NULL; }
+
 		/**
 		 * Called to initiate the search. This callback is responsible
 		 * for performing the top-most, outer loop of the search. That is,
@@ -181,7 +181,7 @@ bool PatternMatchEngine::variable_compare(const Handle& hp,
 	dbgprt("Found grounding of variable:\n");
 	prtmsg("$$ variable:    ", hp);
 	prtmsg("$$ ground term: ", hg);
-	if (hp != hg) var_grounding[hp] = hg;
+	if (hp != hg) var_grounding.set(hp, hg);
 	return true;
 }
 
@@ -209,7 +209,7 @@ bool PatternMatchEngine::self_compare(const Handle& hp)
 	     (VARIABLE_NODE != tp or
 	       _varlist->varset.end() == _varlist->varset.find(hp))))
 	{
-		if (hp != hg) var_grounding[hp] = hg;
+		if (hp != hg) var_grounding.set(hp, hg);
 	}
 #endif // THIS_CANT_BE_RIGHT
 #endif
@@ -229,7 +229,7 @@ bool PatternMatchEngine::node_compare(const Handle& hp,
 		dbgprt("Found matching nodes\n");
 		prtmsg("# pattern: ", hp);
 		prtmsg("# match:   ", hg);
-		if (hp != hg) var_grounding[hp] = hg;
+		if (hp != hg) var_grounding.set(hp, hg);
 	}
 	return match;
 }
@@ -297,7 +297,7 @@ bool PatternMatchEngine::ordered_compare(const Handle& hp,
 	if (not match) return false;
 
 	// If we've found a grounding, record it.
-	if (hp != hg) var_grounding[hp] = hg;
+	if (hp != hg) var_grounding.set(hp, hg);
 
 	return true;
 }
@@ -353,12 +353,12 @@ bool PatternMatchEngine::choice_compare(const Handle& hp,
 			if (match)
 			{
 				// Even the stack, *without* erasing the discovered grounding.
-				var_solutn_stack.pop();
+				solution_keep();
 
 				// If the grounding is accepted, record it.
-				if (hp != hg) var_grounding[hp] = hg;
+				if (hp != hg) var_grounding.set(hp, hg);
 
-				_choice_state[Choice(hp, hg)] = icurr;
+				_choice_state.set(Choice(hp, hg), icurr);
 				return true;
 			}
 		}
@@ -632,16 +632,16 @@ bool PatternMatchEngine::unorder_compare(const Handle& hp,
 			if (match)
 			{
 				// Even the stack, *without* erasing the discovered grounding.
-				var_solutn_stack.pop();
+				solution_keep();
 
 				// If the grounding is accepted, record it.
-				if (hp != hg) var_grounding[hp] = hg;
+				if (hp != hg) var_grounding.set(hp, hg);
 
 				// Handle case 5&7 of description above.
 				have_more = true;
 				dbgprt("Good permutation %d for UUID=%lu have_more=%d\n",
 				       perm_count[Unorder(hp, hg)], hp.value(), have_more);
-				_perm_state[Unorder(hp, hg)] = mutation;
+				_perm_state.set(Unorder(hp, hg), mutation);
 				return true;
 			}
 		}
@@ -701,7 +701,7 @@ bool PatternMatchEngine::have_perm(const Handle& hp,
 
 void PatternMatchEngine::perm_push(void)
 {
-	perm_stack.push(_perm_state);
+	_perm_state.push();
 #ifdef DEBUG
 	perm_count_stack.push(perm_count);
 #endif
@@ -709,7 +709,7 @@ void PatternMatchEngine::perm_push(void)
 
 void PatternMatchEngine::perm_pop(void)
 {
-	POPSTK(perm_stack, _perm_state);
+	_perm_state.pop();
 #ifdef DEBUG
 	POPSTK(perm_count_stack, perm_count);
 #endif
@@ -887,8 +887,13 @@ bool PatternMatchEngine::explore_up_branches(const Handle& hp,
                                              const Handle& hg,
                                              const Handle& clause_root)
 {
-	// Move up the solution graph, looking for a match.
-	IncomingSet iset = _pmc.get_incoming_set(hg);
+	// Move up the solution graph, looking for a match.  Unless the
+	// term is a quote or a redex, which tree_compare() looks through,
+	// the callback may narrow this down to links of the term's type,
+	// if its link_match() would reject all the others anyway.
+	Type tp = hp->getType();
+	IncomingSet iset = (QUOTE_LINK == tp or BETA_REDEX == tp) ?
+		_pmc.get_incoming_set(hg) : _pmc.get_incoming_set(hg, tp);
 	size_t sz = iset.size();
 	dbgprt("Looking upward for pat-UUID=%lu have %zu branches\n",
 	        hp.value(), sz);
@@ -986,9 +991,10 @@ bool PatternMatchEngine::explore_choice_branches(const Handle& hp,
 		// should resemble the perm_push() used for unordered links.
 		// However, currently, no test case trips this up. so .. OK.
 		// whatever. This still probably needs fixing.
-		if (_need_choice_push) choice_stack.push(_choice_state);
+		bool need_pop = _need_choice_push;
+		if (need_pop) _choice_state.push();
 		bool match = explore_single_branch(hp, hg, clause_root);
-		if (_need_choice_push) POPSTK(choice_stack, _choice_state);
+		if (need_pop) _choice_state.pop();
 		_need_choice_push = false;
 
 		// If the pattern was satisfied, then we are done for good.
@@ -1269,7 +1275,7 @@ bool PatternMatchEngine::clause_accept(const Handle& hp,
 	}
 	if (not match) return false;
 
-	clause_grounding[clause_root] = hg;
+	clause_grounding.set(clause_root, hg);
 	prtmsg("---------------------\nclause:", clause_root);
 	prtmsg("ground:", hg);
 
@@ -1306,7 +1312,7 @@ bool PatternMatchEngine::do_next_clause(void)
 			is_evaluatable(curr_root)?
 			"dynamically evaluatable" : "non-dynamic");
 		prtmsg("Joining variable  is", joiner);
-		prtmsg("Joining grounding is", var_grounding[joiner]);
+		prtmsg("Joining grounding is", var_grounding.get(joiner));
 
 		// Else, start solving the next unsolved clause. Note: this is
 		// a recursive call, and not a loop. Recursion is halted when
@@ -1318,7 +1324,7 @@ bool PatternMatchEngine::do_next_clause(void)
 		// else the join is a 'real' atom.
 
 		clause_accepted = false;
-		Handle hgnd = var_grounding[joiner];
+		Handle hgnd = var_grounding.get(joiner);
 		OC_ASSERT(hgnd != Handle::UNDEFINED,
 			"Error: joining handle has not been grounded yet!");
 		found = explore_link_branches(joiner, hgnd, curr_root);
@@ -1344,7 +1350,7 @@ bool PatternMatchEngine::do_next_clause(void)
 			if (not match) return false;
 
 			// XXX Maybe should push n pop here? No, maybe not ...
-			clause_grounding[curr_root] = Handle::UNDEFINED;
+			clause_grounding.set(curr_root, Handle::UNDEFINED);
 			get_next_untried_clause();
 			joiner = next_joint;
 			curr_root = next_clause;
@@ -1364,7 +1370,7 @@ bool PatternMatchEngine::do_next_clause(void)
 				// or not. If it does, we'll recurse. If it does not,
 				// we'll loop around back to here again.
 				clause_accepted = false;
-				Handle hgnd = var_grounding[joiner];
+				Handle hgnd = var_grounding.get(joiner);
 				found = explore_link_branches(joiner, hgnd, curr_root);
 			}
 		}
@@ -1542,7 +1548,7 @@ bool PatternMatchEngine::get_next_untried_helper(bool search_virtual,
 
 		for (const Handle& root : rl)
 		{
-			if ((issued.end() == issued.find(root))
+			if ((0 == issued.count(root))
 			        and (search_virtual or not is_evaluatable(root))
 			        and (search_black or not is_black(root))
 			        and (search_optionals or not is_optional(root)))
@@ -1573,7 +1579,7 @@ bool PatternMatchEngine::get_next_untried_helper(bool search_virtual,
 
 		if (Handle::UNDEFINED != unsolved_clause)
 		{
-			issued.insert(unsolved_clause);
+			issued.set(unsolved_clause, true);
 			return true;
 		}
 	}
@@ -1603,11 +1609,10 @@ void PatternMatchEngine::clause_stacks_push(void)
 
 	OC_ASSERT(not in_quote, "Can't posssibly happen!");
 
-	var_solutn_stack.push(var_grounding);
-	term_solutn_stack.push(clause_grounding);
+	solution_push();
 
-	issued_stack.push(issued);
-	choice_stack.push(_choice_state);
+	issued.push();
+	_choice_state.push();
 
 	perm_push();
 
@@ -1624,12 +1629,11 @@ void PatternMatchEngine::clause_stacks_pop(void)
 {
 	_pmc.pop();
 
-	// The grounding stacks are handled differently.
-	POPSTK(term_solutn_stack, clause_grounding);
-	POPSTK(var_solutn_stack, var_grounding);
-	POPSTK(issued_stack, issued);
+	solution_pop();
+
+	issued.pop();
 
-	POPSTK(choice_stack, _choice_state);
+	_choice_state.pop();
 
 	perm_pop();
 
@@ -1648,31 +1652,34 @@ void PatternMatchEngine::clause_stacks_pop(void)
 void PatternMatchEngine::clause_stacks_clear(void)
 {
 	_clause_stack_depth = 0;
-#if 0
-	OC_ASSERT(0 == term_solutn_stack.size());
-	OC_ASSERT(0 == var_solutn_stack.size());
-	OC_ASSERT(0 == issued_stack.size());
-	OC_ASSERT(0 == choice_stack.size());
-	OC_ASSERT(0 == perm_stack.size());
-#else
-	while (!term_solutn_stack.empty()) term_solutn_stack.pop();
-	while (!var_solutn_stack.empty()) var_solutn_stack.pop();
-	while (!issued_stack.empty()) issued_stack.pop();
-	while (!choice_stack.empty()) choice_stack.pop();
-	while (!perm_stack.empty()) perm_stack.pop();
+	var_grounding.reset();
+	clause_grounding.reset();
+	issued.reset();
+	_choice_state.reset();
+	_perm_state.reset();
+#ifdef DEBUG
+	while (!perm_count_stack.empty()) perm_count_stack.pop();
 #endif
 }
 
 void PatternMatchEngine::solution_push(void)
 {
-	var_solutn_stack.push(var_grounding);
-	term_solutn_stack.push(clause_grounding);
+	var_grounding.push();
+	clause_grounding.push();
 }
 
 void PatternMatchEngine::solution_pop(void)
 {
-	POPSTK(var_solutn_stack, var_grounding);
-	POPSTK(term_solutn_stack, clause_grounding);
+	var_grounding.pop();
+	clause_grounding.pop();
+}
+
+/// Keep the groundings found since the last solution_push(), and
+/// forget that push.  They are rolled back by the enclosing pop.
+void PatternMatchEngine::solution_keep(void)
+{
+	var_grounding.keep();
+	clause_grounding.keep();
 }
 
 /* ======================================================== */
@@ -1722,7 +1729,7 @@ bool PatternMatchEngine::explore_redex(const Handle& term,
 	clear_current_state();
 
 	// Match the required clauses.
-	issued.insert(first_clause);
+	issued.set(first_clause, true);
 	bool found = explore_link_branches(term, grnd, first_clause);
 
 	// If found is false, then there's no solution here.
@@ -1780,6 +1787,12 @@ PatternMatchEngine::PatternMatchEngine(PatternMatchCallback& pmcb,
 	take_step = true;
 }
 
+PatternMatchEngine::PatternMatchEngine(PatternMatchCallback& pmcb,
+                                       const PatternMatchEngine& proto)
+	: PatternMatchEngine(pmcb, *proto._varlist, *proto._pat)
+{
+}
+
 /* ======================================================== */
 
 void PatternMatchEngine::print_solution(
@@ -32,6 +32,7 @@
 
 #include <opencog/query/Pattern.h>
 #include <opencog/query/PatternMatchCallback.h>
+#include <opencog/query/Trail.h>
 #include <opencog/atomspace/ClassServer.h>
 
 namespace opencog {
@@ -46,6 +47,17 @@ class PatternMatchEngine
 	// Private, locally scoped typedefs, not used outside of this class.
 
 	private:
+		// -------------------------------------------
+		// Hashes for the keys of the undo logs that are never handed
+		// to the callbacks; see Trail.
+		struct PairHash
+		{
+			size_t operator()(const std::pair<Handle, Handle>& p) const
+			{
+				return hash_value(p.first) * 31 + hash_value(p.second);
+			}
+		};
+
 		// -------------------------------------------
 		// The current set of clauses (redex context) being grounded.
 		// A single redex consists of a collection of clauses, all of
@@ -85,19 +97,20 @@ class PatternMatchEngine
 
 		// Map of current groundings of variables to thier grounds
 		// Also contains grounds of subclauses (not sure why, this seems
-		// to be needed)
-		std::map<Handle, Handle> var_grounding;
+		// to be needed).  These two are ordered maps, since that is
+		// what the callbacks are handed.
+		Trail<Handle, Handle> var_grounding;
 		// Map of clauses to their current groundings
-		std::map<Handle, Handle> clause_grounding;
+		Trail<Handle, Handle> clause_grounding;
 
 		void clear_current_state(void);  // clear the stuff above
 
 		// -------------------------------------------
 		// ChoiceLink state management
 		typedef std::pair<Handle, Handle> Choice;
-		typedef std::map<Choice, size_t> ChoiceState;
 
-		ChoiceState _choice_state;
+		Trail<Choice, size_t,
+		      std::unordered_map<Choice, size_t, PairHash>> _choice_state;
 		bool _need_choice_push;
 
 		size_t curr_choice(const Handle&, const Handle&, bool&);
@@ -111,9 +124,9 @@ class PatternMatchEngine
 		// Unordered Link suppoprt
 		typedef std::vector<Handle> Permutation;
 		typedef std::pair<Handle, Handle> Unorder; // Choice
-		typedef std::map<Unorder, Permutation> PermState; // ChoiceState
 
-		PermState _perm_state;
+		Trail<Unorder, Permutation,
+		      std::unordered_map<Unorder, Permutation, PairHash>> _perm_state;
 		Permutation curr_perm(const Handle&, const Handle&, bool&);
 		bool have_perm(const Handle&, const Handle&);
 
@@ -137,27 +150,18 @@ class PatternMatchEngine
 		Handle next_clause;
 		Handle next_joint;
 		// Set of clauses for which a grounding is currently being attempted.
-		typedef std::set<Handle> IssuedSet;
-		IssuedSet issued;     // stacked on issued_stack
+		Trail<Handle, bool, std::unordered_map<Handle, bool>> issued;
 
 		// -------------------------------------------
-		// Stack used to store current traversal state for a single
-		// clause. These are pushed when a clause is fully grounded,
-		// and a new clause is about to be started. These are popped
-		// in order to get back to the original clause, and resume
-		// traversal of that clause, where it was last left off.
+		// Current traversal state for a single clause. This is pushed
+		// when a clause is fully grounded, and a new clause is about to
+		// be started. It is popped in order to get back to the original
+		// clause, and resume traversal of that clause, where it was last
+		// left off.  The pushes and pops are on the undo logs, above.
 		void solution_push(void);
 		void solution_pop(void);
+		void solution_keep(void);
 
-		// Stacks containing partial groundings.
-		typedef std::map<Handle, Handle> SolnMap;
-		std::stack<SolnMap> var_solutn_stack;
-		std::stack<SolnMap> term_solutn_stack;
-
-		std::stack<IssuedSet> issued_stack;
-		std::stack<ChoiceState> choice_stack;
-
-		std::stack<PermState> perm_stack;
 		void perm_push(void);
 		void perm_pop(void);
 
@@ -209,6 +213,13 @@ class PatternMatchEngine
 		                   const Variables&,
 		                   const Pattern&);
 
+		// A fresh engine for the same pattern, reporting to a
+		// different callback.  Used for parallel searches, where
+		// every thread needs an engine of its own.
+		PatternMatchEngine(PatternMatchCallback&, const PatternMatchEngine&);
+
+		PatternMatchCallback& get_callback(void) { return _pmc; }
+
 		// Examine the locally connected neighborhood for possible
 		// matches.
 		bool explore_neighborhood(const Handle&, const Handle&, const Handle&);
@@ -5,10 +5,16 @@
  * Copyright (c) 2008, 2014, 2015 Linas Vepstas <linas@linas.org>
  */
 
+#include <exception>
+
 #include <opencog/atomspace/AtomSpace.h>
 #include <opencog/guile/SchemeModule.h>
+#include <opencog/guile/SchemePrimitive.h>
+#include <opencog/guile/SchemeSmob.h>
 
 #include "BindLinkAPI.h"
+#include "BindLinkStream.h"
+#include "EvaluationMemo.h"
 #include "PatternMatch.h"
 #include "PatternSCM.h"
 #include "FuzzyMatch/FuzzyPatternMatch.h"
@@ -24,6 +30,9 @@ using namespace opencog;
 // Oh well. I guess that's OK, since the definition is meant to be
 // for the lifetime of the server, anyway.
 std::vector<FunctionWrap*> PatternSCM::_binders;
+std::mutex PatternSCM::_stream_mtx;
+std::map<int, BindLinkStream*> PatternSCM::_streams;
+int PatternSCM::_stream_count = 0;
 
 PatternSCM::PatternSCM(void) :
 	ModuleWrap("opencog query")
@@ -46,6 +55,31 @@ void PatternSCM::init(void)
 	_binders.push_back(new FunctionWrap(af_bindlink,
 	                   "cog-bind-af", "query"));
 
+	// Several BindLinks at once, sharing the search where they can.
+	_binders.push_back(new FunctionWrap(multi_bindlink,
+	                   "cog-bind-multi", "query"));
+
+	// One page of the results of a BindLink, in a list, not a SetLink,
+	// after the number of groundings that it used up.
+	define_scheme_primitive("cog-bind-range",
+	                   &PatternSCM::bind_range, this, "query");
+
+	// The results of a BindLink, a page at a time, from a search that
+	// runs once, on a thread of its own; see cog-bind-stream.
+	define_scheme_primitive("cog-bind-stream-open",
+	                   &PatternSCM::stream_open, this, "query");
+	define_scheme_primitive("cog-bind-stream-next",
+	                   &PatternSCM::stream_next, this, "query");
+	define_scheme_primitive("cog-bind-stream-close",
+	                   &PatternSCM::stream_close, this, "query");
+
+	// How often the GroundedPredicateNodes were answered from a memo;
+	// see the PATTERN_MATCHER_MEMO config parameter.
+	define_scheme_primitive("cog-bind-memo-hits",
+	                   &PatternSCM::memo_hits, this, "query");
+	define_scheme_primitive("cog-bind-memo-misses",
+	                   &PatternSCM::memo_misses, this, "query");
+
    // Fuzzy matching.
 	_binders.push_back(new FunctionWrap(find_approximate_match,
 	                   "cog-fuzzy-match", "query"));
@@ -58,6 +92,122 @@ void PatternSCM::init(void)
 	                   "cog-satisfying-set", "query"));
 }
 
+/// The page, and how many groundings it used up; the next page starts
+/// that much further on.
+CountedHandleSeq PatternSCM::bind_range(Handle h, int offset, int limit)
+{
+	AtomSpace* as = SchemeSmob::ss_get_env_as("cog-bind-range");
+	if (offset < 0) offset = 0;
+	if (limit < 0) limit = 0;
+	size_t consumed;
+	HandleSeq page(bindlink_range(as, h, offset, limit, true, &consumed));
+	return CountedHandleSeq(consumed, page);
+}
+
+/// The stream waits, and closing it joins the search thread, outside
+/// of guile mode; the search may be waiting to run a GroundedSchemaNode.
+/// See FunctionWrap::Call.
+struct StreamPage
+{
+	BindLinkStream* stream;
+	size_t limit;
+	HandleSeq page;
+	bool done;
+	std::exception_ptr failure;
+};
+
+static void* read_page(void* data)
+{
+	StreamPage* p = (StreamPage*) data;
+	try
+	{
+		Handle h;
+		while (p->page.size() < p->limit)
+		{
+			if (not p->stream->next(h))
+			{
+				p->done = true;
+				break;
+			}
+			p->page.push_back(h);
+		}
+	}
+	catch (...)
+	{
+		p->failure = std::current_exception();
+		p->done = true;
+	}
+	return NULL;
+}
+
+static void* close_stream(void* data)
+{
+	delete (BindLinkStream*) data;
+	return NULL;
+}
+
+BindLinkStream* PatternSCM::take_stream(int id)
+{
+	std::lock_guard<std::mutex> lck(_stream_mtx);
+	auto it = _streams.find(id);
+	if (it == _streams.end()) return NULL;
+	BindLinkStream* stream = it->second;
+	_streams.erase(it);
+	return stream;
+}
+
+/// Start the search; it runs ahead of the reader by at most backlog
+/// results.  Returns the number of the stream.
+int PatternSCM::stream_open(Handle h, int backlog)
+{
+	AtomSpace* as = SchemeSmob::ss_get_env_as("cog-bind-stream-open");
+	if (backlog < 1) backlog = 1;
+	BindLinkStream* stream = new BindLinkStream(as, h, 0, SIZE_MAX,
+	                                            true, backlog);
+	std::lock_guard<std::mutex> lck(_stream_mtx);
+	_streams[++_stream_count] = stream;
+	return _stream_count;
+}
+
+/// The next limit results, or fewer, once there are no more; the empty
+/// list once the stream is done, or closed.
+HandleSeq PatternSCM::stream_next(int id, int limit)
+{
+	StreamPage p;
+	p.stream = take_stream(id);
+	if (NULL == p.stream) return HandleSeq();
+	p.limit = (0 < limit) ? limit : 1;
+	p.done = false;
+	scm_without_guile(read_page, &p);
+
+	if (p.done)
+		scm_without_guile(close_stream, p.stream);
+	else
+	{
+		std::lock_guard<std::mutex> lck(_stream_mtx);
+		_streams[id] = p.stream;
+	}
+	if (p.failure) std::rethrow_exception(p.failure);
+	return p.page;
+}
+
+/// Stop the search, before it is done.
+void PatternSCM::stream_close(int id)
+{
+	BindLinkStream* stream = take_stream(id);
+	if (stream) scm_without_guile(close_stream, stream);
+}
+
+int PatternSCM::memo_hits(void)
+{
+	return EvaluationMemo::total_hits();
+}
+
+int PatternSCM::memo_misses(void)
+{
+	return EvaluationMemo::total_misses();
+}
+
 PatternSCM::~PatternSCM()
 {
 #if PYTHON_BUG_IS_FIXED
@@ -8,15 +8,34 @@
 #ifndef _OPENCOG_PATTERN_SCM_H
 #define _OPENCOG_PATTERN_SCM_H
 
+#include <map>
+#include <mutex>
+
 #include <opencog/guile/SchemeModule.h>
+#include <opencog/guile/SchemePrimitive.h>
 
 namespace opencog {
 
+class BindLinkStream;
+
 class PatternSCM : public ModuleWrap
 {
 	protected:
 		virtual void init(void);
 		static std::vector<FunctionWrap*> _binders;
+		CountedHandleSeq bind_range(Handle, int, int);
+
+		// The open streams, by number.  A stream is taken out of
+		// the table while it is being read, and dropped once it ends.
+		static std::mutex _stream_mtx;
+		static std::map<int, BindLinkStream*> _streams;
+		static int _stream_count;
+		static BindLinkStream* take_stream(int);
+		int stream_open(Handle, int);
+		HandleSeq stream_next(int, int);
+		void stream_close(int);
+		int memo_hits(void);
+		int memo_misses(void);
 	public:
 		PatternSCM(void);
 		~PatternSCM();
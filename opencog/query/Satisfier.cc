@@ -78,6 +78,8 @@ TruthValuePtr opencog::satisfaction_link(AtomSpace* as, const Handle& hlink)
 	}
 
 	Satisfier sater(as);
+	sater.set_search_threads(InitiateSearchCB::default_search_threads());
+	sater.set_evaluation_memo(DefaultPatternMatchCB::default_evaluation_memo());
 	bl->satisfy(sater);
 
 	return sater._result;
@@ -97,6 +99,8 @@ Handle opencog::satisfying_set(AtomSpace* as, const Handle& hlink)
 	}
 
 	SatisfyingSet sater(as);
+	sater.set_search_threads(InitiateSearchCB::default_search_threads());
+	sater.set_evaluation_memo(DefaultPatternMatchCB::default_evaluation_memo());
 	bl->satisfy(sater);
 
 	return as->add_link(SET_LINK, sater._satisfying_set);
@@ -24,6 +24,7 @@
 #ifndef _OPENCOG_SATISFIER_H
 #define _OPENCOG_SATISFIER_H
 
+#include <typeinfo>
 #include <vector>
 
 #include <opencog/atomspace/AtomSpace.h>
@@ -53,7 +54,8 @@ class Satisfier :
 		Satisfier(AtomSpace* as) :
 			InitiateSearchCB(as),
 			DefaultPatternMatchCB(as),
-			_result(TruthValue::FALSE_TV()) {}
+			_result(TruthValue::FALSE_TV())
+		{ _exact_link_types = true; }
 		TruthValuePtr _result;
 
 		virtual void set_pattern(const Variables& vars,
@@ -63,6 +65,15 @@ class Satisfier :
 			DefaultPatternMatchCB::set_pattern(vars, pat);
 		}
 
+		virtual PatternMatchCallback* clone(void)
+		{
+			if (typeid(*this) != typeid(Satisfier)) return NULL;
+			Satisfier* cb = new Satisfier(InitiateSearchCB::_as);
+			cb->set_pattern(*_variables, *_pattern);
+			cb->set_evaluation_memo(_memo);
+			return cb;
+		}
+
 		// Return true if a satisfactory grounding has been
 		// found. Note that in case where you want all possible
 		// groundings, this will usually return false, so the
@@ -90,7 +101,8 @@ class SatisfyingSet :
 {
 	public:
 		SatisfyingSet(AtomSpace* as) :
-			InitiateSearchCB(as), DefaultPatternMatchCB(as) {}
+			InitiateSearchCB(as), DefaultPatternMatchCB(as)
+		{ _exact_link_types = true; }
 		HandleSeq _varseq;
 		HandleSeq _satisfying_set;
 
@@ -102,6 +114,15 @@ class SatisfyingSet :
 			DefaultPatternMatchCB::set_pattern(vars, pat);
 		}
 
+		virtual PatternMatchCallback* clone(void)
+		{
+			if (typeid(*this) != typeid(SatisfyingSet)) return NULL;
+			SatisfyingSet* cb = new SatisfyingSet(InitiateSearchCB::_as);
+			cb->set_pattern(*_variables, *_pattern);
+			cb->set_evaluation_memo(_memo);
+			return cb;
+		}
+
 		// Return true if a satisfactory grounding has been
 		// found. Note that in case where you want all possible
 		// groundings, this will usually return false, so the
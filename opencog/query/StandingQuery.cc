@@ -0,0 +1,387 @@
+/*
+ * StandingQuery.cc
+ *
+ * Copyright (C) 2015 OpenCog Foundation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <algorithm>
+
+#include <opencog/atomspace/ClassServer.h>
+#include <opencog/atoms/bind/BindLink.h>
+
+#include "StandingQuery.h"
+
+using namespace opencog;
+
+/// Counts the signal handlers running in the query, so that the
+/// destructor can wait for them.  Once closed, no new ones get in.
+struct StandingQuery::Gate
+{
+	std::mutex mtx;
+	std::condition_variable drained;
+	StandingQuery* query;
+	size_t in_flight;
+
+	Gate(StandingQuery* q) : query(q), in_flight(0) {}
+
+	/// Held for the length of one signal handler.
+	class Pass
+	{
+		Gate& _gate;
+		StandingQuery* _query;
+	public:
+		Pass(Gate& g) : _gate(g)
+		{
+			std::lock_guard<std::mutex> lck(_gate.mtx);
+			_query = _gate.query;
+			if (_query) _gate.in_flight++;
+		}
+		~Pass()
+		{
+			if (NULL == _query) return;
+			std::lock_guard<std::mutex> lck(_gate.mtx);
+			if (0 == --_gate.in_flight)
+				_gate.drained.notify_all();
+		}
+		StandingQuery* query(void) const { return _query; }
+	};
+
+	void close(void)
+	{
+		std::unique_lock<std::mutex> lck(mtx);
+		query = NULL;
+		drained.wait(lck, [this] { return 0 == in_flight; });
+	}
+};
+
+StandingQuery::StandingQuery(AtomSpace* as, const Handle& h,
+                             Consumer consumer) :
+	_as(as), _consumer(consumer), _inst(as), _cb(as), _busy(false),
+	_max_seen(100000)
+{
+	init(h);
+}
+
+StandingQuery::StandingQuery(AtomSpace* as, const Handle& h) :
+	_as(as), _inst(as), _cb(as), _busy(false), _max_seen(100000)
+{
+	init(h);
+}
+
+StandingQuery::~StandingQuery()
+{
+	_add_conn.disconnect();
+	_tv_conn.disconnect();
+
+	// A signal may have been emitted just before the disconnect; wait
+	// for any update that is still running on another thread.
+	_gate->close();
+}
+
+/// How far down the deepest atom in the term is.
+static size_t depth(const Handle& h)
+{
+	LinkPtr l(LinkCast(h));
+	if (NULL == l) return 0;
+
+	size_t d = 0;
+	for (const Handle& ho : l->getOutgoingSet())
+		d = std::max(d, depth(ho));
+	return d + 1;
+}
+
+void StandingQuery::init(const Handle& h)
+{
+	Type t = h->getType();
+	if (classserver().isA(t, BIND_LINK))
+	{
+		BindLinkPtr bl(BindLinkCast(h));
+		if (NULL == bl)
+			bl = createBindLink(*LinkCast(h));
+		_implicand = bl->get_implicand();
+		_pl = bl;
+	}
+	else
+	{
+		_pl = PatternLinkCast(h);
+		if (NULL == _pl)
+		{
+			if (classserver().isA(t, PATTERN_LINK))
+				_pl = createPatternLink(*LinkCast(h));
+			else
+				_pl = createPatternLink(h);
+		}
+	}
+
+	const Variables& vars = _pl->get_variables();
+	const Pattern& pat = _pl->get_pattern();
+	_cb.set_pattern(vars, pat);
+
+	_incremental = (1 == _pl->get_num_comps()) and
+	               (0 == pat.optionals.size());
+	if (_incremental)
+		_pme.reset(new PatternMatchEngine(_cb, vars, pat));
+
+	// The evaluatable clauses are not grounded by atoms.
+	_depth = 0;
+	for (const Handle& cl : pat.mandatory)
+	{
+		if (0 < pat.evaluatable_holders.count(cl)) continue;
+		_seeds.push_back(cl);
+		_depth = std::max(_depth, depth(cl));
+	}
+
+	// The whole search finds the groundings that were there before
+	// the query, too; these count as seen.  The lock holds off the
+	// updates for atoms added meanwhile, until that is done.
+	std::lock_guard<std::recursive_mutex> lck(_mtx);
+	if (not _incremental) snapshot();
+
+	_gate = std::make_shared<Gate>(this);
+	std::shared_ptr<Gate> gate(_gate);
+
+	_add_conn = _as->addAtomSignal(
+		[gate](const Handle& a) {
+			Gate::Pass pass(*gate);
+			if (pass.query()) pass.query()->atom_added(a);
+		});
+
+	// Without evaluatable terms, the truth values play no part in the
+	// match, so a change cannot make a new grounding.
+	if (0 < pat.evaluatable_terms.size())
+		_tv_conn = _as->TVChangedSignal(
+			[gate](const Handle& a, const TruthValuePtr& oldtv,
+			       const TruthValuePtr& newtv) {
+				Gate::Pass pass(*gate);
+				if (pass.query()) pass.query()->tv_changed(a, oldtv, newtv);
+			});
+}
+
+/* ======================================================== */
+
+/// Quick check: could the atom possibly ground the clause?
+bool StandingQuery::could_ground(const Handle& clause, const Handle& h)
+{
+	if (0 < _pl->get_variables().varset.count(clause)) return true;
+
+	Type ct = clause->getType();
+	if (CHOICE_LINK == ct or QUOTE_LINK == ct or BETA_REDEX == ct)
+		return true;
+	if (ct != h->getType()) return false;
+
+	LinkPtr lc(LinkCast(clause));
+	return NULL == lc or
+	       lc->getArity() == LinkCast(h)->getArity();
+}
+
+/// The links that might ground a whole clause, with the atom somewhere
+/// inside: the atom itself, if it is a link, and the links holding it,
+/// up to the depth of the deepest clause.
+void StandingQuery::roots(const Handle& h, HandleSeq& out)
+{
+	std::set<Handle> done;
+	HandleSeq level;
+	level.push_back(h);
+	for (size_t d = 0; d <= _depth and not level.empty(); d++)
+	{
+		HandleSeq up;
+		for (const Handle& a : level)
+		{
+			if (not done.insert(a).second) continue;
+			if (LinkCast(a)) out.push_back(a);
+			if (d == _depth) continue;
+			for (const LinkPtr& lp : a->getIncomingSet())
+				up.push_back(lp->getHandle());
+		}
+		level.swap(up);
+	}
+}
+
+void StandingQuery::match(const Handle& h, std::vector<Grounding>& fresh)
+{
+	_cb.found.clear();
+	if (_incremental)
+	{
+		for (const Handle& cl : _seeds)
+			if (could_ground(cl, h))
+				_pme->explore_neighborhood(cl, cl, h);
+	}
+	else
+	{
+		// A new grounding has the new link grounding some clause;
+		// if it can't, the costly whole search is not needed.
+		bool any = false;
+		for (const Handle& cl : _seeds)
+			if ((any = could_ground(cl, h))) break;
+		if (any) _pl->satisfy(_cb);
+	}
+
+	// The same grounding can be found from more than one clause.
+	for (const Grounding& g : _cb.found)
+		if (remember(g))
+			fresh.push_back(g);
+}
+
+/// Count all of the groundings there are now as seen.  The caller
+/// must hold the lock.
+void StandingQuery::snapshot(void)
+{
+	_cb.found.clear();
+	_pl->satisfy(_cb);
+	_seen.insert(_cb.found.begin(), _cb.found.end());
+	_cb.found.clear();
+}
+
+/// Return true if the grounding was not delivered before.  The caller
+/// must hold the lock.  The whole search finds all of the old
+/// groundings each time, so for it, none are ever forgotten.
+bool StandingQuery::remember(const Grounding& g)
+{
+	if (not _incremental)
+		return _seen.insert(g).second;
+
+	if (0 == _max_seen) return true;
+
+	auto ins = _seen.insert(g);
+	if (not ins.second) return false;
+
+	_seen_order.push_back(ins.first);
+	while (_max_seen < _seen_order.size())
+	{
+		_seen.erase(_seen_order.front());
+		_seen_order.pop_front();
+	}
+	return true;
+}
+
+Handle StandingQuery::make_result(const Grounding& g)
+{
+	if (Handle::UNDEFINED != _implicand)
+		return _inst.instantiate(_implicand, g);
+
+	const HandleSeq& varseq = _pl->get_variables().varseq;
+	if (1 == varseq.size())
+		return g.at(varseq[0]);
+
+	HandleSeq vargnds;
+	for (const Handle& hv : varseq)
+		vargnds.push_back(g.at(hv));
+	return _as->add_link(LIST_LINK, vargnds);
+}
+
+/* ======================================================== */
+
+void StandingQuery::update(const HandleSeq& hs)
+{
+	std::vector<Grounding> fresh;
+	{
+		std::unique_lock<std::recursive_mutex> lck(_mtx);
+		_pending.insert(_pending.end(), hs.begin(), hs.end());
+		if (_busy) return;
+
+		_busy = true;
+		while (not _pending.empty())
+		{
+			Handle a(_pending.front());
+			_pending.pop_front();
+			match(a, fresh);
+		}
+		_busy = false;
+	}
+
+	// Deliver with no lock held; instantiating, or the consumer, may
+	// add more atoms, and these come back through here.
+	for (const Grounding& g : fresh)
+	{
+		Handle r(make_result(g));
+		if (Handle::UNDEFINED == r) continue;
+		if (_consumer)
+			_consumer(r);
+		else
+		{
+			std::lock_guard<std::mutex> lck(_queue_mtx);
+			_queue.push_back(r);
+		}
+	}
+}
+
+void StandingQuery::atom_added(const Handle& h)
+{
+	// A node has an empty incoming set, so it cannot be part of any
+	// grounding of a clause, yet.
+	if (NULL == LinkCast(h)) return;
+	update(HandleSeq(1, h));
+}
+
+void StandingQuery::tv_changed(const Handle& h, const TruthValuePtr&,
+                               const TruthValuePtr&)
+{
+	HandleSeq rs;
+	roots(h, rs);
+	if (rs.empty()) return;
+
+	// The whole search is re-run anyway; once is enough.
+	if (not _incremental)
+	{
+		for (const Handle& r : rs)
+			for (const Handle& cl : _seeds)
+				if (could_ground(cl, r))
+				{
+					update(HandleSeq(1, r));
+					return;
+				}
+		return;
+	}
+	update(rs);
+}
+
+HandleSeq StandingQuery::fetch(void)
+{
+	HandleSeq out;
+	std::lock_guard<std::mutex> lck(_queue_mtx);
+	out.swap(_queue);
+	return out;
+}
+
+void StandingQuery::reset(void)
+{
+	{
+		std::lock_guard<std::recursive_mutex> lck(_mtx);
+		_seen.clear();
+		_seen_order.clear();
+
+		// Else the next whole search would deliver everything.
+		if (not _incremental) snapshot();
+	}
+	std::lock_guard<std::mutex> lck(_queue_mtx);
+	_queue.clear();
+}
+
+void StandingQuery::set_max_seen(size_t max_seen)
+{
+	std::lock_guard<std::recursive_mutex> lck(_mtx);
+	_max_seen = max_seen;
+	if (not _incremental) return;
+	while (_max_seen < _seen_order.size())
+	{
+		_seen.erase(_seen_order.front());
+		_seen_order.pop_front();
+	}
+}
+
+/* ===================== END OF FILE ===================== */
@@ -0,0 +1,200 @@
+/*
+ * StandingQuery.h
+ *
+ * Copyright (C) 2015 OpenCog Foundation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _OPENCOG_STANDING_QUERY_H
+#define _OPENCOG_STANDING_QUERY_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+
+#include <boost/signals2.hpp>
+
+#include <opencog/atomspace/AtomSpace.h>
+#include <opencog/atoms/bind/PatternLink.h>
+#include <opencog/atoms/execution/Instantiator.h>
+
+#include "DefaultPatternMatchCB.h"
+#include "InitiateSearchCB.h"
+#include "PatternMatchEngine.h"
+
+namespace opencog {
+
+/**
+ * A pattern that stays registered with the atomspace, and is matched
+ * against each atom as it is added (or, if the pattern has evaluatable
+ * terms, as its truth value changes), instead of against the whole
+ * atomspace.
+ *
+ * A link that has just been added has nothing in its incoming set yet,
+ * so any new grounding must use it to ground a whole clause.  Each
+ * clause is therefore tried, as the root, against the new link alone,
+ * with PatternMatchEngine::explore_neighborhood(); the engine then
+ * grounds the other clauses by walking out from there, as usual.  The
+ * cost is proportional to the neighborhood of the new atom, not to the
+ * size of the atomspace.
+ *
+ * Patterns made of several disconnected components, and patterns with
+ * AbsentLinks, cannot be updated this way: adding an atom can change
+ * groundings anywhere.  For these, the whole search is re-run, whenever
+ * an added link could ground one of the clauses, and so each such add
+ * costs as much as a search of the whole atomspace.  All of the
+ * groundings found are remembered, starting with those that were there
+ * when the query was registered, and only the others are delivered.
+ *
+ * When a truth value changes, the atom may be anywhere in a grounding:
+ * it may ground a variable, or be a constant, or be nested deep inside
+ * some clause.  So the search walks up from it, through its incoming
+ * set, to the links that could ground a whole clause, no further up
+ * than the deepest clause, and tries each of those as the new link is
+ * tried above.
+ *
+ * Only groundings that use atoms added (or changed) after the query was
+ * registered are delivered; each one just once.  The groundings already
+ * delivered are remembered, up to a limit; see set_max_seen().  For a
+ * BindLink, what is delivered is the instantiated implicand; otherwise, it is the
+ * grounding of the variable, or a ListLink of the groundings of the
+ * variables, in order, just as for a GetLink.
+ *
+ * The atomspace signals are delivered on the thread that added the
+ * atom, (or on an index worker, for async adds), and so the consumer
+ * is called there, too.  It may add atoms; these are matched in turn.
+ * The destructor disconnects from the signals, and then waits for any
+ * update still running on another thread; so it must not be called
+ * from the consumer.
+ */
+class StandingQuery
+{
+	public:
+		typedef std::function<void(const Handle&)> Consumer;
+
+		/// Deliver each new result to the consumer.
+		StandingQuery(AtomSpace*, const Handle&, Consumer);
+
+		/// Queue each new result; collect them with fetch().
+		StandingQuery(AtomSpace*, const Handle&);
+		~StandingQuery();
+
+		/// Remove and return the queued results, oldest first.
+		HandleSeq fetch(void);
+
+		/// Forget which groundings were delivered, and drop the queued
+		/// results.  A grounding found after this is delivered again.
+		/// For the patterns that are searched whole, the groundings
+		/// there are now count as seen, as at registration.
+		void reset(void);
+
+		/// Remember at most this many delivered groundings; past that,
+		/// the oldest are forgotten, and may be delivered again, if
+		/// they are found again.  The default is 100000; zero
+		/// remembers none.  The patterns that are searched whole
+		/// remember every grounding; this does not apply to them.
+		void set_max_seen(size_t);
+
+	private:
+		typedef std::map<Handle, Handle> Grounding;
+
+		// Records the groundings, and stops nowhere.
+		class Collector :
+			public virtual InitiateSearchCB,
+			public virtual DefaultPatternMatchCB
+		{
+			public:
+				Collector(AtomSpace* as) :
+					InitiateSearchCB(as),
+					DefaultPatternMatchCB(as)
+				{ _exact_link_types = true; }
+
+				std::vector<Grounding> found;
+
+				virtual void set_pattern(const Variables& vars,
+				                         const Pattern& pat)
+				{
+					InitiateSearchCB::set_pattern(vars, pat);
+					DefaultPatternMatchCB::set_pattern(vars, pat);
+				}
+
+				virtual bool grounding(const std::map<Handle, Handle>& var_soln,
+				                       const std::map<Handle, Handle>& term_soln)
+				{
+					found.push_back(var_soln);
+					return false;
+				}
+		};
+
+		AtomSpace* _as;
+		Consumer _consumer;
+		PatternLinkPtr _pl;
+		Handle _implicand;
+		Instantiator _inst;
+
+		// The clauses that an atom can ground, and the depth of the
+		// deepest one.
+		bool _incremental;
+		HandleSeq _seeds;
+		size_t _depth;
+
+		Collector _cb;
+		std::unique_ptr<PatternMatchEngine> _pme;
+
+		// The matching is not re-entrant: the atoms added while it is
+		// running (by executable terms, or by the consumer) are put
+		// on _pending, and matched when the current one is done.
+		std::recursive_mutex _mtx;
+		bool _busy;
+		std::deque<Handle> _pending;
+
+		// The groundings delivered so far, oldest first in _seen_order.
+		std::set<Grounding> _seen;
+		std::deque<std::set<Grounding>::iterator> _seen_order;
+		size_t _max_seen;
+
+		std::mutex _queue_mtx;
+		HandleSeq _queue;
+
+		// The signals hold on to the gate, not to the query; the
+		// destructor closes it, and waits for the updates in flight.
+		struct Gate;
+		std::shared_ptr<Gate> _gate;
+		boost::signals2::scoped_connection _add_conn;
+		boost::signals2::scoped_connection _tv_conn;
+
+		void init(const Handle&);
+		bool could_ground(const Handle&, const Handle&);
+		void roots(const Handle&, HandleSeq&);
+		void match(const Handle&, std::vector<Grounding>&);
+		void snapshot(void);
+		bool remember(const Grounding&);
+		Handle make_result(const Grounding&);
+
+		void update(const HandleSeq&);
+		void atom_added(const Handle&);
+		void tv_changed(const Handle&, const TruthValuePtr&,
+		                const TruthValuePtr&);
+};
+
+} // namespace opencog
+
+#endif // _OPENCOG_STANDING_QUERY_H
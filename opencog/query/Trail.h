@@ -0,0 +1,131 @@
+/*
+ * Trail.h
+ *
+ * Copyright (C) 2015 OpenCog Foundation
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _OPENCOG_TRAIL_H
+#define _OPENCOG_TRAIL_H
+
+#include <map>
+#include <vector>
+
+namespace opencog {
+
+/**
+ * A map with an undo log, for the pattern matcher's backtracking
+ * state.  Rather than pushing a copy of the whole map onto a stack at
+ * every branchpoint, each change is logged, and a pop rolls the
+ * changes back, newest first.  A push/pop thus costs as much as the
+ * changes made in between, and not as much as the size of the map.
+ * Nothing is logged while no push is active.
+ *
+ * The map type is a parameter: the groundings are handed to the
+ * callbacks as a std::map, and so are kept in one, but the rest of
+ * the state can live in a hash map.
+ */
+template<typename Key, typename Val, typename Map = std::map<Key, Val>>
+class Trail
+{
+	private:
+		Map _map;
+		struct Undo { Key key; Val old; bool had; };
+		std::vector<Undo> _log;
+		std::vector<size_t> _marks;
+
+	public:
+		operator const Map&() const { return _map; }
+		const Val& at(const Key& k) const { return _map.at(k); }
+		size_t count(const Key& k) const { return _map.count(k); }
+		size_t size(void) const { return _map.size(); }
+		typename Map::const_iterator
+			find(const Key& k) const { return _map.find(k); }
+		typename Map::const_iterator
+			begin(void) const { return _map.begin(); }
+		typename Map::const_iterator
+			end(void) const { return _map.end(); }
+
+		// Like operator[], but does not insert anything.
+		Val get(const Key& k) const
+		{
+			auto it = _map.find(k);
+			return (it == _map.end()) ? Val() : it->second;
+		}
+
+		void set(const Key& k, const Val& v)
+		{
+			auto it = _map.find(k);
+			if (it == _map.end())
+			{
+				if (not _marks.empty())
+					_log.push_back({k, Val(), false});
+				_map.emplace(k, v);
+				return;
+			}
+			if (not _marks.empty())
+				_log.push_back({k, std::move(it->second), true});
+			it->second = v;
+		}
+
+		void erase(const Key& k)
+		{
+			auto it = _map.find(k);
+			if (it == _map.end()) return;
+			if (not _marks.empty())
+				_log.push_back({k, std::move(it->second), true});
+			_map.erase(it);
+		}
+
+		void push(void) { _marks.push_back(_log.size()); }
+		void pop(void)
+		{
+			size_t mark = _marks.back();
+			_marks.pop_back();
+			while (mark < _log.size())
+			{
+				Undo& u = _log.back();
+				if (u.had) _map[u.key] = std::move(u.old);
+				else _map.erase(u.key);
+				_log.pop_back();
+			}
+		}
+
+		// Drop the most recent push, but keep the changes made
+		// since; the enclosing pop will roll them back.
+		void keep(void) { _marks.pop_back(); }
+
+		void clear(void)
+		{
+			if (not _marks.empty())
+				for (auto& pr : _map)
+					_log.push_back({pr.first, std::move(pr.second), true});
+			_map.clear();
+		}
+
+		// Forget all pushes; the map itself is untouched.
+		void reset(void) { _log.clear(); _marks.clear(); }
+
+		// The number of pushes not yet popped or kept, and the number
+		// of changes logged.  For the unit tests.
+		size_t depth(void) const { return _marks.size(); }
+		size_t logged(void) const { return _log.size(); }
+};
+
+} // namespace opencog
+
+#endif // _OPENCOG_TRAIL_H
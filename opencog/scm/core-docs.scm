@@ -776,6 +776,68 @@
     A special-purpose pattern matcher used by the URE.
 ")
 
+(set-procedure-property! cog-bind-multi 'documentation
+"
+ cog-bind-multi handle
+    Run the pattern matcher on several BindLinks at once.  handle
+    must be a ListLink of BindLinks.  Rules that start their search
+    at the same atom share a single pass over its incoming set.
+    Returns a ListLink holding one SetLink of results per BindLink,
+    in the same order.
+
+    All of the BindLinks are run against the atomspace as it was
+    before the call: nothing is created until every search is done.
+    So no BindLink sees the results of another, and the order of the
+    BindLinks does not matter.  Each SetLink is what cog-bind would
+    have returned, if it had been the only one run.  Where the results
+    of one BindLink match the pattern of another, this differs from
+    calling cog-bind on each in turn; call cog-bind-multi again to
+    chain them.
+")
+
+(set-procedure-property! cog-bind-range 'documentation
+"
+ cog-bind-range handle offset limit
+    Run the pattern matcher on the BindLink handle, as cog-bind does,
+    but skip the first offset groundings, and stop after limit
+    results.  Returns a list: first the number of groundings used up,
+    then the results; not a SetLink.  The skipped groundings are never
+    instantiated.  A grounding whose implicand instantiates to nothing
+    is used up, but gives no result; so the next page starts at offset
+    plus the number used up, not plus the number of results.  See also
+    cog-bind-stream, to page through the results.
+
+    Example:
+       guile> (cog-bind-range rule 0 2)
+       (2 (EvaluationLink ...) (EvaluationLink ...))
+")
+
+(set-procedure-property! cog-bind-stream-open 'documentation
+"
+ cog-bind-stream-open handle backlog
+ cog-bind-stream-next stream limit
+ cog-bind-stream-close stream
+    Start the pattern matcher on the BindLink handle, on a thread of
+    its own, and return the number of the stream that it delivers its
+    results to; it stays at most backlog results ahead of the reader.
+    cog-bind-stream-next returns a list of the next limit results, or
+    fewer once the search is done; the empty list after that.  Close
+    a stream that is not read to the end.  See cog-bind-stream, which
+    wraps these.
+")
+
+(set-procedure-property! cog-bind-memo-hits 'documentation
+"
+ cog-bind-memo-hits
+ cog-bind-memo-misses
+    The number of times, so far, that a GroundedPredicateNode in a
+    pattern was answered from a memo, and the number of times that
+    it had to be evaluated.  Memos are off, unless turned on with the
+    PATTERN_MATCHER_MEMO config parameter: \"query\" gives each query
+    a memo of its own; a number of seconds gives all queries one memo,
+    whose entries are kept for that long.
+")
+
 (set-procedure-property! cog-satisfy 'documentation
 "
  cog-satisfy handle
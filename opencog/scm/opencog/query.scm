@@ -9,3 +9,28 @@
 (load-extension "libexecution" "opencog_exec_init")
 
 (load-extension "libquery" "opencog_query_init")
+
+(define-public (cog-bind-stream bindlink page-size)
+"
+ cog-bind-stream bindlink page-size
+    Return a procedure that, each time it is called, returns the next
+    page of up to page-size results of the BindLink, as a list; the
+    empty list once all of them have been returned.  The results are
+    not wrapped in a SetLink.
+
+    The search runs just once, on a thread of its own, and stays at
+    most one page ahead of the reader.  It stops once all the results
+    have been returned; to stop it before that, call the procedure
+    with 'close.
+
+    Example:
+       guile> (define next-page (cog-bind-stream rule 100))
+       guile> (next-page)
+       guile> (next-page 'close)
+"
+	(define stream (cog-bind-stream-open bindlink page-size))
+	(lambda* (#:optional cmd)
+		(if (eq? cmd 'close)
+			(begin (cog-bind-stream-close stream) '())
+			(cog-bind-stream-next stream page-size)))
+)
@@ -4,12 +4,13 @@ import os
 from opencog.atomspace import AtomSpace, TruthValue, Atom, Handle, types
 from opencog.bindlink import    stub_bindlink, bindlink, single_bindlink,\
                                 af_bindlink, satisfaction_link,\
+                                bindlink_stream,\
                                 execute_atom, evaluate_atom
 
 from opencog.utilities import initialize_opencog, finalize_opencog
 from opencog.type_constructors import *
 
-from test_functions import green_count, red_count
+from test_functions import green_count, red_count, looked_at_count
 
 __author__ = 'Curtis Faith'
 
@@ -135,6 +136,65 @@ class BindlinkTest(TestCase):
         self.assertEquals(atom.arity, 0)
         self.assertEquals(atom.type, types.SetLink)
 
+    def test_bindlink_stream(self):
+
+        # Remember the starting atomspace size.
+        starting_size = self.atomspace.size()
+
+        # The results are not wrapped in a SetLink.
+        results = list(bindlink_stream(self.atomspace, self.bindlink_handle))
+        self.assertEquals(len(results), 3)
+        self.assertEquals(self.atomspace.size(), starting_size)
+
+        # Skip one, and take at most one.
+        results = list(bindlink_stream(self.atomspace, self.bindlink_handle,
+                                       offset=1, limit=1))
+        self.assertEquals(len(results), 1)
+
+        # Stopping early must not hang the search.
+        for h in bindlink_stream(self.atomspace, self.bindlink_handle,
+                                 backlog=1):
+            break
+
+    def test_bindlink_stream_python_predicate(self):
+
+        # The search calls back into python, on its own thread; walking
+        # away from the stream must not deadlock on the GIL.
+        looking = BindLink(
+                VariableNode("$var"),
+                AndLink(
+                    InheritanceLink(
+                        VariableNode("$var"),
+                        ConceptNode("animal")),
+                    EvaluationLink(
+                        GroundedPredicateNode("py: test_functions.look_at"),
+                        ListLink(VariableNode("$var")))),
+                VariableNode("$var")).h
+
+        for h in bindlink_stream(self.atomspace, looking, backlog=1):
+            break
+        self.assertTrue(1 <= looked_at_count() <= 3)
+
+        results = list(bindlink_stream(self.atomspace, looking))
+        self.assertEquals(len(results), 3)
+
+    def test_bindlink_stream_groundings(self):
+
+        # With several variables, each grounding is a ListLink, and it
+        # is in the atomspace.
+        pairs = BindLink(
+                VariableList(VariableNode("$x"), VariableNode("$y")),
+                InheritanceLink(VariableNode("$x"), VariableNode("$y")),
+                VariableNode("$x")).h
+
+        results = list(bindlink_stream(self.atomspace, pairs,
+                                       instantiate=False))
+        self.assertTrue(4 <= len(results))
+        for h in results:
+            atom = self.atomspace[h]
+            self.assertEquals(atom.type, types.ListLink)
+            self.assertEquals(atom.arity, 2)
+
     def test_satisfy(self):
         satisfaction_handle = SatisfactionLink(
             VariableList(),  # no variables
@@ -43,6 +43,17 @@ def red_count():
     global red
     return red
 
+looked_at = 0
+
+def looked_at_count():
+    global looked_at
+    return looked_at
+
+def look_at(atom):
+    global looked_at
+    looked_at += 1
+    return TruthValue(1,1)
+
 def stop_go(atom):
     compare_green = ConceptNode("green light")
     compare_red = ConceptNode("red light")
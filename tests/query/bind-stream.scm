@@ -0,0 +1,57 @@
+;
+; Data and patterns for BindLinkStreamUTest.
+;
+; A hundred critters, all of them animals; the first three are in the
+; club.
+;
+(use-modules (opencog))
+(use-modules (opencog query))
+(use-modules (srfi srfi-1))
+
+(define (critter n)
+	(ConceptNode (string-append "critter " (number->string n))))
+
+(define (critter-number c)
+	(string->number (substring (cog-name c) (string-length "critter "))))
+
+(for-each
+	(lambda (n)
+		(InheritanceLink (critter n) (ConceptNode "animal"))
+		(if (< n 3) (MemberLink (critter n) (ConceptNode "club"))))
+	(iota 100))
+
+(define tx (TypedVariableLink (VariableNode "$x") (TypeNode "ConceptNode")))
+(define ty (TypedVariableLink (VariableNode "$y") (TypeNode "ConceptNode")))
+
+(define rule
+	(BindLink tx
+		(InheritanceLink (VariableNode "$x") (ConceptNode "animal"))
+		(EvaluationLink (PredicateNode "is")
+			(ListLink (VariableNode "$x") (ConceptNode "animal")))))
+
+(define pairs
+	(BindLink (VariableList tx ty)
+		(AndLink
+			(InheritanceLink (VariableNode "$x") (ConceptNode "animal"))
+			(MemberLink (VariableNode "$x") (VariableNode "$y")))
+		(EvaluationLink (PredicateNode "in")
+			(ListLink (VariableNode "$x") (VariableNode "$y")))))
+
+;; Only the even critters give a result; for the odd ones, the
+;; implicand instantiates to nothing.
+(define (even-only c)
+	(if (even? (critter-number c)) c '()))
+
+(define even-critters
+	(BindLink tx
+		(InheritanceLink (VariableNode "$x") (ConceptNode "animal"))
+		(ExecutionOutputLink (GroundedSchemaNode "scm: even-only")
+			(ListLink (VariableNode "$x")))))
+
+;; All of the pages of a pager, put together.
+(define (drain pager)
+	(let loop ((all '()))
+		(let ((page (pager)))
+			(if (null? page) all (loop (append all page))))))
+
+(define (count-distinct lst) (length (delete-duplicates lst)))
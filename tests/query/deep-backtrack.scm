@@ -0,0 +1,83 @@
+;
+; Data and patterns for TrailUTest.
+;
+; Four levels of three nodes each; every node on one level is tied to
+; every node on the next by an unordered SetLink, under a predicate
+; naming the step.  The search has to try both orders of every
+; SetLink, and back out of most of them, three levels deep, and then
+; pick one of two branches of a ChoiceLink at the bottom.
+;
+(use-modules (opencog))
+(use-modules (opencog query))
+
+(define (node level k)
+	(ConceptNode (string-append "level " (number->string level)
+		" node " (number->string k))))
+
+(define (step level)
+	(PredicateNode (string-append "step " (number->string level))))
+
+(for-each
+	(lambda (level)
+		(for-each
+			(lambda (j)
+				(for-each
+					(lambda (k)
+						(EvaluationLink (step level)
+							(SetLink (node level j) (node (+ level 1) k))))
+					(iota 3)))
+			(iota 3)))
+	(iota 3))
+
+(for-each
+	(lambda (k) (InheritanceLink (node 0 k) (ConceptNode "start")))
+	(iota 3))
+
+(InheritanceLink (node 3 0) (ConceptNode "red"))
+(InheritanceLink (node 3 1) (ConceptNode "blue"))
+
+(define (concept-var name)
+	(TypedVariableLink (VariableNode name) (TypeNode "ConceptNode")))
+
+;; Every path from a start node down to a red or blue node.
+(define deep-paths
+	(BindLink
+		(VariableList
+			(concept-var "$a") (concept-var "$b")
+			(concept-var "$c") (concept-var "$d"))
+		(AndLink
+			(InheritanceLink (VariableNode "$a") (ConceptNode "start"))
+			(EvaluationLink (step 0)
+				(SetLink (VariableNode "$a") (VariableNode "$b")))
+			(EvaluationLink (step 1)
+				(SetLink (VariableNode "$b") (VariableNode "$c")))
+			(EvaluationLink (step 2)
+				(SetLink (VariableNode "$c") (VariableNode "$d")))
+			(ChoiceLink
+				(InheritanceLink (VariableNode "$d") (ConceptNode "red"))
+				(InheritanceLink (VariableNode "$d") (ConceptNode "blue"))))
+		(ListLink
+			(VariableNode "$a") (VariableNode "$b")
+			(VariableNode "$c") (VariableNode "$d"))))
+
+;; The same, but nothing at the bottom is green; everything explored
+;; has to be backed out of.
+(define deep-none
+	(BindLink
+		(VariableList
+			(concept-var "$a") (concept-var "$b")
+			(concept-var "$c") (concept-var "$d"))
+		(AndLink
+			(InheritanceLink (VariableNode "$a") (ConceptNode "start"))
+			(EvaluationLink (step 0)
+				(SetLink (VariableNode "$a") (VariableNode "$b")))
+			(EvaluationLink (step 1)
+				(SetLink (VariableNode "$b") (VariableNode "$c")))
+			(EvaluationLink (step 2)
+				(SetLink (VariableNode "$c") (VariableNode "$d")))
+			(ChoiceLink
+				(InheritanceLink (VariableNode "$d") (ConceptNode "green"))
+				(InheritanceLink (VariableNode "$d") (ConceptNode "purple"))))
+		(ListLink
+			(VariableNode "$a") (VariableNode "$b")
+			(VariableNode "$c") (VariableNode "$d"))))
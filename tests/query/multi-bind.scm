@@ -0,0 +1,82 @@
+;
+; Data and rules for MultiBindUTest.
+;
+; A hundred critters, all of them animals; every fifth one is in the
+; club, and every third one is furry.  Ten people are in the club too.
+;
+(use-modules (opencog))
+(use-modules (opencog query))
+
+(for-each
+	(lambda (n)
+		(define critter
+			(ConceptNode (string-append "critter " (number->string n))))
+		(InheritanceLink critter (ConceptNode "animal"))
+		(if (zero? (modulo n 5))
+			(MemberLink critter (ConceptNode "club")))
+		(if (zero? (modulo n 3))
+			(InheritanceLink critter (ConceptNode "furry"))))
+	(iota 100))
+
+(for-each
+	(lambda (n)
+		(MemberLink
+			(ConceptNode (string-append "person " (number->string n)))
+			(ConceptNode "club")))
+	(iota 10))
+
+;; The variables are typed, so that the patterns cannot ground onto
+;; their own clauses.
+(define tx (TypedVariableLink (VariableNode "$x") (TypeNode "ConceptNode")))
+(define ty (TypedVariableLink (VariableNode "$y") (TypeNode "ConceptNode")))
+
+;; Two rules with the same clause, one with the same starting point
+;; but a different shape, and one starting elsewhere.  Then two
+;; clauses, starting at the thinner "furry"; and no constants at all,
+;; which is searched on its own.
+(define rules
+	(ListLink
+		(BindLink tx
+			(InheritanceLink (VariableNode "$x") (ConceptNode "animal"))
+			(VariableNode "$x"))
+		(BindLink tx
+			(InheritanceLink (VariableNode "$x") (ConceptNode "animal"))
+			(ListLink (VariableNode "$x") (VariableNode "$x")))
+		(BindLink tx
+			(InheritanceLink (ConceptNode "animal") (VariableNode "$x"))
+			(VariableNode "$x"))
+		(BindLink ty
+			(MemberLink (VariableNode "$y") (ConceptNode "club"))
+			(VariableNode "$y"))
+		(BindLink tx
+			(AndLink
+				(InheritanceLink (VariableNode "$x") (ConceptNode "animal"))
+				(InheritanceLink (VariableNode "$x") (ConceptNode "furry")))
+			(VariableNode "$x"))
+		(BindLink (VariableList tx ty)
+			(MemberLink (VariableNode "$x") (VariableNode "$y"))
+			(VariableNode "$x"))))
+
+;; Everyone in the club becomes a pet; what make-pets creates is what
+;; find-pets looks for, and what no-pets checks is not there.
+(define make-pets
+	(BindLink tx
+		(MemberLink (VariableNode "$x") (ConceptNode "club"))
+		(InheritanceLink (VariableNode "$x") (ConceptNode "pet"))))
+
+(define find-pets
+	(BindLink tx
+		(InheritanceLink (VariableNode "$x") (ConceptNode "pet"))
+		(VariableNode "$x")))
+
+(define no-pets
+	(BindLink tx
+		(AbsentLink
+			(InheritanceLink (VariableNode "$x") (ConceptNode "pet")))
+		(ConceptNode "no pets yet")))
+
+;; Nothing is a unicorn.
+(define find-unicorns
+	(BindLink tx
+		(InheritanceLink (VariableNode "$x") (ConceptNode "unicorn"))
+		(VariableNode "$x")))
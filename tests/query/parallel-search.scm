@@ -0,0 +1,106 @@
+;
+; Data and patterns for ParallelSearchUTest.
+;
+; Five hundred stars, every third of them bright, and two of them
+; novas.  The parallel search must find exactly what the sequential
+; one does, whatever the number of threads.
+;
+(use-modules (opencog))
+(use-modules (opencog query))
+
+(define (star n) (ConceptNode (string-append "star " (number->string n))))
+
+(for-each
+	(lambda (n)
+		(InheritanceLink (star n) (ConceptNode "star"))
+		(if (zero? (modulo n 3))
+			(InheritanceLink (star n) (ConceptNode "bright"))))
+	(iota 500))
+
+(InheritanceLink (star 7) (ConceptNode "nova"))
+(InheritanceLink (star 9) (ConceptNode "nova"))
+
+;; Nothing is dim; the search has a starting point, but no candidates.
+(ConceptNode "dim")
+
+;; Starts from the incoming set of "star" (or "bright").
+(define by-constant
+	(BindLink
+		(TypedVariableLink (VariableNode "$x") (TypeNode "ConceptNode"))
+		(AndLink
+			(InheritanceLink (VariableNode "$x") (ConceptNode "star"))
+			(InheritanceLink (VariableNode "$x") (ConceptNode "bright")))
+		(VariableNode "$x")))
+
+;; No constants at all; starts from every InheritanceLink.
+(define by-type
+	(BindLink
+		(VariableList
+			(TypedVariableLink (VariableNode "$x") (TypeNode "ConceptNode"))
+			(TypedVariableLink (VariableNode "$y") (TypeNode "ConceptNode")))
+		(InheritanceLink (VariableNode "$x") (VariableNode "$y"))
+		(ListLink (VariableNode "$y") (VariableNode "$x"))))
+
+;; Two candidates; most of the threads get none.
+(define novas
+	(BindLink
+		(TypedVariableLink (VariableNode "$x") (TypeNode "ConceptNode"))
+		(InheritanceLink (VariableNode "$x") (ConceptNode "nova"))
+		(VariableNode "$x")))
+
+;; No candidates at all.
+(define dim
+	(BindLink
+		(TypedVariableLink (VariableNode "$x") (TypeNode "ConceptNode"))
+		(InheritanceLink (VariableNode "$x") (ConceptNode "dim"))
+		(VariableNode "$x")))
+
+;; The predicate throws for star 250.  The pattern has an evaluatable
+;; term, so it is searched on one thread, however many are asked for.
+(define (explode x)
+	(if (equal? x (star 250))
+		(throw 'parallel-search-test "star 250 exploded")
+		(stv 1 1)))
+
+(define exploding
+	(BindLink
+		(TypedVariableLink (VariableNode "$x") (TypeNode "ConceptNode"))
+		(AndLink
+			(InheritanceLink (VariableNode "$x") (ConceptNode "star"))
+			(EvaluationLink
+				(GroundedPredicateNode "scm: explode")
+				(ListLink (VariableNode "$x"))))
+		(VariableNode "$x")))
+;; The same as by-constant, but only the predicate picks the bright
+;; stars; searched on one thread.
+(define (bright? x)
+	(if (equal? (cog-link 'InheritanceLink x (ConceptNode "bright")) '())
+		(stv 0 1)
+		(stv 1 1)))
+
+(define by-predicate
+	(BindLink
+		(TypedVariableLink (VariableNode "$x") (TypeNode "ConceptNode"))
+		(AndLink
+			(InheritanceLink (VariableNode "$x") (ConceptNode "star"))
+			(EvaluationLink
+				(GroundedPredicateNode "scm: bright?")
+				(ListLink (VariableNode "$x"))))
+		(VariableNode "$x")))
+
+;; The implicand throws for star 249, a bright one.  The error must
+;; come out of whichever thread ran into it.
+(define (explode-later x)
+	(if (equal? x (star 249))
+		(throw 'parallel-search-test "star 249 exploded")
+		x))
+
+(define exploding-later
+	(BindLink
+		(TypedVariableLink (VariableNode "$x") (TypeNode "ConceptNode"))
+		(AndLink
+			(InheritanceLink (VariableNode "$x") (ConceptNode "star"))
+			(InheritanceLink (VariableNode "$x") (ConceptNode "bright")))
+		(ExecutionOutputLink
+			(GroundedSchemaNode "scm: explode-later")
+			(ListLink (VariableNode "$x")))))
@@ -0,0 +1,61 @@
+;
+; Data and patterns for SearchPlanUTest.
+;
+; Forty pebbles, all of them stones, and every fourth one round.
+; Searching for round stones starts best at "round".
+;
+(use-modules (opencog))
+(use-modules (opencog query))
+
+(define (pebble n) (ConceptNode (string-append "pebble " (number->string n))))
+(define (marble n) (ConceptNode (string-append "marble " (number->string n))))
+
+(for-each
+	(lambda (n)
+		(InheritanceLink (pebble n) (ConceptNode "stone"))
+		(if (zero? (modulo n 4))
+			(InheritanceLink (pebble n) (ConceptNode "round"))))
+	(iota 40))
+
+(define round-stones
+	(BindLink
+		(TypedVariableLink (VariableNode "$x") (TypeNode "ConceptNode"))
+		(AndLink
+			(InheritanceLink (VariableNode "$x") (ConceptNode "stone"))
+			(InheritanceLink (VariableNode "$x") (ConceptNode "round")))
+		(VariableNode "$x")))
+
+;; Lots more round things, none of them stones; after this, "stone"
+;; is the better place to start.
+(define (add-marbles)
+	(for-each
+		(lambda (n) (InheritanceLink (marble n) (ConceptNode "round")))
+		(iota 200)))
+
+;; Five gems are shiny, and so are a hundred marbles, but only by the
+;; looks of them: "shiny" is in few InheritanceLinks, but in many
+;; ListLinks.  The search for shiny gems starts at "shiny", since only
+;; its InheritanceLinks can ground the clause holding it.
+(define (add-gems)
+	(for-each
+		(lambda (n)
+			(define gem (ConceptNode (string-append "gem " (number->string n))))
+			(InheritanceLink gem (ConceptNode "gem"))
+			(if (< n 5) (InheritanceLink gem (ConceptNode "shiny"))))
+		(iota 15))
+	(for-each
+		(lambda (n)
+			(EvaluationLink (PredicateNode "looks")
+				(ListLink (ConceptNode "shiny") (marble n))))
+		(iota 100)))
+
+(define shiny-clause
+	(InheritanceLink (VariableNode "$x") (ConceptNode "shiny")))
+
+(define shiny-gems
+	(BindLink
+		(TypedVariableLink (VariableNode "$x") (TypeNode "ConceptNode"))
+		(AndLink
+			(InheritanceLink (VariableNode "$x") (ConceptNode "gem"))
+			shiny-clause)
+		(VariableNode "$x")))
@@ -0,0 +1,109 @@
+;
+; Data and patterns for StandingQueryUTest.
+;
+; Ten critters, all of them animals, all in the club, and all liking
+; cheese.  The standing queries see only what comes after them.
+;
+(use-modules (opencog))
+(use-modules (opencog query))
+
+(define (critter n)
+	(ConceptNode (string-append "critter " (number->string n))))
+
+(for-each
+	(lambda (n)
+		(InheritanceLink (critter n) (ConceptNode "animal"))
+		(MemberLink (critter n) (ConceptNode "club"))
+		(EvaluationLink (PredicateNode "likes")
+			(ListLink (critter n) (ConceptNode "cheese"))))
+	(iota 10))
+
+;; The variables are typed, so that the patterns cannot ground onto
+;; their own clauses.
+(define tx (TypedVariableLink (VariableNode "$x") (TypeNode "ConceptNode")))
+(define ty (TypedVariableLink (VariableNode "$y") (TypeNode "ConceptNode")))
+
+;; Two clauses.
+(define animal-members
+	(BindLink tx
+		(AndLink
+			(InheritanceLink (VariableNode "$x") (ConceptNode "animal"))
+			(MemberLink (VariableNode "$x") (ConceptNode "club")))
+		(VariableNode "$x")))
+
+;; Two variables.
+(define memberships
+	(GetLink (VariableList tx ty)
+		(MemberLink (VariableNode "$x") (VariableNode "$y"))))
+
+;; What the first one makes, the second one finds.
+(define make-mortal
+	(BindLink tx
+		(InheritanceLink (VariableNode "$x") (ConceptNode "animal"))
+		(InheritanceLink (VariableNode "$x") (ConceptNode "mortal"))))
+
+(define find-mortal
+	(BindLink tx
+		(InheritanceLink (VariableNode "$x") (ConceptNode "mortal"))
+		(VariableNode "$x")))
+
+;; Two disconnected components: any animal, and anyone who likes
+;; cheese.  Searched whole; the hundred groundings there already are
+;; never delivered.
+(define animals-and-cheese
+	(GetLink (VariableList tx ty)
+		(AndLink
+			(InheritanceLink (VariableNode "$x") (ConceptNode "animal"))
+			(EvaluationLink (PredicateNode "likes")
+				(ListLink (VariableNode "$y") (ConceptNode "cheese"))))))
+
+;; The animals that are not in the club; searched whole, too.
+(define outsiders
+	(GetLink tx
+		(AndLink
+			(InheritanceLink (VariableNode "$x") (ConceptNode "animal"))
+			(AbsentLink
+				(MemberLink (VariableNode "$x") (ConceptNode "club"))))))
+
+;; ------------------------------------------------------------------
+;; Patterns that look at truth values.  An atom is bright if we are
+;; confident about it; the default truth value has no confidence.
+
+(define (confidence atom)
+	(cdr (assoc 'confidence (cog-tv->alist (cog-tv atom)))))
+
+(define (bright? atom)
+	(if (< 0.5 (confidence atom)) (stv 1 1) (stv 0 1)))
+
+(define (brighten atom) (cog-set-tv! atom (stv 1 0.9)))
+
+;; The changed atom grounds the variable.
+(define bright-animals
+	(BindLink tx
+		(AndLink
+			(InheritanceLink (VariableNode "$x") (ConceptNode "animal"))
+			(EvaluationLink (GroundedPredicateNode "scm: bright?")
+				(ListLink (VariableNode "$x"))))
+		(VariableNode "$x")))
+
+;; The changed atom is a constant node.
+(define (open? who club) (bright? club))
+
+(define open-club
+	(BindLink tx
+		(AndLink
+			(MemberLink (VariableNode "$x") (ConceptNode "club"))
+			(EvaluationLink (GroundedPredicateNode "scm: open?")
+				(ListLink (VariableNode "$x") (ConceptNode "club"))))
+		(VariableNode "$x")))
+
+;; The changed atom is nested inside the clause.
+(define bright-likes
+	(BindLink tx
+		(AndLink
+			(EvaluationLink (PredicateNode "likes")
+				(ListLink (VariableNode "$x") (ConceptNode "cheese")))
+			(EvaluationLink (GroundedPredicateNode "scm: bright?")
+				(ListLink
+					(ListLink (VariableNode "$x") (ConceptNode "cheese")))))
+		(VariableNode "$x")))
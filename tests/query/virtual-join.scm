@@ -0,0 +1,100 @@
+;
+; Data and patterns for VirtualJoinUTest.
+;
+; Sixty people.  Every fourth one plays in the orchestra, along with
+; five guests; every sixth one speaks French, and every twelfth one
+; German, too.  The patterns are made of disconnected components, tied
+; together only by virtual clauses.
+;
+(use-modules (opencog))
+(use-modules (opencog query))
+
+(define (person n) (ConceptNode (string-append "person " (number->string n))))
+(define (guest n) (ConceptNode (string-append "guest " (number->string n))))
+(define (speaks who lang)
+	(EvaluationLink (PredicateNode "speaks") (ListLink who (ConceptNode lang))))
+
+(for-each
+	(lambda (n)
+		(InheritanceLink (person n) (ConceptNode "person"))
+		(if (zero? (modulo n 4))
+			(MemberLink (person n) (ConceptNode "orchestra")))
+		(if (zero? (modulo n 6)) (speaks (person n) "French"))
+		(if (zero? (modulo n 12)) (speaks (person n) "German")))
+	(iota 60))
+
+(for-each
+	(lambda (n) (MemberLink (guest n) (ConceptNode "orchestra")))
+	(iota 5))
+
+(define (concept-var name)
+	(TypedVariableLink (VariableNode name) (TypeNode "ConceptNode")))
+
+;; A hash join on $x == $y: the people in the orchestra.
+(define join-equal
+	(BindLink
+		(VariableList (concept-var "$x") (concept-var "$y"))
+		(AndLink
+			(InheritanceLink (VariableNode "$x") (ConceptNode "person"))
+			(MemberLink (VariableNode "$y") (ConceptNode "orchestra"))
+			(EqualLink (VariableNode "$x") (VariableNode "$y")))
+		(ListLink (VariableNode "$x") (VariableNode "$y"))))
+
+;; Not a join; every pair is tried, and all but the equal ones kept.
+(define join-not-equal
+	(BindLink
+		(VariableList (concept-var "$x") (concept-var "$y"))
+		(AndLink
+			(InheritanceLink (VariableNode "$x") (ConceptNode "person"))
+			(MemberLink (VariableNode "$y") (ConceptNode "orchestra"))
+			(NotLink (EqualLink (VariableNode "$x") (VariableNode "$y"))))
+		(ListLink (VariableNode "$x") (VariableNode "$y"))))
+
+;; Three components, joined pairwise: the French speakers in the
+;; orchestra.
+(define join-chain
+	(BindLink
+		(VariableList
+			(concept-var "$x") (concept-var "$y") (concept-var "$z"))
+		(AndLink
+			(InheritanceLink (VariableNode "$x") (ConceptNode "person"))
+			(MemberLink (VariableNode "$y") (ConceptNode "orchestra"))
+			(EvaluationLink (PredicateNode "speaks")
+				(ListLink (VariableNode "$z") (ConceptNode "French")))
+			(EqualLink (VariableNode "$x") (VariableNode "$y"))
+			(EqualLink (VariableNode "$z") (VariableNode "$y")))
+		(VariableNode "$z")))
+
+;; The join key is not unique on one side: each player in the
+;; orchestra who speaks anything speaks two languages.
+(define join-many
+	(BindLink
+		(VariableList
+			(concept-var "$x") (concept-var "$y") (concept-var "$lang"))
+		(AndLink
+			(MemberLink (VariableNode "$x") (ConceptNode "orchestra"))
+			(EvaluationLink (PredicateNode "speaks")
+				(ListLink (VariableNode "$y") (VariableNode "$lang")))
+			(EqualLink (VariableNode "$x") (VariableNode "$y")))
+		(ListLink (VariableNode "$x") (VariableNode "$lang"))))
+
+;; One side has no groundings at all.
+(define join-empty
+	(BindLink
+		(VariableList (concept-var "$x") (concept-var "$y"))
+		(AndLink
+			(MemberLink (VariableNode "$x") (ConceptNode "orchestra"))
+			(InheritanceLink (VariableNode "$y") (ConceptNode "robot"))
+			(EqualLink (VariableNode "$x") (VariableNode "$y")))
+		(VariableNode "$x")))
+
+;; A virtual clause that mentions only one of the components is a
+;; filter on that component, not a join.
+(define join-filter
+	(BindLink
+		(VariableList (concept-var "$x") (concept-var "$y"))
+		(AndLink
+			(InheritanceLink (VariableNode "$x") (ConceptNode "person"))
+			(MemberLink (VariableNode "$y") (ConceptNode "orchestra"))
+			(EqualLink (VariableNode "$y") (ConceptNode "guest 3")))
+		(ListLink (VariableNode "$x") (VariableNode "$y"))))